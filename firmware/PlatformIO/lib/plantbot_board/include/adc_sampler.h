@@ -0,0 +1,39 @@
+/*
+ * PlantBot2 ADC Sampler
+ * 
+ * Battery, light and moisture are converted in one interleaved burst by
+ * the continuous (DMA) ADC driver instead of three rounds of analogRead().
+ * The burst is reduced to per-channel averages; battery readings at the
+ * rails are rejected as outliers and summed so the fixed-point calibration
+ * in fixed_point.h can do the division.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+
+// Per-channel averages reduced from one DMA burst
+struct AdcReadings {
+    uint32_t batterySum;  // Sum of the raw readings kept after outlier rejection
+    int batteryValid;     // Number of battery samples accepted
+    int light;
+    int moisture;
+};
+
+// Driver is created on first use and kept until deinitAdcContinuous()
+bool initAdcContinuous();
+void deinitAdcContinuous();
+
+// Convert one burst of all three channels
+bool sampleAdcChannels(AdcReadings &readings);
+
+// Calibrated battery voltage in mV, 0 when acquisition failed
+int32_t readBatteryMv();
+
+// Soil moisture in % from a raw reading
+float calculateMoisturePercent(int moistureReading);
+
+#endif // ADC_SAMPLER_H
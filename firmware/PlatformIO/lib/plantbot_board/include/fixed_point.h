@@ -0,0 +1,97 @@
+/*
+ * PlantBot2 Fixed-Point Sensor Conversions
+ * 
+ * The ESP32-C6 has no FPU, so float math is emulated in software. These
+ * integer versions of the battery, moisture and sleep-time conversions
+ * work in millivolts and hundredths of a percent. The calibration
+ * constants in plantbot2_board.h stay in volts; they are converted to
+ * integer units at compile time. Header-only and free of Arduino
+ * dependencies so the results can be checked against the float formulas
+ * on the host.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include "plantbot2_board.h"
+
+// Round a constant to an integer count of 1/scale units (compile time)
+constexpr int32_t fixedFromConstant(double value, int32_t scale) {
+    return (int32_t)(value * scale + (value < 0 ? -0.5 : 0.5));
+}
+
+constexpr int32_t BATTERY_SLOPE_UV = fixedFromConstant(BATTERY_CALIB_SLOPE, 1000000);  // µV per ADC unit
+constexpr int32_t BATTERY_INTERCEPT_MV = fixedFromConstant(BATTERY_CALIB_INTERCEPT, 1000);
+constexpr int32_t BATTERY_MAX_MV = fixedFromConstant(BATTERY_MAX_VOLTAGE, 1000);
+constexpr int32_t CHARGING_DETECT_MV = fixedFromConstant(CHARGING_DETECT_VOLTAGE, 1000);
+
+// The slope times a full burst of maximum readings must fit 32 bits
+static_assert((uint64_t)BATTERY_SLOPE_UV * 4095 * ADC_DMA_SAMPLES_PER_CHANNEL <= UINT32_MAX,
+              "battery ADC sum overflows the fixed-point conversion");
+
+// value * scale rounded to an integer and clamped to [low, high]; NaN,
+// which no clamp catches, gives invalid
+static inline int32_t fixedSaturate(float value, int32_t scale, int32_t low, int32_t high, int32_t invalid) {
+    if (value != value) {
+        return invalid;
+    }
+    
+    float scaled = value * scale;
+    if (scaled <= low) {
+        return low;
+    }
+    
+    if (scaled >= high) {
+        return high;
+    }
+    
+    return (int32_t)(scaled + (scaled < 0 ? -0.5f : 0.5f));
+}
+
+// Battery voltage in mV from the sum of count raw ADC readings
+// (voltage = slope * mean + intercept)
+static inline int32_t batteryMvFromAdc(uint32_t adcSum, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    uint32_t meanUv = (uint32_t)BATTERY_SLOPE_UV * adcSum / count;
+    return (int32_t)((meanUv + 500) / 1000) + BATTERY_INTERCEPT_MV;
+}
+
+// Moisture in 0.01 % from a raw reading; lower readings are wetter
+static inline uint16_t moistureCentiFromAdc(int reading) {
+    if (reading <= MOISTURE_WET_VALUE) {
+        return 10000;
+    }
+    
+    if (reading >= MOISTURE_DRY_VALUE) {
+        return 0;
+    }
+    
+    const int32_t span = MOISTURE_DRY_VALUE - MOISTURE_WET_VALUE;
+    return (uint16_t)((10000 * (MOISTURE_DRY_VALUE - reading) + span / 2) / span);
+}
+
+// Linear interpolation of the sleep time between maxMinutes at lowMv and
+// minMinutes at highMv, clamped outside that range. Rounds towards the
+// shorter sleep like the float version's truncation.
+static inline uint32_t sleepMinutesForBatteryMv(int32_t batteryMv, int32_t lowMv, int32_t highMv,
+                                                uint32_t minMinutes, uint32_t maxMinutes) {
+    if (batteryMv <= lowMv) {
+        return maxMinutes;
+    }
+    
+    if (batteryMv >= highMv) {
+        return minMinutes;
+    }
+    
+    uint32_t span = highMv - lowMv;
+    uint32_t reduction = ((maxMinutes - minMinutes) * (uint32_t)(batteryMv - lowMv) + span - 1) / span;
+    return maxMinutes - reduction;
+}
+
+#endif // FIXED_POINT_H
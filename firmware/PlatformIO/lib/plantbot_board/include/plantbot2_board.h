@@ -0,0 +1,62 @@
+/*
+ * PlantBot2 Board Definitions
+ * 
+ * Pin mapping and calibration shared by every firmware variant for the
+ * ESP32-C6-MINI-1-N4 board. Each project's plantbot2_pins.h includes this
+ * file and adds its own policy settings (battery thresholds, sleep times,
+ * uplink), so a hardware change only has to be made here.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef PLANTBOT2_BOARD_H
+#define PLANTBOT2_BOARD_H
+
+// GPIO Pin Assignments
+#define PIN_STATUS_LED     0   // GPIO0 - Status LED (boot strapping pin)
+#define PIN_BATTERY_READ   1   // GPIO1 - Battery voltage monitor (ADC1_CH1)
+#define PIN_LIGHT_SENSOR   2   // GPIO2 - Light sensor input (ADC1_CH2)
+#define PIN_I2C_POWER      3   // GPIO3 - I2C sensor power control
+#define PIN_MOISTURE_SENS  4   // GPIO4 - Soil moisture sensor (ADC1_CH4)
+#define PIN_PUMP_CONTROL   5   // GPIO5 - Pump control output
+// GPIO6 - BAT pin (not used in firmware)
+// GPIO7 - Reserved
+#define PIN_USER_GPIO      8   // GPIO8 - User expansion pin
+#define PIN_BOOT_BUTTON    9   // GPIO9 - Boot/User button
+// GPIO10-11 - Reserved
+// GPIO12 - USB D-
+// GPIO13 - USB D+
+#define PIN_I2C_SDA       14   // GPIO14 - I2C data line
+#define PIN_I2C_SCL       15   // GPIO15 - I2C clock line
+
+// I2C Configuration
+#define I2C_FREQUENCY     100000  // 100kHz standard mode
+#define I2C_ADDR_AHT20    0x38    // AHT20 temperature/humidity sensor
+#define AHT20_POWERUP_MS          100  // AHT20 settling time after sensor rail power-up
+#define AHT20_MEASURE_TIMEOUT_MS  150  // Maximum wait for a conversion (typ. 80ms)
+#define AHT20_POLL_INTERVAL_MS    5    // Busy-bit polling interval
+
+// ADC Configuration
+#define ADC_RESOLUTION    12      // 12-bit ADC (0-4095)
+#define ADC_MAX_VALUE     4095.0  // Maximum ADC reading
+#define ADC_REF_VOLTAGE   3.3     // ADC reference voltage
+
+// Battery Monitoring - Linear calibration values (y = mx + c)
+// Calculated from measurements: 3.0V→3168, 3.2V→3182, 3.8V→3374, 4.2V→3444
+#define BATTERY_CALIB_SLOPE    0.003944  // m: voltage per ADC unit
+#define BATTERY_CALIB_INTERCEPT -9.436   // c: voltage offset
+#define BATTERY_MAX_VOLTAGE    4.2   // Maximum battery voltage
+#define USB_DETECT_VOLTAGE     4.5   // Voltage threshold for USB detection
+#define CHARGING_DETECT_VOLTAGE 4.0  // Voltage threshold for charging detection
+#define BATTERY_TREND_SAMPLES  10    // Number of samples for trend analysis
+
+// Continuous (DMA) ADC acquisition - battery, light and moisture interleaved
+#define ADC_DMA_SAMPLE_FREQ_HZ       20000 // Conversion rate across all channels (~5ms burst)
+#define ADC_DMA_SAMPLES_PER_CHANNEL  32    // Conversions of each channel averaged per burst
+#define ADC_DMA_TIMEOUT_MS           50    // Maximum wait for one burst to complete
+
+// Moisture Sensor Calibration
+#define MOISTURE_WET_VALUE    1300   // ADC value for 100% moisture (fully wet)
+#define MOISTURE_DRY_VALUE    1850   // ADC value for 0% moisture (fully dry)
+
+#endif // PLANTBOT2_BOARD_H
@@ -0,0 +1,151 @@
+/*
+ * PlantBot2 ADC Sampler
+ * 
+ * See adc_sampler.h.
+ */
+
+#include "adc_sampler.h"
+#include "plantbot2_board.h"
+#include "fixed_point.h"
+#include <esp_adc/adc_continuous.h>
+
+#define ADC_DMA_CHANNELS      3
+#define ADC_DMA_BUFFER_BYTES  (ADC_DMA_CHANNELS * ADC_DMA_SAMPLES_PER_CHANNEL * SOC_ADC_DIGI_RESULT_BYTES)
+
+static adc_continuous_handle_t adcHandle = nullptr;
+static uint8_t adcDmaBuffer[ADC_DMA_BUFFER_BYTES];
+
+int32_t readBatteryMv() {
+    // Battery samples come from the same interleaved burst as light and moisture
+    AdcReadings adc;
+    if (!sampleAdcChannels(adc)) {
+        Serial.println("❌ ADC acquisition failed");
+        return 0;
+    }
+    
+    int validReadings = adc.batteryValid;
+    if (validReadings == 0) {
+        Serial.println("❌ No valid battery readings!");
+        return 0;
+    }
+    
+    // Linear calibration (voltage = m * adc + c) in fixed point
+    int32_t batteryMv = batteryMvFromAdc(adc.batterySum, validReadings);
+    
+    Serial.printf("Battery ADC: %lu (from %d samples), Voltage: %ldmV\n", 
+                  (unsigned long)(adc.batterySum / validReadings), validReadings, (long)batteryMv);
+    
+    return batteryMv;
+}
+
+bool initAdcContinuous() {
+    if (adcHandle != nullptr) {
+        return true;
+    }
+    
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = ADC_DMA_BUFFER_BYTES;
+    handleConfig.conv_frame_size = ADC_DMA_BUFFER_BYTES;
+    if (adc_continuous_new_handle(&handleConfig, &adcHandle) != ESP_OK) {
+        adcHandle = nullptr;
+        return false;
+    }
+    
+    // Same 12dB attenuation and 12-bit width as analogRead() so the
+    // battery and moisture calibration constants still apply
+    const int pins[ADC_DMA_CHANNELS] = {PIN_BATTERY_READ, PIN_LIGHT_SENSOR, PIN_MOISTURE_SENS};
+    adc_digi_pattern_config_t pattern[ADC_DMA_CHANNELS] = {};
+    for (int i = 0; i < ADC_DMA_CHANNELS; i++) {
+        adc_unit_t unit;
+        adc_channel_t channel;
+        adc_continuous_io_to_channel(pins[i], &unit, &channel);
+        pattern[i].atten = ADC_ATTEN_DB_12;
+        pattern[i].channel = channel;
+        pattern[i].unit = unit;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    
+    adc_continuous_config_t config = {};
+    config.pattern_num = ADC_DMA_CHANNELS;
+    config.adc_pattern = pattern;
+    config.sample_freq_hz = ADC_DMA_SAMPLE_FREQ_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    if (adc_continuous_config(adcHandle, &config) != ESP_OK) {
+        deinitAdcContinuous();
+        return false;
+    }
+    
+    return true;
+}
+
+void deinitAdcContinuous() {
+    if (adcHandle != nullptr) {
+        adc_continuous_deinit(adcHandle);
+        adcHandle = nullptr;
+    }
+}
+
+bool sampleAdcChannels(AdcReadings &readings) {
+    memset(&readings, 0, sizeof(readings));
+    
+    if (!initAdcContinuous()) {
+        return false;
+    }
+    
+    // One frame holds ADC_DMA_SAMPLES_PER_CHANNEL conversions of each channel
+    uint32_t length = 0;
+    adc_continuous_flush_pool(adcHandle);
+    adc_continuous_start(adcHandle);
+    esp_err_t err = adc_continuous_read(adcHandle, adcDmaBuffer, sizeof(adcDmaBuffer),
+                                        &length, ADC_DMA_TIMEOUT_MS);
+    adc_continuous_stop(adcHandle);
+    
+    if (err != ESP_OK) {
+        return false;
+    }
+    
+    adc_unit_t unit;
+    adc_channel_t batteryChannel, lightChannel, moistureChannel;
+    adc_continuous_io_to_channel(PIN_BATTERY_READ, &unit, &batteryChannel);
+    adc_continuous_io_to_channel(PIN_LIGHT_SENSOR, &unit, &lightChannel);
+    adc_continuous_io_to_channel(PIN_MOISTURE_SENS, &unit, &moistureChannel);
+    
+    long batterySum = 0, lightSum = 0, moistSum = 0;
+    int lightCount = 0, moistCount = 0;
+    
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        adc_digi_output_data_t *sample = (adc_digi_output_data_t *)&adcDmaBuffer[i];
+        uint32_t channel = sample->type2.channel;
+        int value = sample->type2.data;
+        
+        if (channel == (uint32_t)batteryChannel) {
+            // Basic outlier filtering - reject readings at extremes
+            if (value > 50 && value < 4000) {
+                batterySum += value;
+                readings.batteryValid++;
+            }
+        } else if (channel == (uint32_t)lightChannel) {
+            lightSum += value;
+            lightCount++;
+        } else if (channel == (uint32_t)moistureChannel) {
+            moistSum += value;
+            moistCount++;
+        }
+    }
+    
+    if (lightCount == 0 || moistCount == 0) {
+        return false;
+    }
+    
+    readings.batterySum = batterySum;
+    readings.light = lightSum / lightCount;
+    readings.moisture = moistSum / moistCount;
+    
+    return true;
+}
+
+float calculateMoisturePercent(int moistureReading) {
+    // Lower ADC values = more moisture (inverted scale), see moistureCentiFromAdc()
+    return moistureCentiFromAdc(moistureReading) / 100.0f;
+}
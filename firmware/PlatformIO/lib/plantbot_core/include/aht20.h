@@ -0,0 +1,52 @@
+/*
+ * PlantBot2 AHT20 Driver
+ * 
+ * Lean non-blocking driver for the AHT20 temperature/humidity sensor.
+ * The measurement is triggered as soon as the sensor rail is up and the
+ * result is collected later by polling the busy bit, so the wake cycle
+ * never waits on fixed delays. The calibration-enabled state is kept in
+ * RTC memory so the init sequence is skipped on subsequent wakes.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef AHT20_H
+#define AHT20_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class AHT20 {
+public:
+    enum Result {
+        AHT20_OK,
+        AHT20_BUSY,
+        AHT20_ERROR
+    };
+    
+    // Attach to the bus; powerOnMs is when the sensor rail was switched on
+    void begin(TwoWire &wire, unsigned long powerOnMs);
+    
+    // Send the trigger command (waits out the power-up time if needed)
+    bool startMeasurement();
+    
+    // Check once for a finished measurement without blocking
+    Result poll(float &temperature, float &humidity);
+    
+    // Poll the busy bit until the measurement is ready or timeoutMs elapses
+    Result read(float &temperature, float &humidity, uint32_t timeoutMs);
+    
+    // Soft reset - forces the calibration check on the next measurement
+    void softReset();
+    
+private:
+    bool ensureCalibrated();
+    bool readStatus(uint8_t &status);
+    static uint8_t crc8(const uint8_t *data, size_t length);
+    
+    TwoWire *_wire = nullptr;
+    unsigned long _powerOnMs = 0;
+    bool _measuring = false;
+};
+
+#endif // AHT20_H
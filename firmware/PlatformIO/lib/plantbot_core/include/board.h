@@ -0,0 +1,45 @@
+/*
+ * PlantBot2 Board Support
+ * 
+ * Hardware bring-up, sensor acquisition and the deep sleep sequence
+ * common to every firmware variant. The AHT20 measurement is triggered
+ * as soon as the sensor rail is powered and collected in readSensors(),
+ * so its conversion overlaps the rest of the wake.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <Arduino.h>
+#include "aht20.h"
+#include "sensor_data.h"
+
+extern AHT20 aht;
+extern unsigned long sensorPowerOnMs;  // millis() when the sensor rail was switched on
+
+// Configure pins, power the sensor rail and start the I2C bus
+void setupHardware();
+
+// Initialize the WiFi and Bluetooth controllers
+void initializeRadio();
+
+// Collect light, moisture and the AHT20 reading; batteryVoltage was
+// sampled earlier in the wake
+bool readSensors(SensorData &data, float batteryVoltage);
+
+// Power down the sensors and park every pin for minimum sleep current
+void configureGPIOForSleep();
+
+// Same for a background sample wake that only powered the rail and the
+// ADC: no I2C teardown and no power-down settling delay
+void configureGPIOForSampleSleep();
+
+// Shut down the radios and sleep; does not return
+void enterDeepSleep(uint64_t sleepTimeUs);
+
+void blinkStatusLED(int count, int delayMs = 200);
+void printWakeupReason(uint32_t lastSleepMinutes);
+
+#endif // BOARD_H
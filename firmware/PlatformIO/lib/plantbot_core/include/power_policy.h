@@ -0,0 +1,167 @@
+/*
+ * PlantBot2 Power Policy
+ * 
+ * Battery voltage history, charge detection and the battery-dependent
+ * sleep time. The last BATTERY_TREND_SAMPLES readings are kept in an RTC
+ * ring (rtc_ring.h) and reduced, in constant time, to a recent and an
+ * overall trend and a least-squares slope; how those are interpreted is a
+ * policy class picked with POWER_POLICY in plantbot2_pins.h, so only the
+ * selected policy is compiled in.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "plantbot2_pins.h"
+#include "fixed_point.h"
+
+constexpr int32_t BATTERY_UVLO_MV = fixedFromConstant(BATTERY_UVLO_VOLTAGE, 1000);
+constexpr int32_t BATTERY_CRITICAL_MV = fixedFromConstant(BATTERY_CRITICAL_VOLTAGE, 1000);
+constexpr int32_t BATTERY_LOW_MV = fixedFromConstant(BATTERY_LOW_VOLTAGE, 1000);
+
+static_assert(BATTERY_UVLO_MV <= BATTERY_CRITICAL_MV && BATTERY_CRITICAL_MV <= BATTERY_LOW_MV &&
+              BATTERY_LOW_MV < BATTERY_MAX_MV,
+              "battery thresholds must be ordered UVLO <= CRITICAL <= LOW < MAX");
+
+// Battery voltage change over the stored history
+struct BatteryTrend {
+    int samples;            // Readings in the history
+    int32_t currentMv;      // Newest reading
+    int32_t recentRiseMv;   // Change over the last recentSteps readings
+    int recentSteps;
+    int32_t overallRiseMv;  // Newest minus oldest reading
+    int overallSteps;
+    int32_t meanMv;
+    int32_t slopeUv;        // Least-squares change per reading, µV
+};
+
+// Store this wake's battery reading (call once per wake)
+void updateBatteryHistory(int32_t batteryMv);
+
+// Reduce the history to trends; recentSteps is capped to what is stored
+BatteryTrend batteryTrend(int recentSteps);
+
+// Charging when the voltage kept rising by > 20mV per reading above
+// CHARGING_DETECT_VOLTAGE; sleep is only shortened in bright light
+struct SteadyPowerPolicy {
+    static constexpr int MIN_SAMPLES = 2;
+    static constexpr int RECENT_STEPS = 1;
+    
+    static bool charging(const BatteryTrend &trend) {
+        return trend.overallRiseMv > 20 * trend.overallSteps && trend.currentMv > CHARGING_DETECT_MV;
+    }
+    
+    // Reason for minimum sleep, nullptr when not charging
+    static const char *chargeReason(int32_t batteryMv, int lightLevel, bool charging) {
+        bool highLight = (lightLevel > CHARGING_LIGHT_THRESHOLD);
+        return (highLight && (batteryMv > CHARGING_DETECT_MV || charging)) ? "light + voltage" : nullptr;
+    }
+};
+
+// Solar charging: a quick rise over the last three readings backed by a
+// rising overall trend, or a near-full battery that isn't falling. Bright
+// light or a high voltage alone also count, so the short sleep starts as
+// soon as the panel is lit.
+struct SolarPowerPolicy {
+    static constexpr int MIN_SAMPLES = 3;
+    static constexpr int RECENT_STEPS = 3;
+    
+    static bool charging(const BatteryTrend &trend) {
+        bool voltageRising = trend.recentRiseMv > 15 * trend.recentSteps;  // > 15mV per reading
+        bool stableRise = trend.overallRiseMv > 5 * trend.overallSteps;     // > 5mV per reading
+        return (voltageRising && stableRise && trend.currentMv > 3800) ||
+               (trend.currentMv > 4100 && trend.overallRiseMv > -10 * trend.overallSteps);
+    }
+    
+    static const char *chargeReason(int32_t batteryMv, int lightLevel, bool charging) {
+        bool highLight = (lightLevel > CHARGING_LIGHT_THRESHOLD);
+        if (charging) {
+            return "voltage trend";
+        }
+        if (highLight && batteryMv > 3900) {
+            return "light + voltage";
+        }
+        if (batteryMv > CHARGING_DETECT_MV && batteryMv > 4100) {
+            return "high voltage";
+        }
+        return nullptr;
+    }
+};
+
+typedef std::conditional<POWER_POLICY == POWER_POLICY_SOLAR,
+                         SolarPowerPolicy, SteadyPowerPolicy>::type PowerPolicy;
+
+template <typename Policy>
+bool isChargingWith() {
+    BatteryTrend trend = batteryTrend(Policy::RECENT_STEPS);
+    if (trend.samples < Policy::MIN_SAMPLES) {
+        return false; // Not enough data for a reliable trend
+    }
+    
+    bool charging = Policy::charging(trend);
+    
+    Serial.printf("Battery trends - Recent: %ldmV/%d, Overall: %ldmV/%d, Slope: %ldµV, Current: %ldmV, "
+                  "Charging: %s\n",
+                  (long)trend.recentRiseMv, trend.recentSteps, (long)trend.overallRiseMv, trend.overallSteps,
+                  (long)trend.slopeUv, (long)trend.currentMv, charging ? "Yes" : "No");
+    
+    return charging;
+}
+
+template <typename Policy>
+uint32_t dynamicSleepMinutesWith(int32_t batteryMv, int lightLevel) {
+    uint32_t sleepMinutes = NORMAL_SLEEP_MINUTES;
+    
+    // UVLO check - should not reach here but safety first
+    if (batteryMv <= BATTERY_UVLO_MV) {
+        return UVLO_SLEEP_MINUTES;
+    }
+    
+    // Critical battery check
+    if (batteryMv <= BATTERY_CRITICAL_MV) {
+        Serial.printf("🔋 Critical battery (%ldmV): 24hr sleep\n", (long)batteryMv);
+        return CRITICAL_SLEEP_MINUTES;
+    }
+    
+    const char *chargeReason = Policy::chargeReason(batteryMv, lightLevel, isChargingWith<Policy>());
+    
+    if (chargeReason != nullptr) {
+        // Charging conditions: use minimum sleep time
+        sleepMinutes = MIN_SLEEP_MINUTES;
+        Serial.printf("🔋 Charging detected via %s (%ldmV, light=%d): minimum sleep\n",
+                      chargeReason, (long)batteryMv, lightLevel);
+    } else if (batteryMv < BATTERY_LOW_MV) {
+        // Linear scaling from MIN_SLEEP_MINUTES at full charge to MAX_SLEEP_MINUTES at the low threshold
+        sleepMinutes = sleepMinutesForBatteryMv(batteryMv, BATTERY_LOW_MV, BATTERY_MAX_MV,
+                                                MIN_SLEEP_MINUTES, MAX_SLEEP_MINUTES);
+        
+        Serial.printf("🔋 Low battery scaling: %ldmV → %lu min\n", (long)batteryMv, (unsigned long)sleepMinutes);
+    } else {
+        // Normal/high battery level: use minimum sleep time (2 hours)
+        sleepMinutes = MIN_SLEEP_MINUTES;
+        Serial.printf("🔋 Normal battery (%ldmV): standard sleep\n", (long)batteryMv);
+    }
+    
+    // Ensure sleep time is within bounds
+    sleepMinutes = max((uint32_t)MIN_SLEEP_MINUTES, min((uint32_t)MAX_SLEEP_MINUTES, sleepMinutes));
+    
+    Serial.printf("Final sleep decision: Battery=%ldmV, Light=%d, Sleep=%lu min\n",
+                  (long)batteryMv, lightLevel, (unsigned long)sleepMinutes);
+    
+    return sleepMinutes;
+}
+
+// Charge detection and sleep time with the policy selected in plantbot2_pins.h
+inline bool isCharging() {
+    return isChargingWith<PowerPolicy>();
+}
+
+inline uint32_t calculateDynamicSleepTime(int32_t batteryMv, int lightLevel) {
+    return dynamicSleepMinutesWith<PowerPolicy>(batteryMv, lightLevel);
+}
+
+#endif // POWER_POLICY_H
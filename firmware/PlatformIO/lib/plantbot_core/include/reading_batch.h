@@ -0,0 +1,74 @@
+/*
+ * PlantBot2 Reading Batch
+ * 
+ * Store-and-forward buffer for sensor readings. Each wake appends a
+ * compact record to an RTC-resident ring buffer and the radio is only
+ * powered when the batch is full, the oldest reading passes its deadline
+ * or a threshold event occurs. The whole buffer is then sent in one
+ * request.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef READING_BATCH_H
+#define READING_BATCH_H
+
+#include <Arduino.h>
+#include "sensor_data.h"
+
+// Compact fixed-point record (19 bytes) held in RTC memory
+struct __attribute__((packed)) BatchedReading {
+    uint32_t takenAt;          // time(nullptr) when the reading was taken
+    int16_t temperatureCenti;  // 0.01 °C
+    uint16_t humidityCenti;    // 0.01 %RH
+    uint16_t batteryMv;        // millivolts
+    uint16_t lightLevel;       // raw ADC
+    uint16_t moistureLevel;    // raw ADC
+    uint16_t moistureCenti;    // 0.01 %
+    uint8_t flags;             // BATCH_FLAG_*
+};
+
+#define BATCH_FLAG_LOW_BATTERY  0x01
+#define BATCH_FLAG_CHARGING     0x02
+
+// Field values for a missing (NaN) reading, the same as in the telemetry
+// frame; other values are clamped to the field's range
+#define BATCH_TEMPERATURE_NONE  INT16_MIN
+#define BATCH_CENTI_NONE        UINT16_MAX
+
+// Queue a reading; the oldest one is dropped when the buffer is full
+void batchAppend(const SensorData &data, bool charging);
+
+// Number of queued readings and access by position (0 = oldest)
+int batchCount();
+const BatchedReading &batchAt(int index);
+
+// Sequence number of the oldest queued reading. Every reading queued since
+// power-on gets the next number, so receivers can drop re-sent readings.
+uint32_t batchFirstSequence();
+
+// Seconds since a queued reading was taken
+uint32_t batchAgeS(const BatchedReading &reading);
+
+// True when the batch should be uploaded this wake: with pendingReadings
+// still to be appended it will be full, the oldest reading has reached its
+// deadline, or it's the first wake after power-on (so setup can be verified)
+bool batchUploadDue(bool powerOnReset, int pendingReadings);
+
+// True when this reading crosses a threshold that warrants an early upload.
+// Call once per wake - it compares against the previous wake's reading.
+bool batchThresholdEvent(const SensorData &data);
+
+// Drop all queued readings after a successful upload
+void batchClear();
+
+// Drop the count oldest queued readings after only they were delivered
+void batchDropOldest(int count);
+
+// Rebase queued timestamps after the system clock was stepped (e.g. NTP sync)
+void batchShiftClock(int32_t stepS);
+
+// Convert a record back into floating point sensor data
+void batchToSensorData(const BatchedReading &reading, SensorData &data);
+
+#endif // READING_BATCH_H
@@ -0,0 +1,66 @@
+/*
+ * PlantBot2 Retry Policy
+ * 
+ * Decides what happens after a failed upload attempt: retry within the
+ * wake, defer to a short follow-up wake, or wait for the next scheduled
+ * wake. Delays grow exponentially with a per-device jitter derived from the
+ * MAC address so a fleet doesn't retry in lockstep after an outage. A
+ * circuit breaker keeps the radio off for a growing cool-down after
+ * repeated failed wakes. All state lives in RTC memory.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+#include <Arduino.h>
+
+enum UplinkError : uint8_t {
+    UPLINK_OK,
+    UPLINK_ERR_WIFI,        // Association or DHCP failed
+    UPLINK_ERR_DNS,         // Host lookup failed
+    UPLINK_ERR_TCP,         // Connection refused or timed out
+    UPLINK_ERR_TLS,         // Handshake or server key check failed
+    UPLINK_ERR_HTTP_5XX,    // Server error, or no response after connecting
+    UPLINK_ERR_HTTP_4XX     // Request rejected - retrying the same payload won't help
+};
+
+enum RetryAction : uint8_t {
+    RETRY_NOW,              // Wait delayMs awake, then try again
+    RETRY_DEFER,            // Deep sleep delayMs, then retry on a follow-up wake
+    RETRY_GIVE_UP,          // Keep the readings queued for the next scheduled wake
+    RETRY_DROP              // Rejected for good - drop the readings, not a failed wake
+};
+
+struct RetryDecision {
+    RetryAction action;
+    uint32_t delayMs;
+};
+
+// Circuit breaker: false while the radio should rest after repeated failures
+bool retryRadioAllowed();
+
+// Decide after a failed attempt (attempt counts from 1 within this wake).
+// A server error is deferred to a follow-up wake only when canDefer is set
+// (a cloud service that may be cold-starting); otherwise it is retried awake.
+// A rejected request (4xx) is dropped and doesn't count towards the breaker,
+// since re-sending the same payload would fail on every wake.
+RetryDecision retryOnFailure(UplinkError error, int attempt, bool canDefer = false);
+
+// Reset backoff and close the circuit breaker
+void retryOnSuccess();
+
+// Failed wakes since the last successful upload
+uint8_t retryConsecutiveFailures();
+
+// Deferred retries since the last scheduled wake
+uint8_t retryDeferrals();
+
+// Error of the most recent failed attempt
+UplinkError retryLastError();
+
+// Payload value for an error: "ok", "wifi", "dns", "tcp", "tls", "http_5xx" or "http_4xx"
+const char *uplinkErrorName(UplinkError error);
+
+#endif // RETRY_POLICY_H
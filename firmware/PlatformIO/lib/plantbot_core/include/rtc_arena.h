@@ -0,0 +1,70 @@
+/*
+ * PlantBot2 RTC Arena
+ * 
+ * All state kept across deep sleep lives in one block of RTC memory
+ * instead of loose RTC_DATA_ATTR globals. The block starts with a header
+ * (magic, layout version, CRC-32 and a directory of regions) followed by
+ * the regions themselves, one plain struct per subsystem, handed out by a
+ * bump allocator the first time a subsystem asks for it.
+ * 
+ * The CRC is written just before deep sleep (rtcArenaSeal) and checked at
+ * the start of the next wake (rtcArenaBegin). Contents that were not
+ * sealed by the previous wake - a power-on reset, corruption while
+ * asleep, a reset in the middle of a wake, a firmware with another
+ * RTC_ARENA_VERSION - are cleared, so every subsystem starts from its
+ * initial state rather than from whatever was left in memory. A region
+ * whose size changed between firmware builds is handed out fresh, its old
+ * block stays in use until the arena is cleared.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef RTC_ARENA_H
+#define RTC_ARENA_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "plantbot2_pins.h"
+
+// Bump when a region's layout changes without changing its size
+#define RTC_ARENA_VERSION   1
+
+// One region per subsystem; regions are allocated in first-use order
+enum RtcRegion : uint8_t {
+    RTC_REGION_WAKE,            // Firmware main: boot count, WiFi cache, retry flag
+    RTC_REGION_POWER,           // Battery voltage history
+    RTC_REGION_BATCH,           // Queued readings and flush triggers
+    RTC_REGION_DEADBAND,        // Last transmitted values
+    RTC_REGION_RETRY,           // Backoff and circuit breaker
+    RTC_REGION_PROFILER,        // Wake-cycle timing history
+    RTC_REGION_AHT20,           // Sensor calibration flag
+    RTC_REGION_SAMPLER,         // Background samples between full wakes
+    RTC_REGION_FLASH_LOG,       // Position in the flash log
+    RTC_REGION_DNS,             // Resolved hosts
+    RTC_REGION_TLS,             // TLS session ticket and counters
+    RTC_REGION_ESPNOW,          // Gateway session
+    RTC_REGION_COUNT
+};
+
+// Check what the previous wake sealed and clear it when invalid. Call
+// first thing in setup(); regions used before that check it themselves.
+void rtcArenaBegin();
+
+// Write the CRC over the arena - call just before deep sleep, after the
+// last change to any region
+void rtcArenaSeal();
+
+// A region's memory: the same block every wake, zeroed (or copied from
+// initial) on first use and after the arena was cleared. Never null: when
+// RTC_ARENA_SIZE is exhausted the arena is discarded and the chip resets.
+// Not locked: main task only. A region a background task uses must be
+// claimed in setup() before that task starts.
+void *rtcArenaAllocate(RtcRegion region, size_t size, size_t align, const void *initial);
+
+template <typename T>
+T *rtcArenaRegion(RtcRegion region, const T *initial = nullptr) {
+    static_assert(std::is_trivially_copyable<T>::value, "RTC arena regions hold plain data");
+    return static_cast<T *>(rtcArenaAllocate(region, sizeof(T), alignof(T), initial));
+}
+
+#endif // RTC_ARENA_H
@@ -0,0 +1,118 @@
+/*
+ * PlantBot2 RTC Ring
+ * 
+ * Fixed-size history of the last N integer readings that keeps the running
+ * sums behind its statistics, so mean, variance and the least-squares
+ * slope cost the same whatever N is: push() updates the sums as a reading
+ * enters and the oldest one leaves, the queries only combine them. Every
+ * sum is an exact 64-bit integer (no FPU on the ESP32-C6), so nothing
+ * drifts however many readings pass through. Scales up to 1000 keep the
+ * intermediate products in range for any N.
+ * 
+ * Plain data without constructors: a zeroed ring is empty, so it can live
+ * in an RTC arena region (rtc_arena.h) as it is. Header-only and free of
+ * Arduino dependencies so it can be checked on the host.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef RTC_RING_H
+#define RTC_RING_H
+
+#include <stdint.h>
+#include <type_traits>
+
+// Round a / b to the nearest integer, halves away from zero (b > 0)
+static inline int64_t ringDivRound(int64_t a, int64_t b) {
+    return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+template <typename T, int N>
+struct RtcRing {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 2, "RtcRing sums need 16-bit integer readings");
+    static_assert(N >= 1 && N <= 256, "RtcRing holds 1 to 256 readings");
+    
+    static constexpr int CAPACITY = N;
+    
+    T values[N];
+    uint16_t head;          // Next slot to write; the oldest reading once full
+    uint16_t length;
+    int64_t sum;            // Σ y
+    int64_t squares;        // Σ y²
+    int64_t weighted;       // Σ k·y, k = 0 for the oldest reading
+    
+    void push(T value) {
+        int64_t y = value;
+        if (length == N) {
+            // The oldest reading leaves and every other one moves down a place
+            int64_t dropped = values[head];
+            weighted += (N - 1) * y - (sum - dropped);
+            sum += y - dropped;
+            squares += y * y - dropped * dropped;
+        } else {
+            weighted += length * y;
+            sum += y;
+            squares += y * y;
+            length++;
+        }
+        values[head] = value;
+        head = (head + 1) % N;
+    }
+    
+    int count() const {
+        return length;
+    }
+    
+    bool full() const {
+        return length == N;
+    }
+    
+    // Reading pushed age pushes before the newest one (age < count())
+    T at(int age) const {
+        return values[(head - 1 - age + 2 * N) % N];
+    }
+    
+    T newest() const {
+        return at(0);
+    }
+    
+    T oldest() const {
+        return at(length - 1);
+    }
+    
+    // Newest reading minus the one steps pushes earlier; consecutive
+    // changes telescope, so this is their sum
+    int32_t rise(int steps) const {
+        return (int32_t)newest() - at(steps);
+    }
+    
+    // Mean times scale, rounded; 0 when empty
+    int32_t mean(int32_t scale = 1) const {
+        if (length == 0) {
+            return 0;
+        }
+        return (int32_t)ringDivRound(sum * scale, length);
+    }
+    
+    // Population variance times scale, rounded; 0 with fewer than two readings
+    int64_t variance(int32_t scale = 1) const {
+        if (length < 2) {
+            return 0;
+        }
+        int64_t n = length;
+        return ringDivRound((n * squares - sum * sum) * scale, n * n);
+    }
+    
+    // Least-squares change per push times scale, rounded; 0 with fewer
+    // than two readings. With x = 0..n-1: slope = 6 (2nΣky - n(n-1)Σy) / (n²(n²-1))
+    int32_t slope(int32_t scale = 1) const {
+        if (length < 2) {
+            return 0;
+        }
+        int64_t n = length;
+        int64_t numerator = 2 * n * weighted - n * (n - 1) * sum;
+        return (int32_t)ringDivRound(6 * scale * numerator, n * n * (n * n - 1));
+    }
+};
+
+#endif // RTC_RING_H
@@ -0,0 +1,25 @@
+/*
+ * PlantBot2 Sensor Data
+ * 
+ * One set of sensor readings taken during a wake cycle.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef SENSOR_DATA_H
+#define SENSOR_DATA_H
+
+#include <stdint.h>
+
+struct SensorData {
+    float temperature;
+    float humidity;
+    float batteryVoltage;
+    int lightLevel;
+    int moistureLevel;
+    float moisturePercent;
+    uint32_t timestamp;
+    bool lowBattery;
+};
+
+#endif // SENSOR_DATA_H
@@ -0,0 +1,35 @@
+/*
+ * PlantBot2 Change-Driven Uplink
+ * 
+ * Per-field deadbands against the last transmitted values (kept in RTC
+ * memory) plus a maximum silence interval. Readings that haven't moved
+ * beyond any deadband are not transmitted until a heartbeat is due.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef UPLINK_DEADBAND_H
+#define UPLINK_DEADBAND_H
+
+#include <Arduino.h>
+#include "sensor_data.h"
+
+enum UplinkReason : uint8_t {
+    UPLINK_SCHEDULED,   // Within deadbands - only sent when deadbands are off or a flush is due
+    UPLINK_DELTA,       // A field moved beyond its deadband
+    UPLINK_HEARTBEAT    // Maximum silence interval elapsed
+};
+
+// True when the next reading will be transmitted regardless of its values
+bool deadbandHeartbeatDue();
+
+// Compare a reading against the last transmitted values
+UplinkReason deadbandEvaluate(const SensorData &data);
+
+// Remember a reading as transmitted
+void deadbandRecord(const SensorData &data);
+
+// Payload value for a reason: "scheduled", "delta" or "heartbeat"
+const char *uplinkReasonName(UplinkReason reason);
+
+#endif // UPLINK_DEADBAND_H
@@ -0,0 +1,59 @@
+/*
+ * PlantBot2 Wake-Cycle Profiler
+ * 
+ * Lightweight per-phase timing of the wake cycle based on esp_timer.
+ * The breakdown of the last PROFILE_HISTORY_CYCLES wakes is kept in an
+ * RTC ring buffer so it survives deep sleep and can be uploaded.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WAKE_PROFILER_H
+#define WAKE_PROFILER_H
+
+#include <Arduino.h>
+
+enum WakePhase : uint8_t {
+    PHASE_BOOT,             // Reset to setup() entry
+    PHASE_SETUP_HARDWARE,
+    PHASE_INIT_RADIO,
+    PHASE_READ_SENSORS,
+    PHASE_CONNECT_WIFI,
+    PHASE_DNS,
+    PHASE_TLS,              // TLS handshake (plain TCP connect without HTTPS)
+    PHASE_HTTP_POST,
+    PHASE_GPIO_SLEEP,       // configureGPIOForSleep()
+    PHASE_DEEP_SLEEP,       // enterDeepSleep() up to esp_deep_sleep_start()
+    PHASE_COUNT
+};
+
+struct WakeProfile {
+    uint32_t bootCount;
+    uint32_t awakeUs;                // setup() entry to deep sleep
+    uint32_t phaseUs[PHASE_COUNT];   // Accumulated time per phase
+};
+
+// Call first thing in setup()
+void profilerBegin(uint32_t bootCount);
+
+// Phases may overlap (e.g. WiFi task) and accumulate across retries
+void profilerStart(WakePhase phase);
+void profilerEnd(WakePhase phase);
+
+// Duration of a phase in this wake, or from the previous cycle for
+// phases that have not run yet (sleep preparation runs after upload)
+uint32_t profilerPhaseUs(WakePhase phase);
+
+// Payload field name for a phase, e.g. "t_connect_wifi_ms"
+const char *profilerFieldName(WakePhase phase);
+
+// Previous complete cycles, age 0 = most recent; nullptr when not recorded
+const WakeProfile *profilerHistory(int age);
+
+// Store this wake in the RTC ring buffer - call just before deep sleep
+void profilerCommit();
+
+// Print this wake's breakdown to serial
+void profilerPrint();
+
+#endif // WAKE_PROFILER_H
@@ -0,0 +1,108 @@
+/*
+ * PlantBot2 Host Simulation - Arduino Core
+ * 
+ * Arduino and FreeRTOS calls used by the firmware, implemented against
+ * the simulated clock and peripherals (see sim.h). ARDUINO is left
+ * undefined so code can tell the host build apart.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include "WString.h"
+#include "IPAddress.h"
+#include "esp_random.h"
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// RTC slow memory: one section, carried across simulated deep sleeps
+#define RTC_DATA_ATTR __attribute__((section("rtc_sim_data")))
+
+// Timing (virtual clock)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// GPIO
+#define LOW            0
+#define HIGH           1
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// Serial console, lines are prefixed with the virtual time
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void flush();
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char *text);
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t print(char c);
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T &value) { return print(value) + println(); }
+    size_t println(double value, int digits) { return print(value, digits) + println(); }
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// FreeRTOS subset: tasks run to completion on their own timeline
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct SimTask *TaskHandle_t;
+typedef struct SimSemaphore *SemaphoreHandle_t;
+
+#define pdPASS             1
+#define pdFAIL             0
+#define pdTRUE             1
+#define pdFALSE            0
+#define portMAX_DELAY      0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+
+// Tasks never preempt each other, so critical sections have nothing to do
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED  0
+#define portENTER_CRITICAL(mux)       ((void)(mux))
+#define portEXIT_CRITICAL(mux)        ((void)(mux))
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+void setup();
+void loop();
+
+#endif // ARDUINO_H
@@ -0,0 +1,42 @@
+/*
+ * PlantBot2 Host Simulation - HTTP Client
+ * 
+ * Requests go to the in-process server stand-in (simHttpPost), which
+ * replies with the scenario's HTTP status after a 150ms round trip, or to
+ * a real server in fleet runs.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient &client, const char *host, uint16_t port, const char *uri = "/", bool https = false);
+    bool begin(const String &url);
+    void addHeader(const String &name, const String &value);
+    void setTimeout(uint16_t timeoutMs) { (void)timeoutMs; }
+    void setReuse(bool reuse) { (void)reuse; }
+    int POST(uint8_t *payload, size_t size);
+    int POST(const String &payload);
+    String getString();
+    void end();
+    
+private:
+    String _host;
+    uint16_t _port = 80;
+    String _uri;
+    String _contentType;
+    String _response;
+};
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,51 @@
+/*
+ * PlantBot2 Host Simulation - IPAddress
+ * 
+ * IPv4 only, stored in network byte order like the ESP32 core so the
+ * uint32_t conversion matches what the firmware caches in RTC memory.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint32_t address) : _address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (_address >> (8 * index)) & 0xFF; }
+    bool operator==(const IPAddress &other) const { return _address == other._address; }
+    
+    bool fromString(const char *text) {
+        unsigned int a, b, c, d;
+        char tail;
+        if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 ||
+            a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+    
+    String toString() const {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(buffer);
+    }
+    
+private:
+    uint32_t _address;
+};
+
+#define INADDR_NONE IPAddress(0, 0, 0, 0)
+
+#endif // IPADDRESS_H
@@ -0,0 +1,33 @@
+/*
+ * PlantBot2 Host Simulation - NVS Preferences
+ * 
+ * Key-value store kept with the simulated flash, so it survives deep
+ * sleep and power-on resets. Small values only.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end();
+    
+    size_t putUInt(const char *key, uint32_t value);
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+    bool remove(const char *key);
+    
+private:
+    char _name[16] = {};
+    bool _open = false;
+    bool _readOnly = true;
+};
+
+#endif // PREFERENCES_H
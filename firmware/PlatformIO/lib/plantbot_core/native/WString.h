@@ -0,0 +1,98 @@
+/*
+ * PlantBot2 Host Simulation - Arduino String
+ * 
+ * The subset of the Arduino String class used by the firmware and by
+ * ArduinoJson (ARDUINOJSON_ENABLE_ARDUINO_STRING), backed by std::string.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stdio.h>
+#include <string>
+
+class StringSumHelper;
+
+class String {
+public:
+    String(const char *cstr = "") : _value(cstr ? cstr : "") {}
+    String(const String &other) = default;
+    explicit String(char c) : _value(1, c) {}
+    explicit String(int value) : _value(std::to_string(value)) {}
+    explicit String(unsigned int value) : _value(std::to_string(value)) {}
+    explicit String(long value) : _value(std::to_string(value)) {}
+    explicit String(unsigned long value) : _value(std::to_string(value)) {}
+    explicit String(double value, unsigned int decimals = 2) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+        _value = buffer;
+    }
+    
+    String &operator=(const String &other) = default;
+    String &operator=(const char *cstr) {
+        _value = cstr ? cstr : "";
+        return *this;
+    }
+    
+    const char *c_str() const { return _value.c_str(); }
+    unsigned int length() const { return (unsigned int)_value.length(); }
+    bool reserve(unsigned int size) { _value.reserve(size); return true; }
+    char operator[](unsigned int index) const { return index < _value.size() ? _value[index] : 0; }
+    
+    bool concat(const String &other) { _value += other._value; return true; }
+    bool concat(const char *cstr) { if (cstr) _value += cstr; return true; }
+    bool concat(const char *cstr, unsigned int length) { if (cstr) _value.append(cstr, length); return true; }
+    bool concat(char c) { _value += c; return true; }
+    
+    String &operator+=(const String &other) { concat(other); return *this; }
+    String &operator+=(const char *cstr) { concat(cstr); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+    
+    bool operator==(const String &other) const { return _value == other._value; }
+    bool operator==(const char *cstr) const { return _value == (cstr ? cstr : ""); }
+    bool operator!=(const String &other) const { return !(*this == other); }
+    bool equals(const String &other) const { return *this == other; }
+    
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = _value.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from, unsigned int to = ~0u) const {
+        if (from > _value.size()) {
+            return String();
+        }
+        return String(_value.substr(from, to == ~0u ? std::string::npos : to - from).c_str());
+    }
+    
+private:
+    std::string _value;
+};
+
+// Result type of String concatenation, as in the Arduino core
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String &s) : String(s) {}
+    StringSumHelper(const char *cstr) : String(cstr) {}
+};
+
+inline StringSumHelper operator+(const String &lhs, const String &rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+inline StringSumHelper operator+(const String &lhs, const char *rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+inline StringSumHelper operator+(const char *lhs, const String &rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+#endif // WSTRING_H
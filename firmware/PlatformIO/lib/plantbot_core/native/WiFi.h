@@ -0,0 +1,69 @@
+/*
+ * PlantBot2 Host Simulation - WiFi Station
+ * 
+ * Association succeeds while the scenario has the access point up. A
+ * connection with a known BSSID and channel takes 300ms, a full scan and
+ * DHCP 2.5s. The link time is counted as radio-on time in the run summary.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include "esp_wifi.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+    wl_status_t begin(const char *ssid = nullptr, const char *password = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+                IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool mode(wifi_mode_t mode);
+    bool setSleep(bool enabled);
+    wl_status_t status();
+    
+    String SSID() const;
+    String macAddress() const;
+    uint8_t *macAddress(uint8_t *mac) const;
+    int8_t RSSI() const;
+    uint8_t *BSSID();
+    int32_t channel() const;
+    IPAddress localIP() const;
+    IPAddress gatewayIP() const;
+    IPAddress subnetMask() const;
+    IPAddress dnsIP(uint8_t index = 0) const;
+    int hostByName(const char *host, IPAddress &ip);
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient {
+public:
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char *host, uint16_t port);
+    uint8_t connected();
+    void stop();
+    
+private:
+    bool _connected = false;
+};
+
+#endif // WIFI_H
@@ -0,0 +1,23 @@
+/*
+ * PlantBot2 Host Simulation - WiFiManager
+ * 
+ * The configuration portal is never shown; autoConnect() joins the
+ * simulated network like WiFi.begin() with stored credentials.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WIFIMANAGER_H
+#define WIFIMANAGER_H
+
+#include <WiFi.h>
+
+class WiFiManager {
+public:
+    void setCustomHeadElement(const char *html) { (void)html; }
+    void setConfigPortalTimeout(unsigned long seconds) { (void)seconds; }
+    void setConnectTimeout(unsigned long seconds) { (void)seconds; }
+    bool autoConnect(const char *apName, const char *apPassword = nullptr);
+};
+
+#endif // WIFIMANAGER_H
@@ -0,0 +1,18 @@
+/*
+ * PlantBot2 Host Simulation - WiFiMulti
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WIFIMULTI_H
+#define WIFIMULTI_H
+
+#include <WiFi.h>
+
+class WiFiMulti {
+public:
+    bool addAP(const char *ssid, const char *password = nullptr) { (void)ssid; (void)password; return true; }
+    uint8_t run(uint32_t timeoutMs = 5000) { (void)timeoutMs; return WiFi.begin(); }
+};
+
+#endif // WIFIMULTI_H
@@ -0,0 +1,28 @@
+/*
+ * PlantBot2 Host Simulation - UDP
+ * 
+ * There is no DNS server on the simulated network, so queries go
+ * unanswered and names fall back to WiFi.hostByName().
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WIFIUDP_H
+#define WIFIUDP_H
+
+#include <Arduino.h>
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t port) { (void)port; return 1; }
+    void stop() {}
+    int beginPacket(IPAddress ip, uint16_t port) { (void)ip; (void)port; return 1; }
+    size_t write(const uint8_t *data, size_t length) { (void)data; return length; }
+    int endPacket() { return 1; }
+    int parsePacket() { return 0; }
+    int read(uint8_t *buffer, size_t length) { (void)buffer; (void)length; return 0; }
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+};
+
+#endif // WIFIUDP_H
@@ -0,0 +1,42 @@
+/*
+ * PlantBot2 Host Simulation - I2C Bus
+ * 
+ * The bus carries a model of the AHT20 at I2C_ADDR_AHT20. It only answers
+ * while the sensor rail (PIN_I2C_POWER) is high, reports busy for 80ms
+ * after a trigger and returns the scenario temperature and humidity.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+    
+    void beginTransmission(uint16_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t requestFrom(uint16_t address, size_t quantity, bool sendStop = true);
+    int available();
+    int read();
+    
+private:
+    bool _enabled = false;
+    uint16_t _address = 0;
+    uint8_t _txBuffer[16];
+    size_t _txLength = 0;
+    uint8_t _rxBuffer[16];
+    size_t _rxLength = 0;
+    size_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
@@ -0,0 +1,17 @@
+/*
+ * PlantBot2 Host Simulation - Credentials
+ * 
+ * Used instead of the project's credentials.h in [env:native]: plain HTTP
+ * to the in-process server stand-in.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef CREDENTIALS_H
+#define CREDENTIALS_H
+
+#define SERVER_HOST "127.0.0.1"
+#define SERVER_PORT 8080
+#define DATA_ENDPOINT "/api/data"
+
+#endif // CREDENTIALS_H
@@ -0,0 +1,22 @@
+/*
+ * PlantBot2 Host Simulation - Bluetooth Controller
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_BT_H
+#define ESP_BT_H
+
+#include "esp_err.h"
+
+typedef struct {
+    int unused;
+} esp_bt_controller_config_t;
+
+#define BT_CONTROLLER_INIT_CONFIG_DEFAULT() esp_bt_controller_config_t{}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *config);
+esp_err_t esp_bt_controller_deinit();
+esp_err_t esp_bt_controller_disable();
+
+#endif // ESP_BT_H
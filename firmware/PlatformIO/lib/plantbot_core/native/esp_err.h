@@ -0,0 +1,19 @@
+/*
+ * PlantBot2 Host Simulation - ESP-IDF Error Codes
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK                 0
+#define ESP_FAIL              -1
+#define ESP_ERR_INVALID_ARG    0x102
+#define ESP_ERR_INVALID_STATE  0x103
+#define ESP_ERR_INVALID_SIZE   0x104
+#define ESP_ERR_TIMEOUT        0x107
+
+#endif // ESP_ERR_H
@@ -0,0 +1,20 @@
+/*
+ * PlantBot2 Host Simulation - Network Interfaces
+ * 
+ * Only the station interface exists; its lwIP side is in
+ * esp_netif_net_stack.h and lwip/dhcp.h.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_NETIF_H
+#define ESP_NETIF_H
+
+#include "esp_err.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+// "WIFI_STA_DEF" is the station; nullptr for any other key
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+
+#endif // ESP_NETIF_H
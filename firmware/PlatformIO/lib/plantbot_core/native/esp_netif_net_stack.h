@@ -0,0 +1,15 @@
+/*
+ * PlantBot2 Host Simulation - Network Interface Internals
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_NETIF_NET_STACK_H
+#define ESP_NETIF_NET_STACK_H
+
+#include "esp_netif.h"
+
+// The lwIP struct netif behind an interface (see lwip/dhcp.h)
+void *esp_netif_get_netif_impl(esp_netif_t *esp_netif);
+
+#endif // ESP_NETIF_NET_STACK_H
@@ -0,0 +1,14 @@
+/*
+ * PlantBot2 Host Simulation - Power Management
+ * 
+ * Nothing to manage on the host.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_PM_H
+#define ESP_PM_H
+
+#include "esp_err.h"
+
+#endif // ESP_PM_H
@@ -0,0 +1,16 @@
+/*
+ * PlantBot2 Host Simulation - Random Numbers
+ * 
+ * Deterministic, so runs with the same scenario repeat exactly.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random();
+
+#endif // ESP_RANDOM_H
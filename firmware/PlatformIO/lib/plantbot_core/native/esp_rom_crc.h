@@ -0,0 +1,26 @@
+/*
+ * PlantBot2 Host Simulation - ROM CRC
+ * 
+ * Same result as the chip's ROM routine: standard CRC-32 (IEEE 802.3),
+ * chained by passing the previous result.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+#endif // ESP_ROM_CRC_H
@@ -0,0 +1,15 @@
+/*
+ * PlantBot2 Host Simulation - High Resolution Timer
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+// Microseconds since this wake started (virtual clock)
+int64_t esp_timer_get_time();
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,26 @@
+/*
+ * PlantBot2 Host Simulation - lwIP DHCP Client
+ * 
+ * The DHCP client state lwIP keeps per interface, reduced to the lease
+ * granted at the last bind. The simulated server grants SIM_DHCP_LEASE_S
+ * (see sim_network.cpp).
+ * 
+ * Version: 1.0
+ */
+
+#ifndef LWIP_DHCP_H
+#define LWIP_DHCP_H
+
+#include <stdint.h>
+
+struct dhcp {
+    uint32_t offered_t0_lease;  // Seconds, 0 before the first bind
+};
+
+struct netif {
+    struct dhcp *dhcp;
+};
+
+#define netif_dhcp_data(netif) ((netif)->dhcp)
+
+#endif // LWIP_DHCP_H
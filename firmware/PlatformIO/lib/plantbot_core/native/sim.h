@@ -0,0 +1,195 @@
+/*
+ * PlantBot2 Host Simulation
+ * 
+ * Control side of the simulated peripherals behind the native headers in
+ * this directory (Arduino.h, Wire.h, WiFi.h, HTTPClient.h, esp_*.h). The
+ * firmware is built unchanged for [env:native] and its setup() runs once
+ * per simulated wake, driven by the command line front end in the
+ * firmware's src/native:
+ * 
+ *   - Time is virtual. delay() advances the clock instead of waiting, and
+ *     deep sleep adds the sleep time, so days of wakes run in seconds.
+ *   - Every wake runs in a forked child process. RTC_DATA_ATTR variables
+ *     live in their own section that is carried from one wake to the next;
+ *     all other globals start fresh as they do after a real deep sleep.
+ *   - Battery, light, moisture, temperature, humidity, WiFi availability
+ *     and the HTTP status of the server stand-in come from a scenario CSV,
+ *     interpolated at the current virtual time.
+ *   - Tasks run to completion when created, on their own timeline; the
+ *     creator catches up with them when it takes their semaphore.
+ *   - The "tlog" flash partition and NVS (sim_storage.cpp) belong to the
+ *     device and survive deep sleep and power-on resets.
+ *   - With -e, battery voltage and light come from the energy model in
+ *     sim_energy.h instead of the scenario.
+ *   - With -F, a fleet of devices wakes side by side against a real HTTP
+ *     server (-u, or the ingestion stand-in in sim_fleet.cpp). Virtual
+ *     time is then paced against the wall clock so request timing,
+ *     retries and backoff reach the server as the devices would send them.
+ * 
+ * Linux only (fork and the __start_/__stop_ section symbols).
+ * 
+ * Version: 1.0
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Conditions around the device at one point in time
+struct SimConditions {
+    int32_t batteryMv;
+    int light;              // Raw ADC reading
+    int moisture;           // Raw ADC reading
+    float temperature;      // °C
+    float humidity;         // %RH
+    bool wifi;              // Access point reachable
+    int httpStatus;         // Server stand-in reply, 0 = connection refused
+};
+
+// Accumulated over the whole run (kept by the parent process)
+struct SimStats {
+    uint32_t wakes;
+    uint32_t radioWakes;        // Wakes that powered the WiFi radio
+    uint64_t awakeUs;
+    uint64_t radioUs;           // WiFi radio on
+    uint32_t httpRequests;
+    uint32_t httpAccepted;      // 2xx replies
+    uint64_t httpBytes;
+    uint32_t readingsTaken;     // Wakes that measured temperature and humidity
+    uint32_t readingsDelivered; // Readings in accepted uploads
+    uint32_t brownouts;
+};
+
+// One request to a real server, timed on the wall clock
+struct SimRequest {
+    uint64_t wallStartUs;
+    uint32_t latencyUs;
+    int status;             // HTTP status or HTTPC_ERROR_*
+};
+
+#define SIM_WAKE_MAX_REQUESTS   8   // Requests timed per wake
+
+// Shared between the run and the wake processes
+struct SimShared {
+    uint64_t wakeStartUs;   // Virtual time the next wake starts
+    bool timerWake;         // Woken by the sleep timer (false on power-on)
+    bool ended;             // Last wake reached deep sleep or a brownout
+    bool brownout;          // Last wake ended in a brownout reset
+    uint64_t sleepUs;       // Sleep time requested by the last wake
+    uint64_t awakeUs;       // Duration of the last wake
+    uint64_t radioUs;       // Radio-on time of the last wake
+    int httpStatus;         // Last HTTP reply of the last wake, 0 = none
+    int32_t batteryMv;      // Battery at the start of the last wake
+    uint32_t requestCount;  // Requests the last wake made to a real server
+    SimRequest requests[SIM_WAKE_MAX_REQUESTS];
+    SimStats stats;
+};
+
+// RTC slow memory section, placed by the linker (weak: may be empty)
+extern "C" char __start_rtc_sim_data[] __attribute__((weak));
+extern "C" char __stop_rtc_sim_data[] __attribute__((weak));
+
+// Options of the run driver (the firmware's src/native), set before the
+// first wake
+struct SimRunConfig {
+    int quiet;              // 1: one line per wake, 2: summary only
+    float linkSuccessRate;  // Share of WiFi association attempts that succeed
+    double paceSpeed;       // Virtual seconds per wall second, 0 = unpaced
+};
+
+void simConfigure(const SimRunConfig &config);
+
+// Called in a wake's process before setup(): the slot it reports into,
+// where its RTC memory goes at deep sleep, the device (1..devices) and
+// the wall time the wake is due in a paced run
+void simWakeBegin(SimShared *slot, uint8_t *rtc, uint32_t device, uint32_t wake, uint64_t wallStartUs);
+
+// Scenario: "minute,battery_mv,light,moisture,temperature,humidity,wifi,http_status"
+// rows in time order; '#' starts a comment. Without a file the built-in
+// scenario (good battery, WiFi up, server accepting) is used.
+bool simLoadScenario(const char *path);
+SimConditions simConditions();
+
+// Virtual clock: time since power-on and since this wake started
+uint64_t simNowUs();
+uint64_t simWakeUs();
+void simAdvanceUs(uint64_t us);
+
+// Wall clock (monotonic), and catching the virtual clock up with it after
+// waiting on a real server in a paced run
+uint64_t simWallUs();
+void simSyncToWallClock();
+
+// Wake bookkeeping used by the esp_sleep and WiFi models
+bool simWokeFromTimer();
+void simSetSleepTimer(uint64_t us);
+[[noreturn]] void simDeepSleep();
+void simRadioOn();
+void simRadioOff();
+void simRecordHttp(int status, size_t bytes, uint32_t readings);
+void simRecordReading();
+void simRecordRequest(const SimRequest &request);
+
+// Whether a WiFi association attempt gets through (scenario and -w rate)
+bool simLinkAttempt();
+
+// Device identity (station MAC, last byte = device index)
+void simDeviceMac(uint8_t mac[6]);
+
+// GPIO state seen by the peripheral models
+int simPinLevel(int pin);
+
+// Server stand-in (or the fleet target); fills response and returns the
+// HTTP status or an HTTPC_ERROR_* code
+int simHttpPost(const char *host, uint16_t port, const char *path, const char *contentType,
+                const uint8_t *payload, size_t length, char *response, size_t responseSize);
+
+// Deterministic pseudo-random source for sensor noise and esp_random()
+uint32_t simRandom();
+
+// Flash and NVS for devices 1..devices, set up in the run process before
+// the first wake; each wake selects its device's
+bool simStorageBegin(uint32_t devices);
+void simStorageSelect(uint32_t device);
+void simStoragePrintSummary();
+
+// Series codec benchmark (the firmware's src/native/sim_series.cpp) on
+// the readings in a flash log: the simulated device's after a run, or a
+// "tlog" partition image read from a real device
+int simSeriesBenchmarkLog();
+int simSeriesBenchmarkFile(const char *path);
+
+// Fleet runs (sim_fleet.cpp)
+
+// Real HTTP target, "http://host[:port][/path]"; resolved once in the run
+// process. While set, simHttpPost sends every upload there.
+bool simTargetSet(const char *url);
+bool simTargetActive();
+int simTargetPost(const char *contentType, const uint8_t *payload, size_t length,
+                  char *response, size_t responseSize);
+
+// Ingestion stand-in for the dashboard's data endpoint: accepts the JSON
+// and binary payloads and series blocks, counts their readings and
+// replies after a service time, with a limited number of requests in
+// service at once
+struct SimIngestConfig {
+    uint16_t port;          // 0 = any free port
+    uint32_t serviceMs;     // Mean time to store one upload
+    uint32_t workers;       // Requests in service at once, the rest queue
+    float rejectRate;       // Share of uploads answered 503
+};
+
+// In a background process (returns its pid and the port it listens on),
+// or in the foreground until interrupted. Both print a summary at the end.
+int simIngestStart(const SimIngestConfig &config, uint16_t *port);
+void simIngestStop(int server);
+int simIngestServe(const SimIngestConfig &config);
+
+// Latency and throughput of the requests the fleet made
+void simFleetRecord(const SimRequest &request);
+void simFleetPrintProgress(uint64_t elapsedUs, uint32_t running);
+void simFleetPrintSummary(uint32_t devices, uint64_t elapsedUs);
+
+#endif // SIM_H
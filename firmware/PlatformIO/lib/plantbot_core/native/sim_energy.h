@@ -0,0 +1,75 @@
+/*
+ * PlantBot2 Host Simulation - Energy Model
+ * 
+ * Battery, solar panel and charger behind the simulated battery ADC and
+ * light sensor (sim.h -e), so long runs show what the sleep policy does to
+ * the battery rather than replaying a scripted voltage:
+ * 
+ *   - Li-ion cell: capacity, open-circuit voltage curve and internal
+ *     resistance. Under load the firmware reads OCV - I*R.
+ *   - 6V 1W panel: current proportional to the irradiance on it, from a
+ *     CSV trace or a synthetic clear-sky year with random cloud cover.
+ *   - BQ24073: power path and charge current limit. The panel supplies
+ *     the load first and the rest (up to ISET) charges the cell, stopping
+ *     at full.
+ *   - Load: deep sleep, awake and radio-on currents, charged per wake
+ *     from the simulated awake and radio times.
+ *   - Brownout when the loaded voltage under a radio TX peak falls below
+ *     SIM_BROWNOUT_MV. Below SIM_CUTOFF_MV the cell protection switches
+ *     the board off until the panel brings it back to SIM_RESTART_MV.
+ *     Both end in a power-on reset that clears RTC memory.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef SIM_ENERGY_H
+#define SIM_ENERGY_H
+
+#include <stdint.h>
+
+#define SIM_BROWNOUT_MV     3050    // Loaded cell voltage at which the 3.3V rail dips below the BOD level
+#define SIM_CUTOFF_MV       2900    // Cell protection disconnects the board
+#define SIM_RESTART_MV      3300    // Board powers up again after a cutoff
+
+struct SimEnergyConfig {
+    float capacityMah;          // Usable cell capacity
+    float initialSoc;           // State of charge at the start, 0-1
+    float internalOhm;          // Cell plus protection resistance
+    float panelMa;              // Panel current at 1000 W/m²
+    float chargeLimitMa;        // BQ24073 ISET
+    float sleepMa;              // Deep sleep, sensors off
+    float awakeMa;              // CPU running, radio off
+    float radioMa;              // Average with WiFi associated
+    float radioPeakMa;          // TX burst, for the brownout check
+    float latitude;             // Synthetic irradiance, degrees north
+};
+
+// Defaults from the README power budget and HARDWARE.md
+SimEnergyConfig simEnergyDefaults();
+
+// Irradiance on the panel: "minute,irradiance_w_m2" rows in time order,
+// repeated from the start one row interval after the last. Without a
+// trace a synthetic year starting on 1 January is used.
+bool simEnergyLoadIrradiance(const char *path);
+
+void simEnergyBegin(const SimEnergyConfig &config);
+bool simEnergyEnabled();
+
+// Conditions seen by the firmware at virtual time nowUs
+float simEnergyIrradiance(uint64_t nowUs);
+int32_t simEnergyBatteryMv(uint64_t nowUs, bool radioOn);    // Under the awake or radio load
+int simEnergyLightLevel(uint64_t nowUs);
+bool simEnergyBrownout(uint64_t nowUs);
+
+// Bookkeeping in the run process: charge for one wake, then the sleep
+// until nextWakeUs. Returns when the board is next powered - nextWakeUs,
+// or later when the cell was cut off and had to recover first (at most
+// untilUs, the end of the run). The battery voltage the wake measured
+// attributes the interval to UVLO or critical sleep.
+void simEnergyWake(uint64_t awakeUs, uint64_t radioUs);
+uint64_t simEnergySleep(uint64_t fromUs, uint64_t nextWakeUs, uint64_t untilUs, int32_t wakeBatteryMv,
+                        bool *powerLost);
+
+void simEnergyPrintSummary(uint64_t totalUs);
+
+#endif // SIM_ENERGY_H
@@ -0,0 +1,176 @@
+/*
+ * PlantBot2 AHT20 Driver
+ * 
+ * See aht20.h. Command set from the AHT20 datasheet:
+ *   0xBE 0x08 0x00 - initialise / enable calibration
+ *   0xAC 0x33 0x00 - trigger measurement (~80ms)
+ *   0xBA           - soft reset
+ */
+
+#include "aht20.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+
+#define AHT20_CMD_INIT        0xBE
+#define AHT20_CMD_TRIGGER     0xAC
+#define AHT20_CMD_SOFT_RESET  0xBA
+#define AHT20_STATUS_BUSY     0x80
+#define AHT20_STATUS_CAL      0x08
+
+// Calibration-enabled state (RTC arena)
+struct Aht20State {
+    bool calibrated;
+};
+
+static Aht20State &aht20State() {
+    return *rtcArenaRegion<Aht20State>(RTC_REGION_AHT20);
+}
+
+void AHT20::begin(TwoWire &wire, unsigned long powerOnMs) {
+    _wire = &wire;
+    _powerOnMs = powerOnMs;
+    _measuring = false;
+}
+
+bool AHT20::startMeasurement() {
+    if (_wire == nullptr) {
+        return false;
+    }
+    
+    // Sensor needs a short settling time after its rail comes up
+    unsigned long elapsed = millis() - _powerOnMs;
+    if (elapsed < AHT20_POWERUP_MS) {
+        delay(AHT20_POWERUP_MS - elapsed);
+    }
+    
+    if (!ensureCalibrated()) {
+        return false;
+    }
+    
+    _wire->beginTransmission(I2C_ADDR_AHT20);
+    _wire->write(AHT20_CMD_TRIGGER);
+    _wire->write(0x33);
+    _wire->write(0x00);
+    _measuring = (_wire->endTransmission() == 0);
+    
+    return _measuring;
+}
+
+AHT20::Result AHT20::poll(float &temperature, float &humidity) {
+    if (!_measuring) {
+        return AHT20_ERROR;
+    }
+    
+    // Cheap single-byte status read while the conversion is running
+    uint8_t status;
+    if (!readStatus(status)) {
+        _measuring = false;
+        return AHT20_ERROR;
+    }
+    if (status & AHT20_STATUS_BUSY) {
+        return AHT20_BUSY;
+    }
+    
+    _measuring = false;
+    
+    // Status, 20-bit humidity, 20-bit temperature, CRC
+    uint8_t buffer[7];
+    if (_wire->requestFrom((uint16_t)I2C_ADDR_AHT20, (size_t)sizeof(buffer)) != sizeof(buffer)) {
+        return AHT20_ERROR;
+    }
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = _wire->read();
+    }
+    
+    if (!(buffer[0] & AHT20_STATUS_CAL)) {
+        aht20State().calibrated = false; // Re-run the init sequence next time
+        return AHT20_ERROR;
+    }
+    if (crc8(buffer, 6) != buffer[6]) {
+        return AHT20_ERROR;
+    }
+    
+    uint32_t rawHumidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
+    uint32_t rawTemperature = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
+    
+    humidity = rawHumidity * 100.0f / 1048576.0f;
+    temperature = rawTemperature * 200.0f / 1048576.0f - 50.0f;
+    
+    return AHT20_OK;
+}
+
+AHT20::Result AHT20::read(float &temperature, float &humidity, uint32_t timeoutMs) {
+    unsigned long startTime = millis();
+    
+    Result result = poll(temperature, humidity);
+    while (result == AHT20_BUSY && millis() - startTime < timeoutMs) {
+        delay(AHT20_POLL_INTERVAL_MS);
+        result = poll(temperature, humidity);
+    }
+    
+    if (result == AHT20_BUSY) {
+        _measuring = false;
+        return AHT20_ERROR;
+    }
+    
+    return result;
+}
+
+void AHT20::softReset() {
+    _measuring = false;
+    aht20State().calibrated = false;
+    
+    _wire->beginTransmission(I2C_ADDR_AHT20);
+    _wire->write(AHT20_CMD_SOFT_RESET);
+    _wire->endTransmission();
+    delay(20); // Reset completes within 20ms
+}
+
+bool AHT20::ensureCalibrated() {
+    if (aht20State().calibrated) {
+        return true; // Verified on a previous wake, re-checked in every result
+    }
+    
+    uint8_t status;
+    if (!readStatus(status)) {
+        return false;
+    }
+    
+    if (!(status & AHT20_STATUS_CAL)) {
+        _wire->beginTransmission(I2C_ADDR_AHT20);
+        _wire->write(AHT20_CMD_INIT);
+        _wire->write(0x08);
+        _wire->write(0x00);
+        if (_wire->endTransmission() != 0) {
+            return false;
+        }
+        delay(10);
+        
+        if (!readStatus(status) || !(status & AHT20_STATUS_CAL)) {
+            return false;
+        }
+    }
+    
+    aht20State().calibrated = true;
+    return true;
+}
+
+bool AHT20::readStatus(uint8_t &status) {
+    if (_wire->requestFrom((uint16_t)I2C_ADDR_AHT20, (size_t)1) != 1) {
+        return false;
+    }
+    status = _wire->read();
+    return true;
+}
+
+uint8_t AHT20::crc8(const uint8_t *data, size_t length) {
+    // CRC-8, polynomial 0x31, initial value 0xFF
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        }
+    }
+    return crc;
+}
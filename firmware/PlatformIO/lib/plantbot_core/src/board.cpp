@@ -0,0 +1,260 @@
+/*
+ * PlantBot2 Board Support
+ * 
+ * See board.h.
+ */
+
+#include "board.h"
+#include "plantbot2_pins.h"
+#include "adc_sampler.h"
+#include "wake_profiler.h"
+#include "rtc_arena.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_wifi.h>
+#include <esp_bt.h>
+#include <driver/gpio.h>
+
+AHT20 aht;
+unsigned long sensorPowerOnMs = 0;
+
+void setupHardware() {
+    Serial.println("🔧 Initializing hardware...");
+    
+    // Configure output pins
+    pinMode(PIN_STATUS_LED, OUTPUT);
+    pinMode(PIN_PUMP_CONTROL, OUTPUT);
+    pinMode(PIN_I2C_POWER, OUTPUT);
+    
+    // Configure input pins
+    pinMode(PIN_BATTERY_READ, INPUT);
+    pinMode(PIN_LIGHT_SENSOR, INPUT);
+    pinMode(PIN_MOISTURE_SENS, INPUT);
+    pinMode(PIN_BOOT_BUTTON, INPUT_PULLUP);
+    
+    // Ensure boot button has strong pull-up
+    gpio_set_pull_mode((gpio_num_t)PIN_BOOT_BUTTON, GPIO_PULLUP_ONLY);
+    pinMode(PIN_USER_GPIO, INPUT_PULLUP);
+    
+    // Set safe initial states
+    digitalWrite(PIN_STATUS_LED, LOW);
+    digitalWrite(PIN_PUMP_CONTROL, LOW);
+    digitalWrite(PIN_I2C_POWER, HIGH); // Power on sensors
+    
+    // Sensor power stabilization is awaited in readSensors() so the
+    // warmup overlaps with battery sampling and WiFi association
+    sensorPowerOnMs = millis();
+    
+    // Initialize I2C
+    Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
+    Wire.setClock(I2C_FREQUENCY);
+    aht.begin(Wire, sensorPowerOnMs);
+    
+    Serial.println("✅ Hardware initialized");
+}
+
+void initializeRadio() {
+    Serial.println("📡 Initializing radio stack...");
+    
+    // Initialize WiFi stack - ignore errors as it might already be initialized
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    esp_wifi_init(&cfg);
+    
+    // Initialize Bluetooth controller - ignore errors as it might already be initialized  
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    esp_bt_controller_init(&bt_cfg);
+    
+    Serial.println("✅ Radio stack initialized");
+}
+
+// Inputs with pull-ups on every pin so nothing floats during deep sleep
+static void parkPinsForSleep() {
+    // Configure all GPIOs as inputs with pull-ups to prevent floating
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pin_bit_mask = (1ULL << PIN_STATUS_LED) |
+                          (1ULL << PIN_PUMP_CONTROL) |
+                          (1ULL << PIN_I2C_POWER) |
+                          (1ULL << PIN_USER_GPIO) |
+                          (1ULL << PIN_I2C_SDA) |
+                          (1ULL << PIN_I2C_SCL);
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    gpio_config(&io_conf);
+    
+    // Configure ADC pins as inputs with pull-ups (they're already inputs but ensure low power)
+    gpio_config_t adc_conf = {};
+    adc_conf.intr_type = GPIO_INTR_DISABLE;
+    adc_conf.mode = GPIO_MODE_INPUT;
+    adc_conf.pin_bit_mask = (1ULL << PIN_BATTERY_READ) |
+                           (1ULL << PIN_LIGHT_SENSOR) |
+                           (1ULL << PIN_MOISTURE_SENS);
+    adc_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    adc_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    gpio_config(&adc_conf);
+}
+
+void configureGPIOForSleep() {
+    Serial.println("🔧 Configuring GPIOs for sleep...");
+    profilerStart(PHASE_GPIO_SLEEP);
+    
+    // Explicitly deinitialize I2C first to ensure proper shutdown
+    Wire.end();
+    Serial.println("✅ I2C bus deinitialized");
+    
+    // Release the continuous ADC driver and its DMA buffers
+    deinitAdcContinuous();
+    
+    // Turn off all outputs to minimize current draw
+    digitalWrite(PIN_STATUS_LED, LOW);
+    digitalWrite(PIN_PUMP_CONTROL, LOW);
+    digitalWrite(PIN_I2C_POWER, LOW); // Power down sensors
+    
+    // Add delay to ensure sensors are properly powered down
+    delay(100);
+    Serial.println("✅ Sensors powered down");
+    
+    parkPinsForSleep();
+    
+    profilerEnd(PHASE_GPIO_SLEEP);
+    Serial.println("✅ GPIOs and peripherals configured for minimal power consumption");
+}
+
+void configureGPIOForSampleSleep() {
+    // The rail is already off and I2C was never started
+    deinitAdcContinuous();
+    parkPinsForSleep();
+}
+
+bool readSensors(SensorData &data, float batteryVoltage) {
+    Serial.println("📊 Reading sensors...");
+    
+    // Initialize sensor data
+    memset(&data, 0, sizeof(data));
+    data.timestamp = millis();
+    
+    // Battery voltage is sampled before the WiFi task starts
+    data.batteryVoltage = batteryVoltage;
+    data.lowBattery = (data.batteryVoltage < BATTERY_LOW_VOLTAGE && data.batteryVoltage > BATTERY_UVLO_VOLTAGE);
+    
+    // Wait out whatever is left of the sensor warmup
+    unsigned long warmupElapsed = millis() - sensorPowerOnMs;
+    if (warmupElapsed < SENSOR_WARMUP_MS) {
+        delay(SENSOR_WARMUP_MS - warmupElapsed);
+    }
+    
+    // Read light and moisture sensors from one DMA burst
+    AdcReadings adc;
+    if (!sampleAdcChannels(adc)) {
+        Serial.println("❌ ADC acquisition failed");
+        return false;
+    }
+    data.lightLevel = adc.light;
+    data.moistureLevel = adc.moisture;
+    data.moisturePercent = calculateMoisturePercent(data.moistureLevel);
+    
+    // Collect the AHT20 measurement triggered at power-up, with retries
+    bool ahtSuccess = false;
+    for (int retry = 0; retry < 3 && !ahtSuccess; retry++) {
+        if (retry > 0) {
+            Serial.printf("AHT20 retry %d/3\n", retry + 1);
+            // Soft reset and re-trigger instead of power cycling the rail
+            aht.softReset();
+            aht.startMeasurement();
+        }
+        
+        if (aht.read(data.temperature, data.humidity, AHT20_MEASURE_TIMEOUT_MS) == AHT20::AHT20_OK) {
+            // Validate readings
+            if (data.temperature >= -20 && data.temperature <= 60 &&
+                data.humidity >= 0 && data.humidity <= 100) {
+                ahtSuccess = true;
+            } else {
+                Serial.println("❌ AHT20 readings out of range");
+            }
+        } else {
+            Serial.println("❌ Failed to read AHT20");
+        }
+    }
+    
+    if (!ahtSuccess) {
+        Serial.println("❌ AHT20 failed after all retries");
+        return false;
+    }
+    
+    Serial.println("✅ All sensors read successfully");
+    return true;
+}
+
+void enterDeepSleep(uint64_t sleepTimeUs) {
+    profilerStart(PHASE_DEEP_SLEEP);
+    uint32_t sleepMinutes = sleepTimeUs / 60000000ULL;
+    Serial.printf("💤 Entering deep sleep for %d minutes\n", sleepMinutes);
+    
+    // Complete WiFi shutdown for maximum power savings
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    if (esp_wifi_stop() == ESP_OK) {
+        Serial.println("✅ WiFi stopped");
+    }
+    if (esp_wifi_deinit() == ESP_OK) {
+        Serial.println("✅ WiFi deinitialized");
+    }
+    
+    // Complete Bluetooth shutdown
+    if (esp_bt_controller_disable() == ESP_OK) {
+        Serial.println("✅ Bluetooth disabled");
+    }
+    if (esp_bt_controller_deinit() == ESP_OK) {
+        Serial.println("✅ Bluetooth deinitialized");
+    }
+    
+    // Additional power management - disable unnecessary peripherals
+    esp_wifi_set_ps(WIFI_PS_NONE);
+    
+    // Configure wake up source (timer)
+    esp_sleep_enable_timer_wakeup(sleepTimeUs);
+    
+    // Note: GPIO9 is not an RTC GPIO on ESP32-C6, so external wakeup is not available
+    // Only timer wakeup is configured
+    
+    Serial.println("Going to sleep now...");
+    Serial.flush();
+    delay(100); // Ensure serial output completes
+    
+    // Record this wake's timing in the RTC ring buffer
+    profilerEnd(PHASE_DEEP_SLEEP);
+    profilerCommit();
+    
+    // Last change to RTC state - the next wake only trusts it when sealed
+    rtcArenaSeal();
+    
+    // Enter deep sleep
+    esp_deep_sleep_start();
+}
+
+void blinkStatusLED(int count, int delayMs) {
+    for (int i = 0; i < count; i++) {
+        digitalWrite(PIN_STATUS_LED, HIGH);
+        delay(delayMs);
+        digitalWrite(PIN_STATUS_LED, LOW);
+        delay(delayMs);
+    }
+}
+
+void printWakeupReason(uint32_t lastSleepMinutes) {
+    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+    
+    switch(wakeup_reason) {
+        case ESP_SLEEP_WAKEUP_EXT1:
+            Serial.println("🔘 Wakeup: External signal (BOOT button)");
+            break;
+        case ESP_SLEEP_WAKEUP_TIMER:
+            Serial.printf("⏰ Wakeup: Timer (slept %lu minutes)\n", (unsigned long)lastSleepMinutes);
+            break;
+        case ESP_SLEEP_WAKEUP_UNDEFINED:
+        default:
+            Serial.println("🔄 Wakeup: Power on reset");
+            break;
+    }
+}
@@ -0,0 +1,484 @@
+/*
+ * PlantBot2 Host Simulation - Clock, Wakes and Scenario
+ * 
+ * See sim.h.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_random.h>
+#include <esp_mac.h>
+#include "sim.h"
+#include "sim_energy.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// Each clock read costs a little time so polling loops without delay() end
+#define SIM_CLOCK_READ_US       10
+
+// A wake that hasn't reached deep sleep after this long is stuck
+#define SIM_WAKE_LIMIT_US       (15 * 60 * 1000000ULL)
+
+struct ScenarioRow {
+    uint32_t minute;
+    SimConditions conditions;
+};
+
+static SimShared *shared = nullptr;
+static uint8_t *sharedRtc = nullptr;
+static std::vector<ScenarioRow> scenario;
+
+static uint64_t nowUs = 0;          // Since power-on
+static uint64_t wakeStartUs = 0;
+static uint64_t sleepTimerUs = 0;
+static uint64_t radioOnAtUs = 0;
+static bool radioOn = false;
+static uint32_t randomState = 0x2545F491;
+static float linkSuccessRate = 1.0f;
+static bool readingRecorded = false;
+static int quiet = 0;               // 1: one line per wake, 2: summary only
+static uint32_t deviceIndex = 1;    // Fleet runs: 1..devices
+static double paceSpeed = 0;        // Fleet runs: virtual seconds per wall second
+static uint64_t paceWallStartUs = 0; // Wall time at which this wake is due
+static bool lineStart = true;
+
+HardwareSerial Serial;
+
+// Scenario
+
+bool simLoadScenario(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open scenario %s\n", path);
+        return false;
+    }
+    
+    scenario.clear();
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        char *comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        
+        ScenarioRow row = {};
+        unsigned minute;
+        int batteryMv, wifi;
+        if (sscanf(line, " %u , %d , %d , %d , %f , %f , %d , %d", &minute, &batteryMv,
+                   &row.conditions.light, &row.conditions.moisture, &row.conditions.temperature,
+                   &row.conditions.humidity, &wifi, &row.conditions.httpStatus) != 8) {
+            // Blank lines and the header row carry no data
+            if (strspn(line, " \t\r\n") != strlen(line) && !isalpha((unsigned char)line[strspn(line, " \t")])) {
+                fprintf(stderr, "%s:%d: expected 8 columns\n", path, lineNumber);
+                fclose(file);
+                return false;
+            }
+            continue;
+        }
+        
+        if (!scenario.empty() && minute < scenario.back().minute) {
+            fprintf(stderr, "%s:%d: rows must be in time order\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+        row.minute = minute;
+        row.conditions.batteryMv = batteryMv;
+        row.conditions.wifi = wifi != 0;
+        scenario.push_back(row);
+    }
+    fclose(file);
+    
+    if (scenario.empty()) {
+        fprintf(stderr, "%s: no scenario rows\n", path);
+        return false;
+    }
+    return true;
+}
+
+static SimConditions scenarioConditions() {
+    if (scenario.empty()) {
+        return {4000, 1500, 1500, 21.5f, 50.0f, true, 200};
+    }
+    
+    // Analog values are interpolated, WiFi and HTTP status hold until the next row
+    float minute = nowUs / 60e6f;
+    size_t next = 0;
+    while (next < scenario.size() && scenario[next].minute <= minute) {
+        next++;
+    }
+    if (next == 0) {
+        return scenario.front().conditions;
+    }
+    if (next == scenario.size()) {
+        return scenario.back().conditions;
+    }
+    
+    const ScenarioRow &a = scenario[next - 1];
+    const ScenarioRow &b = scenario[next];
+    float t = (minute - a.minute) / (float)(b.minute - a.minute);
+    SimConditions c = a.conditions;
+    c.batteryMv = lroundf(a.conditions.batteryMv + t * (b.conditions.batteryMv - a.conditions.batteryMv));
+    c.light = lroundf(a.conditions.light + t * (b.conditions.light - a.conditions.light));
+    c.moisture = lroundf(a.conditions.moisture + t * (b.conditions.moisture - a.conditions.moisture));
+    c.temperature = a.conditions.temperature + t * (b.conditions.temperature - a.conditions.temperature);
+    c.humidity = a.conditions.humidity + t * (b.conditions.humidity - a.conditions.humidity);
+    return c;
+}
+
+SimConditions simConditions() {
+    SimConditions conditions = scenarioConditions();
+    if (simEnergyEnabled()) {
+        conditions.batteryMv = simEnergyBatteryMv(nowUs, radioOn);
+        conditions.light = simEnergyLightLevel(nowUs);
+    }
+    return conditions;
+}
+
+// Virtual clock
+
+uint64_t simNowUs() {
+    return nowUs;
+}
+
+uint64_t simWakeUs() {
+    return nowUs - wakeStartUs;
+}
+
+void simAdvanceUs(uint64_t us) {
+    nowUs += us;
+    if (simWakeUs() > SIM_WAKE_LIMIT_US) {
+        fprintf(stderr, "\n❌ Wake did not reach deep sleep within %llu minutes\n",
+                (unsigned long long)(SIM_WAKE_LIMIT_US / 60000000ULL));
+        fflush(stdout);
+        _exit(2);
+    }
+    
+    // Paced runs: the virtual clock may not run ahead of the wall clock
+    if (paceSpeed > 0) {
+        uint64_t dueUs = paceWallStartUs + (uint64_t)(simWakeUs() / paceSpeed);
+        uint64_t wallUs = simWallUs();
+        if (dueUs > wallUs + 1000) {
+            usleep(dueUs - wallUs);
+        }
+    }
+}
+
+uint64_t simWallUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+void simSyncToWallClock() {
+    if (paceSpeed > 0) {
+        uint64_t wallUs = simWallUs();
+        if (wallUs > paceWallStartUs) {
+            nowUs = max(nowUs, wakeStartUs + (uint64_t)((wallUs - paceWallStartUs) * paceSpeed));
+        }
+    }
+}
+
+unsigned long millis() {
+    simAdvanceUs(SIM_CLOCK_READ_US);
+    return (unsigned long)(simWakeUs() / 1000);
+}
+
+unsigned long micros() {
+    simAdvanceUs(SIM_CLOCK_READ_US);
+    return (unsigned long)simWakeUs();
+}
+
+void delay(unsigned long ms) {
+    simAdvanceUs(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+    simAdvanceUs(us);
+}
+
+int64_t esp_timer_get_time() {
+    simAdvanceUs(SIM_CLOCK_READ_US);
+    return (int64_t)simWakeUs();
+}
+
+// Serial console
+
+static size_t serialWrite(const char *text, size_t length) {
+    if (quiet > 0) {
+        return length;
+    }
+    
+    for (size_t i = 0; i < length; i++) {
+        if (lineStart) {
+            uint64_t ms = nowUs / 1000;
+            printf("[%llud %02u:%02u:%02u.%03u] ", (unsigned long long)(ms / 86400000ULL),
+                   (unsigned)(ms / 3600000 % 24), (unsigned)(ms / 60000 % 60),
+                   (unsigned)(ms / 1000 % 60), (unsigned)(ms % 1000));
+        }
+        putchar(text[i]);
+        lineStart = (text[i] == '\n');
+    }
+    return length;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::printf(const char *format, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    
+    if (length < 0) {
+        return 0;
+    }
+    return serialWrite(buffer, min((size_t)length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::print(const char *text) {
+    return serialWrite(text, strlen(text));
+}
+
+size_t HardwareSerial::print(char c) {
+    return serialWrite(&c, 1);
+}
+
+// FreeRTOS: a task runs to completion when created, then the clock goes
+// back to the creator, which catches up when it takes the task's semaphore
+
+struct SimSemaphore {
+    bool given;
+    uint64_t givenAtUs;
+};
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    
+    uint64_t creatorUs = nowUs;
+    task(param);
+    nowUs = creatorUs;
+    
+    if (handle != nullptr) {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // The task function returns right after deleting itself
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new SimSemaphore{false, 0};
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->given) {
+        return pdFALSE;
+    }
+    semaphore->given = true;
+    semaphore->givenAtUs = nowUs;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    uint64_t timeoutUs = (uint64_t)ticks * 1000ULL;
+    
+    if (!semaphore->given) {
+        if (ticks == portMAX_DELAY) {
+            fprintf(stderr, "\n❌ Waiting forever on a semaphore nobody gives\n");
+            fflush(stdout);
+            _exit(2);
+        }
+        simAdvanceUs(timeoutUs);
+        return pdFALSE;
+    }
+    
+    // Given later on another task's timeline: wait for it, up to the timeout
+    if (semaphore->givenAtUs > nowUs) {
+        if (ticks != portMAX_DELAY && semaphore->givenAtUs - nowUs > timeoutUs) {
+            simAdvanceUs(timeoutUs);
+            return pdFALSE;
+        }
+        simAdvanceUs(semaphore->givenAtUs - nowUs);
+    }
+    semaphore->given = false;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+// Run configuration and wake setup
+
+void simConfigure(const SimRunConfig &config) {
+    quiet = config.quiet;
+    linkSuccessRate = config.linkSuccessRate;
+    paceSpeed = config.paceSpeed;
+}
+
+void simWakeBegin(SimShared *slot, uint8_t *rtc, uint32_t device, uint32_t wake, uint64_t wallStartUs) {
+    shared = slot;
+    sharedRtc = rtc;
+    deviceIndex = device;
+    paceWallStartUs = wallStartUs;
+    nowUs = wakeStartUs = shared->wakeStartUs;
+    randomState ^= wake * 0x9E3779B9u ^ (deviceIndex - 1) * 0x85EBCA6Bu;
+    
+    shared->ended = false;
+    shared->brownout = false;
+    shared->sleepUs = 0;
+    shared->radioUs = 0;
+    shared->httpStatus = 0;
+    shared->requestCount = 0;
+    shared->batteryMv = simConditions().batteryMv;
+    simStorageSelect(deviceIndex);
+}
+
+// Sleep, radio and identity
+
+bool simWokeFromTimer() {
+    return shared->timerWake;
+}
+
+void simSetSleepTimer(uint64_t us) {
+    sleepTimerUs = us;
+}
+
+[[noreturn]] static void endWake(bool brownout);
+
+void simRadioOn() {
+    if (!radioOn) {
+        radioOn = true;
+        radioOnAtUs = nowUs;
+        
+        // First TX burst on a weak cell pulls the 3.3V rail under the BOD level
+        if (simEnergyEnabled() && simEnergyBrownout(nowUs)) {
+            Serial.println("\n⚡ Brownout reset");
+            endWake(true);
+        }
+    }
+}
+
+void simRadioOff() {
+    if (radioOn) {
+        radioOn = false;
+        shared->radioUs += nowUs - radioOnAtUs;
+    }
+}
+
+void simRecordHttp(int status, size_t bytes, uint32_t readings) {
+    shared->httpStatus = status;
+    shared->stats.httpRequests++;
+    shared->stats.httpBytes += bytes;
+    if (status >= 200 && status < 300) {
+        shared->stats.httpAccepted++;
+        shared->stats.readingsDelivered += readings;
+    }
+}
+
+void simRecordReading() {
+    if (!readingRecorded) {
+        readingRecorded = true;
+        shared->stats.readingsTaken++;
+    }
+}
+
+void simRecordRequest(const SimRequest &request) {
+    if (shared->requestCount < SIM_WAKE_MAX_REQUESTS) {
+        shared->requests[shared->requestCount++] = request;
+    }
+}
+
+bool simLinkAttempt() {
+    return simConditions().wifi && simRandom() <= linkSuccessRate * 4294967295.0;
+}
+
+static void endWake(bool brownout) {
+    simRadioOff();
+    
+    shared->awakeUs = simWakeUs();
+    shared->sleepUs = brownout ? 0 : sleepTimerUs;
+    shared->ended = true;
+    shared->brownout = brownout;
+    if (brownout) {
+        shared->stats.brownouts++;
+    }
+    shared->stats.wakes++;
+    shared->stats.awakeUs += shared->awakeUs;
+    shared->stats.radioUs += shared->radioUs;
+    if (shared->radioUs > 0) {
+        shared->stats.radioWakes++;
+    }
+    
+    // Only RTC slow memory survives
+    if (sharedRtc != nullptr) {
+        memcpy(sharedRtc, __start_rtc_sim_data, __stop_rtc_sim_data - __start_rtc_sim_data);
+    }
+    
+    fflush(stdout);
+    _exit(0);
+}
+
+void simDeepSleep() {
+    endWake(false);
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return simWokeFromTimer() ? ESP_SLEEP_WAKEUP_TIMER : ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    simSetSleepTimer(timeUs);
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    simDeepSleep();
+}
+
+uint32_t simRandom() {
+    // xorshift32, reseeded per wake so runs are repeatable
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+uint32_t esp_random() {
+    return simRandom();
+}
+
+void simDeviceMac(uint8_t mac[6]) {
+    const uint8_t deviceMac[6] = {0x02, 0x50, 0x42, 0x00, (uint8_t)(deviceIndex >> 8), (uint8_t)deviceIndex};
+    memcpy(mac, deviceMac, 6);
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    simDeviceMac(mac);
+    mac[5] += (uint8_t)type;
+    return ESP_OK;
+}
+
+#endif // ARDUINO
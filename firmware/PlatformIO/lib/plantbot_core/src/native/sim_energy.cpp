@@ -0,0 +1,285 @@
+/*
+ * PlantBot2 Host Simulation - Energy Model
+ * 
+ * See sim_energy.h.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include "sim_energy.h"
+#include "power_policy.h"
+#include <stdio.h>
+#include <vector>
+
+#define SIM_ENERGY_STEP_US          (60 * 1000000ULL)  // Sleep integration step
+#define SIM_LIGHT_COUNTS_PER_W_M2   4                  // Light sensor ADC counts per W/m²
+
+struct OcvPoint {
+    float soc;
+    float mv;
+};
+
+// Open-circuit voltage of a typical Li-ion cell at room temperature
+static const OcvPoint ocvCurve[] = {
+    {0.00f, 2750}, {0.05f, 3300}, {0.10f, 3550}, {0.20f, 3680}, {0.30f, 3740}, {0.40f, 3780},
+    {0.50f, 3820}, {0.60f, 3870}, {0.70f, 3940}, {0.80f, 4020}, {0.90f, 4100}, {1.00f, 4190},
+};
+
+struct IrradiancePoint {
+    uint32_t minute;
+    float wattsPerM2;
+};
+
+struct EnergyStats {
+    double initialSoc;
+    double minSoc;
+    double solarMah;        // Available from the panel
+    double chargedMah;      // Into the cell
+    double sleepMah;
+    double awakeMah;
+    double radioMah;
+    uint64_t offUs;         // Cut off by the cell protection
+    uint32_t cutoffs;
+    uint64_t uvloUs;
+    uint64_t criticalUs;
+};
+
+static SimEnergyConfig config;
+static bool enabled = false;
+static double chargeMah = 0;
+static std::vector<IrradiancePoint> irradianceTrace;
+static uint32_t tracePeriodMinutes = 0;
+static EnergyStats stats;
+
+SimEnergyConfig simEnergyDefaults() {
+    SimEnergyConfig defaults;
+    defaults.capacityMah = 2000;
+    defaults.initialSoc = 0.8f;
+    defaults.internalOhm = 0.15f;
+    defaults.panelMa = 167;         // 1W at 6V
+    defaults.chargeLimitMa = 650;   // R28/R29 on ISET
+    defaults.sleepMa = 0.01f;
+    defaults.awakeMa = 20;
+    defaults.radioMa = 80;
+    defaults.radioPeakMa = 350;
+    defaults.latitude = 51.5f;
+    return defaults;
+}
+
+bool simEnergyLoadIrradiance(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open irradiance trace %s\n", path);
+        return false;
+    }
+    
+    irradianceTrace.clear();
+    char line[128];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        IrradiancePoint point;
+        if (line[0] == '#' || sscanf(line, " %u , %f", &point.minute, &point.wattsPerM2) != 2) {
+            continue; // Comments and the header row
+        }
+        if (!irradianceTrace.empty() && point.minute <= irradianceTrace.back().minute) {
+            fprintf(stderr, "%s: rows must be in time order\n", path);
+            fclose(file);
+            return false;
+        }
+        irradianceTrace.push_back(point);
+    }
+    fclose(file);
+    
+    if (irradianceTrace.size() < 2) {
+        fprintf(stderr, "%s: need at least two rows\n", path);
+        return false;
+    }
+    size_t last = irradianceTrace.size() - 1;
+    tracePeriodMinutes = 2 * irradianceTrace[last].minute - irradianceTrace[last - 1].minute;
+    return true;
+}
+
+void simEnergyBegin(const SimEnergyConfig &energyConfig) {
+    config = energyConfig;
+    enabled = true;
+    chargeMah = config.capacityMah * constrain(config.initialSoc, 0.0f, 1.0f);
+    stats = {};
+    stats.initialSoc = stats.minSoc = chargeMah / config.capacityMah;
+}
+
+bool simEnergyEnabled() {
+    return enabled;
+}
+
+static float openCircuitMv() {
+    float soc = chargeMah / config.capacityMah;
+    const size_t points = sizeof(ocvCurve) / sizeof(ocvCurve[0]);
+    if (soc <= ocvCurve[0].soc) {
+        return ocvCurve[0].mv;
+    }
+    for (size_t i = 1; i < points; i++) {
+        if (soc <= ocvCurve[i].soc) {
+            float t = (soc - ocvCurve[i - 1].soc) / (ocvCurve[i].soc - ocvCurve[i - 1].soc);
+            return ocvCurve[i - 1].mv + t * (ocvCurve[i].mv - ocvCurve[i - 1].mv);
+        }
+    }
+    return ocvCurve[points - 1].mv;
+}
+
+static uint32_t hashDay(uint32_t day) {
+    uint32_t h = day * 0x9E3779B9u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+// Haurwitz clear-sky irradiance at solar time, scaled by the day's cloud cover
+static float syntheticIrradiance(uint64_t nowUs) {
+    double days = nowUs / 86400e6;
+    uint32_t day = (uint32_t)days;
+    double hour = (days - day) * 24.0;
+    
+    double declination = 23.45 * M_PI / 180.0 * sin(2.0 * M_PI * (284 + day % 365 + 1) / 365.0);
+    double latitude = config.latitude * M_PI / 180.0;
+    double hourAngle = (hour - 12.0) * 15.0 * M_PI / 180.0;
+    double sinElevation = sin(latitude) * sin(declination) +
+                          cos(latitude) * cos(declination) * cos(hourAngle);
+    if (sinElevation <= 0.01) {
+        return 0;
+    }
+    
+    double clearSky = 1098.0 * sinElevation * exp(-0.059 / sinElevation);
+    double u = (hashDay(day) & 0xFFFF) / 65535.0;
+    return (float)(clearSky * (0.2 + 0.8 * u * u));
+}
+
+float simEnergyIrradiance(uint64_t nowUs) {
+    if (irradianceTrace.empty()) {
+        return syntheticIrradiance(nowUs);
+    }
+    
+    double minute = fmod(nowUs / 60e6, tracePeriodMinutes);
+    size_t next = 0;
+    while (next < irradianceTrace.size() && irradianceTrace[next].minute <= minute) {
+        next++;
+    }
+    const IrradiancePoint &a = irradianceTrace[next == 0 ? 0 : next - 1];
+    const IrradiancePoint &b = next < irradianceTrace.size() ? irradianceTrace[next] : irradianceTrace[0];
+    uint32_t bMinute = next < irradianceTrace.size() ? b.minute : tracePeriodMinutes;
+    if (next == 0 || bMinute <= a.minute) {
+        return a.wattsPerM2;
+    }
+    double t = (minute - a.minute) / (bMinute - a.minute);
+    return (float)(a.wattsPerM2 + t * (b.wattsPerM2 - a.wattsPerM2));
+}
+
+static float panelMa(uint64_t nowUs) {
+    return config.panelMa * simEnergyIrradiance(nowUs) / 1000.0f;
+}
+
+// Cell current (positive = charging): the panel feeds the load first,
+// the charger passes the rest up to ISET until the cell is full
+static float cellCurrentMa(uint64_t nowUs, float loadMa) {
+    float currentMa = min(panelMa(nowUs) - loadMa, config.chargeLimitMa);
+    if (currentMa > 0 && chargeMah >= config.capacityMah) {
+        return 0;
+    }
+    return currentMa;
+}
+
+static int32_t loadedBatteryMv(uint64_t nowUs, float loadMa) {
+    float currentMa = cellCurrentMa(nowUs, loadMa);
+    float mv = openCircuitMv() + currentMa * config.internalOhm;
+    if (currentMa > 0) {
+        mv = min(mv, 4200.0f); // Charger regulation voltage
+    }
+    return lroundf(mv);
+}
+
+int32_t simEnergyBatteryMv(uint64_t nowUs, bool radioOn) {
+    return loadedBatteryMv(nowUs, radioOn ? config.radioMa : config.awakeMa);
+}
+
+int simEnergyLightLevel(uint64_t nowUs) {
+    return min((int)lroundf(simEnergyIrradiance(nowUs) * SIM_LIGHT_COUNTS_PER_W_M2), 4095);
+}
+
+bool simEnergyBrownout(uint64_t nowUs) {
+    return loadedBatteryMv(nowUs, config.radioPeakMa) < SIM_BROWNOUT_MV;
+}
+
+static void drain(double mah) {
+    chargeMah = max(chargeMah - mah, 0.0);
+    stats.minSoc = min(stats.minSoc, chargeMah / config.capacityMah);
+}
+
+void simEnergyWake(uint64_t awakeUs, uint64_t radioUs) {
+    // On top of the sleep current counted for the whole interval
+    double awakeMah = (config.awakeMa - config.sleepMa) * awakeUs / 3600e6;
+    double radioMah = (config.radioMa - config.awakeMa) * radioUs / 3600e6;
+    stats.awakeMah += awakeMah;
+    stats.radioMah += radioMah;
+    drain(awakeMah + radioMah);
+}
+
+uint64_t simEnergySleep(uint64_t fromUs, uint64_t nextWakeUs, uint64_t untilUs, int32_t wakeBatteryMv,
+                        bool *powerLost) {
+    *powerLost = false;
+    bool off = false;
+    
+    uint64_t t = fromUs;
+    while (t < nextWakeUs || (off && t < untilUs)) {
+        uint64_t stepUs = off ? SIM_ENERGY_STEP_US : min((uint64_t)SIM_ENERGY_STEP_US, nextWakeUs - t);
+        double hours = stepUs / 3600e6;
+        float loadMa = off ? 0 : config.sleepMa;
+        float currentMa = cellCurrentMa(t, loadMa);
+        
+        stats.solarMah += panelMa(t) * hours;
+        if (currentMa > 0) {
+            double chargedMah = min(currentMa * hours, config.capacityMah - chargeMah);
+            stats.chargedMah += chargedMah;
+            chargeMah += chargedMah;
+        } else {
+            drain(-currentMa * hours);
+        }
+        if (!off) {
+            stats.sleepMah += loadMa * hours;
+            if (wakeBatteryMv <= BATTERY_UVLO_MV) {
+                stats.uvloUs += stepUs;
+            } else if (wakeBatteryMv <= BATTERY_CRITICAL_MV) {
+                stats.criticalUs += stepUs;
+            }
+        }
+        t += stepUs;
+        
+        if (!off && openCircuitMv() < SIM_CUTOFF_MV) {
+            off = true;
+            *powerLost = true;
+            stats.cutoffs++;
+            printf("🪫 Cell cut off at %.2f days\n", t / 86400e6);
+        } else if (off) {
+            stats.offUs += stepUs;
+            if (openCircuitMv() >= SIM_RESTART_MV) {
+                printf("🔌 Powered up again at %.2f days\n", t / 86400e6);
+                return t;
+            }
+        }
+    }
+    return t;
+}
+
+void simEnergyPrintSummary(uint64_t totalUs) {
+    double loadMah = stats.sleepMah + stats.awakeMah + stats.radioMah;
+    printf("\n=== Energy Summary ===\n");
+    printf("Battery: %.0f mAh, %.0f%% at start, %.0f%% at end, lowest %.0f%%\n", config.capacityMah,
+           stats.initialSoc * 100, chargeMah / config.capacityMah * 100, stats.minSoc * 100);
+    printf("Solar: %.0f mAh from the panel, %.0f mAh into the cell\n", stats.solarMah, stats.chargedMah);
+    printf("Load: %.0f mAh (sleep %.0f, awake %.0f, radio %.0f), %.3f mA average\n", loadMah,
+           stats.sleepMah, stats.awakeMah, stats.radioMah, totalUs > 0 ? loadMah / (totalUs / 3600e6) : 0.0);
+    printf("Uptime: %.2f%% (%u cutoffs, %.1f days off)\n",
+           totalUs > 0 ? 100.0 * (1.0 - (double)stats.offUs / totalUs) : 100.0, stats.cutoffs, stats.offUs / 86400e6);
+    printf("UVLO sleep: %.1f days, critical sleep: %.1f days\n", stats.uvloUs / 86400e6, stats.criticalUs / 86400e6);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,570 @@
+/*
+ * PlantBot2 Host Simulation - Fleet Load Test
+ * 
+ * See sim.h. Uploads from simulated devices go over real TCP to the
+ * target server; the ingestion stand-in is a single-threaded poll() loop
+ * so hundreds of devices can hold connections to it at once.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include "plantbot2_pins.h"
+#include "telemetry_codec.h"
+#include "series_codec.h"
+#include "credentials.h"
+#include "sim.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#define SIM_TARGET_REPLY_SIZE       2048    // Status line, headers and body kept per reply
+#define SIM_INGEST_MAX_REQUEST      16384   // Larger requests are answered 413
+#define SIM_INGEST_BACKLOG          1024    // Pending connections while the loop is busy
+#define SIM_INGEST_POLL_MS          100     // Longest wait, so a stop request is seen
+
+// Target
+
+static sockaddr_storage targetAddress;
+static socklen_t targetAddressLength = 0;
+static char targetHost[128];
+static uint16_t targetPort = 80;
+static char targetPath[128];
+
+bool simTargetSet(const char *url) {
+    if (strncmp(url, "http://", 7) != 0) {
+        fprintf(stderr, "Only http:// targets are supported: %s\n", url);
+        return false;
+    }
+
+    // http://host[:port][/path]
+    const char *authority = url + 7;
+    const char *path = strchr(authority, '/');
+    size_t authorityLength = path != nullptr ? (size_t)(path - authority) : strlen(authority);
+    snprintf(targetPath, sizeof(targetPath), "%s", path != nullptr ? path : DATA_ENDPOINT);
+    snprintf(targetHost, sizeof(targetHost), "%.*s", (int)authorityLength, authority);
+
+    char *colon = strrchr(targetHost, ':');
+    targetPort = 80;
+    if (colon != nullptr) {
+        targetPort = (uint16_t)atoi(colon + 1);
+        *colon = '\0';
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    char port[8];
+    snprintf(port, sizeof(port), "%u", targetPort);
+    int error = getaddrinfo(targetHost, port, &hints, &result);
+    if (error != 0) {
+        fprintf(stderr, "Cannot resolve %s: %s\n", targetHost, gai_strerror(error));
+        return false;
+    }
+    memcpy(&targetAddress, result->ai_addr, result->ai_addrlen);
+    targetAddressLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+bool simTargetActive() {
+    return targetAddressLength > 0;
+}
+
+static bool sendAll(int fd, const void *data, size_t length) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (length > 0) {
+        ssize_t sent = send(fd, p, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        p += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+// One request on its own connection, as the firmware does once per wake
+static int targetExchange(const char *contentType, const uint8_t *payload, size_t length,
+                          char *response, size_t responseSize) {
+    int fd = socket(targetAddress.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    timeval timeout = {HTTP_TIMEOUT_MS / 1000, (HTTP_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(fd, (const sockaddr *)&targetAddress, targetAddressLength) < 0) {
+        close(fd);
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    char header[512];
+    int headerLength = snprintf(header, sizeof(header),
+                                "POST %s HTTP/1.1\r\nHost: %s:%u\r\nContent-Type: %s\r\n"
+                                "Content-Length: %u\r\nConnection: close\r\n\r\n",
+                                targetPath, targetHost, targetPort, contentType, (unsigned)length);
+    if (!sendAll(fd, header, headerLength) || !sendAll(fd, payload, length)) {
+        close(fd);
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+
+    // Read until the body is complete or the server closes the connection
+    char reply[SIM_TARGET_REPLY_SIZE];
+    size_t received = 0;
+    const char *body = nullptr;
+    size_t expected = SIZE_MAX;
+    while (received < sizeof(reply) - 1 && received < expected) {
+        ssize_t n = recv(fd, reply + received, sizeof(reply) - 1 - received, 0);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            close(fd);
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPC_ERROR_READ_TIMEOUT
+                                                            : HTTPC_ERROR_CONNECTION_LOST;
+        }
+        received += n;
+        reply[received] = '\0';
+    
+        if (body == nullptr && (body = strstr(reply, "\r\n\r\n")) != nullptr) {
+            body += 4;
+            const char *contentLength = strcasestr(reply, "\r\nContent-Length:");
+            if (contentLength != nullptr && contentLength < body) {
+                expected = (body - reply) + strtoul(contentLength + 17, nullptr, 10);
+            }
+        }
+    }
+    close(fd);
+    reply[received] = '\0';
+
+    int status;
+    if (sscanf(reply, "HTTP/%*s %d", &status) != 1) {
+        return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    snprintf(response, responseSize, "%s", body != nullptr ? body : "");
+    return status;
+}
+
+int simTargetPost(const char *contentType, const uint8_t *payload, size_t length,
+                  char *response, size_t responseSize) {
+    SimRequest request = {simWallUs(), 0, 0};
+    request.status = targetExchange(contentType, payload, length, response, responseSize);
+    request.latencyUs = (uint32_t)min(simWallUs() - request.wallStartUs, (uint64_t)UINT32_MAX);
+    simRecordRequest(request);
+    simSyncToWallClock();
+    return request.status;
+}
+
+// Ingestion stand-in
+
+enum IngestState {
+    INGEST_READING,
+    INGEST_QUEUED,
+    INGEST_SERVING,
+    INGEST_WRITING,
+};
+
+struct IngestConnection {
+    int fd;
+    IngestState state;
+    std::vector<char> request;
+    size_t expected;        // Request length once the headers are in, 0 before
+    int status;
+    uint32_t readings;
+    uint64_t queuedAtUs;
+    uint64_t readyAtUs;     // End of the service time
+    std::string reply;
+    size_t sent;
+};
+
+struct IngestStats {
+    uint64_t requests;
+    uint64_t accepted;
+    uint64_t rejected;      // 503 from the reject rate
+    uint64_t invalid;       // 4xx
+    uint64_t readings;
+    uint64_t bytes;
+    uint64_t queueWaitUs;
+    uint32_t maxQueued;
+    uint32_t maxConnections;
+};
+
+static volatile sig_atomic_t ingestStopRequested = 0;
+
+static void ingestStop(int signal) {
+    (void)signal;
+    ingestStopRequested = 1;
+}
+
+static int ingestListen(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(fd, (const sockaddr *)&address, sizeof(address)) < 0 || listen(fd, SIM_INGEST_BACKLOG) < 0) {
+        perror("ingestion stand-in");
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+// Classify a complete request: status and the number of readings it carries
+static void ingestParse(IngestConnection &connection, const SimIngestConfig &config) {
+    std::string head(connection.request.begin(), connection.request.end());
+    size_t headerEnd = head.find("\r\n\r\n") + 4;
+    const uint8_t *body = (const uint8_t *)connection.request.data() + headerEnd;
+    size_t length = connection.request.size() - headerEnd;
+
+    connection.readings = 0;
+    if (head.compare(0, 5, "POST ") != 0) {
+        connection.status = 405;
+    } else if (config.rejectRate > 0 && simRandom() <= config.rejectRate * 4294967295.0) {
+        connection.status = 503;
+    } else if (strcasestr(head.c_str(), TELEMETRY_CONTENT_TYPE) != nullptr) {
+        TelemetryHeader header;
+        bool valid = telemetryDecode(body, length, header, nullptr, 0);
+        connection.status = valid ? 200 : 400;
+        connection.readings = valid ? header.readingCount : 0;
+    } else if (strcasestr(head.c_str(), SERIES_CONTENT_TYPE) != nullptr) {
+        // Backlog block; decoding it all checks the bitstream too
+        SeriesHeader header;
+        bool valid = seriesDecode(body, length, header, nullptr, 0);
+        connection.status = valid ? 200 : 400;
+        connection.readings = valid ? header.readingCount : 0;
+    } else if (strcasestr(head.c_str(), "application/json") != nullptr) {
+        // One "age_s" per reading in a batch, otherwise a single reading
+        std::string json((const char *)body, length);
+        bool valid = length > 0 && json[0] == '{' && json.find("\"device_id\"") != std::string::npos;
+        uint32_t readings = 0;
+        for (size_t at = json.find("\"age_s\""); at != std::string::npos; at = json.find("\"age_s\"", at + 1)) {
+            readings++;
+        }
+        connection.status = valid ? 200 : 400;
+        connection.readings = valid ? max(readings, 1u) : 0;
+    } else {
+        connection.status = 415;
+    }
+}
+
+static void ingestReply(IngestConnection &connection) {
+    const char *body = connection.status == 200 ? "{\"status\":\"ok\"}" : "{\"error\":\"stand-in\"}";
+    const char *reason = connection.status == 200 ? "OK"
+                       : connection.status == 503 ? "Service Unavailable"
+                       : connection.status == 413 ? "Payload Too Large" : "Bad Request";
+    char reply[256];
+    snprintf(reply, sizeof(reply),
+             "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+             "Connection: close\r\n\r\n%s",
+             connection.status, reason, (unsigned)strlen(body), body);
+    connection.reply = reply;
+    connection.sent = 0;
+    connection.state = INGEST_WRITING;
+}
+
+// Read what has arrived; true once the whole request is in
+static bool ingestRead(IngestConnection &connection, IngestStats &stats) {
+    char buffer[4096];
+    ssize_t n = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+        connection.fd = -1 - connection.fd; // Closed by the client
+        return false;
+    }
+    connection.request.insert(connection.request.end(), buffer, buffer + n);
+    stats.bytes += n;
+
+    if (connection.expected == 0) {
+        std::string head(connection.request.begin(), connection.request.end());
+        size_t headerEnd = head.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (connection.request.size() > SIM_INGEST_MAX_REQUEST) {
+                connection.status = 413;
+                return true;
+            }
+            return false;
+        }
+        const char *contentLength = strcasestr(head.c_str(), "\r\nContent-Length:");
+        size_t bodyLength = contentLength != nullptr ? strtoul(contentLength + 17, nullptr, 10) : 0;
+        connection.expected = headerEnd + 4 + bodyLength;
+        if (connection.expected > SIM_INGEST_MAX_REQUEST) {
+            connection.status = 413;
+            return true;
+        }
+    }
+    return connection.request.size() >= connection.expected;
+}
+
+static void ingestPrintSummary(const IngestStats &stats) {
+    printf("\n=== Ingestion Stand-in ===\n");
+    printf("Requests: %llu (%llu stored, %llu rejected with 503, %llu invalid)\n",
+           (unsigned long long)stats.requests, (unsigned long long)stats.accepted,
+           (unsigned long long)stats.rejected, (unsigned long long)stats.invalid);
+    printf("Readings stored: %llu, %llu bytes received\n", (unsigned long long)stats.readings,
+           (unsigned long long)stats.bytes);
+    printf("Queue: %u deepest, %.1f ms mean wait for a worker, %u connections at most\n", stats.maxQueued,
+           stats.requests > 0 ? stats.queueWaitUs / 1000.0 / stats.requests : 0.0, stats.maxConnections);
+    fflush(stdout);
+}
+
+static void ingestLoop(int listenFd, const SimIngestConfig &config) {
+    std::vector<IngestConnection *> connections;
+    std::deque<IngestConnection *> queue;
+    IngestStats stats = {};
+    uint32_t serving = 0;
+    uint32_t workers = max(config.workers, 1u);
+
+    while (!ingestStopRequested) {
+        uint64_t nowUs = simWallUs();
+    
+        // Finished service, then free workers take the oldest queued requests
+        for (IngestConnection *connection : connections) {
+            if (connection->state == INGEST_SERVING && nowUs >= connection->readyAtUs) {
+                serving--;
+                stats.requests++;
+                if (connection->status == 200) {
+                    stats.accepted++;
+                    stats.readings += connection->readings;
+                } else if (connection->status == 503) {
+                    stats.rejected++;
+                } else {
+                    stats.invalid++;
+                }
+                ingestReply(*connection);
+            }
+        }
+        while (serving < workers && !queue.empty()) {
+            IngestConnection *connection = queue.front();
+            queue.pop_front();
+        
+            // Service time varies ±50% around the mean
+            uint64_t serviceUs = config.serviceMs * (500ULL + simRandom() % 1001);
+            stats.queueWaitUs += nowUs - connection->queuedAtUs;
+            connection->readyAtUs = nowUs + serviceUs;
+            connection->state = INGEST_SERVING;
+            serving++;
+        }
+    
+        // Wait for sockets, or the next request to finish its service time
+        std::vector<pollfd> fds;
+        fds.push_back({listenFd, POLLIN, 0});
+        int timeoutMs = SIM_INGEST_POLL_MS;
+        for (IngestConnection *connection : connections) {
+            short events = connection->state == INGEST_READING ? POLLIN
+                         : connection->state == INGEST_WRITING ? POLLOUT : 0;
+            fds.push_back({connection->fd, events, 0});
+            if (connection->state == INGEST_SERVING) {
+                uint64_t waitUs = connection->readyAtUs > nowUs ? connection->readyAtUs - nowUs : 0;
+                timeoutMs = min(timeoutMs, (int)((waitUs + 999) / 1000));
+            }
+        }
+        if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+    
+        for (size_t i = 1; i < fds.size(); i++) {
+            IngestConnection &connection = *connections[i - 1];
+            if (connection.state == INGEST_READING && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                if (ingestRead(connection, stats)) {
+                    if (connection.status == 0) {
+                        ingestParse(connection, config);
+                    }
+                    connection.queuedAtUs = simWallUs();
+                    connection.state = INGEST_QUEUED;
+                    queue.push_back(&connection);
+                    stats.maxQueued = max(stats.maxQueued, (uint32_t)queue.size());
+                }
+            } else if (connection.state == INGEST_WRITING && (fds[i].revents & (POLLOUT | POLLHUP | POLLERR))) {
+                ssize_t sent = send(connection.fd, connection.reply.data() + connection.sent,
+                                    connection.reply.size() - connection.sent, MSG_NOSIGNAL);
+                if (sent > 0) {
+                    connection.sent += sent;
+                }
+                if (sent <= 0 || connection.sent >= connection.reply.size()) {
+                    close(connection.fd);
+                    connection.fd = -1 - connection.fd;
+                }
+            }
+        }
+    
+        // Drop closed connections (clients that gave up are dropped even when queued)
+        for (size_t i = 0; i < connections.size(); ) {
+            IngestConnection *connection = connections[i];
+            if (connection->fd < 0) {
+                if (connection->state == INGEST_SERVING) {
+                    serving--;
+                } else if (connection->state == INGEST_QUEUED) {
+                    queue.erase(std::find(queue.begin(), queue.end(), connection));
+                }
+                if (connection->state != INGEST_WRITING) {
+                    close(-1 - connection->fd);
+                }
+                delete connection;
+                connections[i] = connections.back();
+                connections.pop_back();
+            } else {
+                i++;
+            }
+        }
+    
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+                fcntl(fd, F_SETFL, O_NONBLOCK);
+                IngestConnection *connection = new IngestConnection();
+                connection->fd = fd;
+                connection->state = INGEST_READING;
+                connections.push_back(connection);
+            }
+            stats.maxConnections = max(stats.maxConnections, (uint32_t)connections.size());
+        }
+    }
+
+    for (IngestConnection *connection : connections) {
+        close(connection->fd < 0 ? -1 - connection->fd : connection->fd);
+        delete connection;
+    }
+    close(listenFd);
+    ingestPrintSummary(stats);
+}
+
+int simIngestStart(const SimIngestConfig &config, uint16_t *port) {
+    int listenFd = ingestListen(config.port);
+    if (listenFd < 0) {
+        return -1;
+    }
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    getsockname(listenFd, (sockaddr *)&address, &length);
+    *port = ntohs(address.sin_port);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        signal(SIGTERM, ingestStop);
+        ingestLoop(listenFd, config);
+        _exit(0);
+    }
+    close(listenFd);
+    return pid;
+}
+
+void simIngestStop(int server) {
+    if (server > 0) {
+        kill(server, SIGTERM);
+        waitpid(server, nullptr, 0);
+    }
+}
+
+int simIngestServe(const SimIngestConfig &config) {
+    int listenFd = ingestListen(config.port);
+    if (listenFd < 0) {
+        return 1;
+    }
+    printf("📥 Ingestion stand-in on http://127.0.0.1:%u%s (%u workers, %u ms per upload)\n",
+           config.port, DATA_ENDPOINT, config.workers, config.serviceMs);
+    fflush(stdout);
+    signal(SIGINT, ingestStop);
+    signal(SIGTERM, ingestStop);
+    ingestLoop(listenFd, config);
+    return 0;
+}
+
+// Fleet statistics (run process)
+
+static std::vector<SimRequest> requests;
+
+void simFleetRecord(const SimRequest &request) {
+    requests.push_back(request);
+}
+
+static uint32_t latencyPercentileUs(std::vector<uint32_t> &sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+void simFleetPrintProgress(uint64_t elapsedUs, uint32_t running) {
+    static size_t reported = 0;
+    static uint64_t reportedAtUs = 0;
+
+    std::vector<uint32_t> latencies;
+    for (size_t i = reported; i < requests.size(); i++) {
+        latencies.push_back(requests[i].latencyUs);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double seconds = (elapsedUs - reportedAtUs) / 1e6;
+    printf("⏱️  %5.0f s: %3u devices awake, %5.1f requests/s, p50 %.1f ms, p99 %.1f ms\n", elapsedUs / 1e6,
+           running, seconds > 0 ? latencies.size() / seconds : 0.0,
+           latencyPercentileUs(latencies, 50) / 1000.0, latencyPercentileUs(latencies, 99) / 1000.0);
+    fflush(stdout);
+    reported = requests.size();
+    reportedAtUs = elapsedUs;
+}
+
+void simFleetPrintSummary(uint32_t devices, uint64_t elapsedUs) {
+    std::vector<uint32_t> latencies;
+    std::map<uint64_t, uint32_t> perSecond;
+    uint32_t success = 0, clientErrors = 0, serverErrors = 0, failed = 0;
+    uint64_t firstUs = UINT64_MAX, lastUs = 0;
+    for (const SimRequest &request : requests) {
+        latencies.push_back(request.latencyUs);
+        perSecond[request.wallStartUs / 1000000ULL]++;
+        firstUs = min(firstUs, request.wallStartUs);
+        lastUs = max(lastUs, request.wallStartUs + request.latencyUs);
+        if (request.status >= 200 && request.status < 300) {
+            success++;
+        } else if (request.status >= 400 && request.status < 500) {
+            clientErrors++;
+        } else if (request.status >= 500) {
+            serverErrors++;
+        } else {
+            failed++;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    uint32_t peak = 0;
+    for (const auto &second : perSecond) {
+        peak = max(peak, second.second);
+    }
+    double spanS = lastUs > firstUs ? (lastUs - firstUs) / 1e6 : 0.0;
+
+    printf("\n=== Fleet Summary ===\n");
+    printf("Devices: %u, %.1f s wall time\n", devices, elapsedUs / 1e6);
+    printf("Requests: %zu (%u 2xx, %u 4xx, %u 5xx, %u without a reply)\n", requests.size(), success,
+           clientErrors, serverErrors, failed);
+    printf("Throughput: %.1f requests/s over %.1f s, %u in the busiest second\n",
+           spanS > 0 ? requests.size() / spanS : 0.0, spanS, peak);
+    printf("Latency: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           latencyPercentileUs(latencies, 50) / 1000.0, latencyPercentileUs(latencies, 90) / 1000.0,
+           latencyPercentileUs(latencies, 99) / 1000.0, latencyPercentileUs(latencies, 100) / 1000.0);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,374 @@
+/*
+ * PlantBot2 Host Simulation - WiFi and Server Stand-in
+ * 
+ * See sim.h. The simulated network has one access point and a server that
+ * accepts every POST with the scenario's HTTP status, unless a fleet run
+ * sends uploads to a real server.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiManager.h>
+#include <HTTPClient.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
+#include <esp_bt.h>
+#include "telemetry_codec.h"
+#include "series_codec.h"
+#include "sim.h"
+
+#define SIM_WIFI_FAST_CONNECT_US    300000ULL   // Known BSSID, channel and IP
+#define SIM_WIFI_FULL_CONNECT_US    2500000ULL  // Channel scan and DHCP
+#define SIM_TCP_CONNECT_US          20000ULL
+#define SIM_HTTP_ROUND_TRIP_US      150000ULL
+#define SIM_DHCP_LEASE_S            28800       // 8 hours, shorter than WIFI_LEASE_CACHE_S
+
+#define SIM_WIFI_SSID       "plantbot-sim"
+#define SIM_WIFI_PASSWORD   "plantbot-sim"
+#define SIM_WIFI_CHANNEL    6
+
+static const uint8_t simBssid[6] = {0x02, 0x50, 0x42, 0xAA, 0x00, 0x01};
+static const IPAddress simGateway(192, 168, 4, 1);
+static const IPAddress simSubnet(255, 255, 255, 0);
+static const IPAddress simDhcpAddress(192, 168, 4, 20);
+
+WiFiClass WiFi;
+
+static wl_status_t wifiStatus = WL_DISCONNECTED;
+static uint64_t wifiConnectAtUs = 0;   // Association completes at this time
+static bool linkUp = false;            // This association attempt succeeds
+static IPAddress staticIP;             // From WiFi.config(), 0 = DHCP
+static IPAddress assignedIP;
+static uint8_t currentBssid[6];
+static struct dhcp stationDhcp;        // Lease of the last DHCP bind
+static struct netif stationNetif = {&stationDhcp};
+
+// WiFi driver
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) {
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit() {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop() {
+    WiFi.disconnect(true);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) {
+    (void)type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *config) {
+    if (interface != WIFI_IF_STA) {
+        return ESP_FAIL;
+    }
+    memset(config, 0, sizeof(*config));
+    strcpy((char *)config->sta.ssid, SIM_WIFI_SSID);
+    strcpy((char *)config->sta.password, SIM_WIFI_PASSWORD);
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key) {
+    return strcmp(if_key, "WIFI_STA_DEF") == 0 ? (esp_netif_t *)&stationNetif : nullptr;
+}
+
+void *esp_netif_get_netif_impl(esp_netif_t *esp_netif) {
+    return esp_netif;
+}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *config) {
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_deinit() {
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_disable() {
+    return ESP_OK;
+}
+
+// WiFi station
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password, int32_t channel,
+                             const uint8_t *bssid, bool connect) {
+    (void)password;
+    simRadioOn();
+    
+    if (ssid != nullptr && strcmp(ssid, SIM_WIFI_SSID) != 0) {
+        wifiStatus = WL_NO_SSID_AVAIL;
+        return wifiStatus;
+    }
+    if (!connect) {
+        return wifiStatus;
+    }
+    
+    // A stale BSSID or channel still finds the AP, by scanning
+    bool known = channel == SIM_WIFI_CHANNEL && bssid != nullptr && memcmp(bssid, simBssid, 6) == 0;
+    bool fast = known && (uint32_t)staticIP != 0;
+    wifiConnectAtUs = simNowUs() + (fast ? SIM_WIFI_FAST_CONNECT_US : SIM_WIFI_FULL_CONNECT_US);
+    wifiStatus = WL_IDLE_STATUS;
+    linkUp = simLinkAttempt();
+    return wifiStatus;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    (void)gateway;
+    (void)subnet;
+    (void)dns1;
+    (void)dns2;
+    staticIP = localIP;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)eraseAp;
+    wifiStatus = WL_DISCONNECTED;
+    wifiConnectAtUs = 0;
+    if (wifiOff) {
+        simRadioOff();
+    }
+    return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    if (mode == WIFI_OFF) {
+        disconnect(true);
+    } else {
+        simRadioOn();
+    }
+    return true;
+}
+
+bool WiFiClass::setSleep(bool enabled) {
+    (void)enabled;
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    if (wifiStatus == WL_IDLE_STATUS && simNowUs() >= wifiConnectAtUs) {
+        // The AP has to be up when association would complete
+        if (linkUp && simConditions().wifi) {
+            wifiStatus = WL_CONNECTED;
+            assignedIP = (uint32_t)staticIP != 0 ? staticIP : simDhcpAddress;
+            if ((uint32_t)staticIP == 0) {
+                stationDhcp.offered_t0_lease = SIM_DHCP_LEASE_S;
+            }
+            memcpy(currentBssid, simBssid, 6);
+        } else {
+            wifiStatus = WL_NO_SSID_AVAIL;
+        }
+    }
+    return wifiStatus;
+}
+
+String WiFiClass::SSID() const {
+    return String(wifiStatus == WL_CONNECTED ? SIM_WIFI_SSID : "");
+}
+
+String WiFiClass::macAddress() const {
+    uint8_t mac[6];
+    simDeviceMac(mac);
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return String(text);
+}
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac) const {
+    simDeviceMac(mac);
+    return mac;
+}
+
+int8_t WiFiClass::RSSI() const {
+    return wifiStatus == WL_CONNECTED ? -60 - (int8_t)(simRandom() % 8) : 0;
+}
+
+uint8_t *WiFiClass::BSSID() {
+    return currentBssid;
+}
+
+int32_t WiFiClass::channel() const {
+    return wifiStatus == WL_CONNECTED ? SIM_WIFI_CHANNEL : 0;
+}
+
+IPAddress WiFiClass::localIP() const {
+    return wifiStatus == WL_CONNECTED ? assignedIP : IPAddress();
+}
+
+IPAddress WiFiClass::gatewayIP() const {
+    return wifiStatus == WL_CONNECTED ? simGateway : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask() const {
+    return wifiStatus == WL_CONNECTED ? simSubnet : IPAddress();
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t index) const {
+    (void)index;
+    return gatewayIP();
+}
+
+int WiFiClass::hostByName(const char *host, IPAddress &ip) {
+    // Every name points at the server stand-in
+    if (ip.fromString(host)) {
+        return 1;
+    }
+    if (status() != WL_CONNECTED) {
+        return 0;
+    }
+    delay(20);
+    ip = IPAddress(127, 0, 0, 1);
+    return 1;
+}
+
+bool WiFiManager::autoConnect(const char *apName, const char *apPassword) {
+    (void)apName;
+    (void)apPassword;
+    
+    WiFi.begin();
+    while (WiFi.status() != WL_CONNECTED && WiFi.status() != WL_NO_SSID_AVAIL) {
+        delay(100);
+    }
+    return WiFi.status() == WL_CONNECTED;
+}
+
+// TCP and HTTP
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    (void)ip;
+    (void)port;
+    delayMicroseconds(SIM_TCP_CONNECT_US);
+    
+    // The server stand-in refuses connections while it reports status 0
+    _connected = WiFi.status() == WL_CONNECTED && simConditions().httpStatus != 0;
+    return _connected;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+    IPAddress ip;
+    return WiFi.hostByName(host, ip) && connect(ip, port);
+}
+
+uint8_t WiFiClient::connected() {
+    return _connected;
+}
+
+void WiFiClient::stop() {
+    _connected = false;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const char *host, uint16_t port, const char *uri, bool https) {
+    (void)client;
+    (void)https;
+    _host = host;
+    _port = port;
+    _uri = uri;
+    _contentType = "";
+    return true;
+}
+
+bool HTTPClient::begin(const String &url) {
+    // http://host[:port]/path
+    int hostStart = url.indexOf('/') + 2;
+    int pathStart = url.indexOf('/', hostStart);
+    String authority = url.substring(hostStart, pathStart < 0 ? ~0u : pathStart);
+    int colon = authority.indexOf(':');
+    _host = colon < 0 ? authority : authority.substring(0, colon);
+    _port = colon < 0 ? 80 : (uint16_t)atoi(authority.substring(colon + 1).c_str());
+    _uri = pathStart < 0 ? String("/") : url.substring(pathStart);
+    _contentType = "";
+    return true;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+    if (strcasecmp(name.c_str(), "Content-Type") == 0) {
+        _contentType = value;
+    }
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size) {
+    if (WiFi.status() != WL_CONNECTED) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    
+    char response[128];
+    int status = simHttpPost(_host.c_str(), _port, _uri.c_str(), _contentType.c_str(),
+                             payload, size, response, sizeof(response));
+    _response = status > 0 ? response : "";
+    return status;
+}
+
+int HTTPClient::POST(const String &payload) {
+    return POST((uint8_t *)payload.c_str(), payload.length());
+}
+
+String HTTPClient::getString() {
+    return _response;
+}
+
+void HTTPClient::end() {
+    _response = "";
+}
+
+// Binary frames and series blocks have a reading count, JSON batches one "age_s" per reading
+// and anything else is a single reading
+static uint32_t countReadings(const char *contentType, const uint8_t *payload, size_t length) {
+    TelemetryHeader header;
+    if (strcmp(contentType, TELEMETRY_CONTENT_TYPE) == 0 && telemetryDecode(payload, length, header, nullptr, 0)) {
+        return header.readingCount;
+    }
+    SeriesHeader series;
+    if (strcmp(contentType, SERIES_CONTENT_TYPE) == 0 && seriesDecode(payload, length, series, nullptr, 0)) {
+        return series.readingCount;
+    }
+    if (strstr(contentType, "json") == nullptr) {
+        return 1;
+    }
+    static const char key[] = "\"age_s\"";
+    const size_t keyLength = sizeof(key) - 1;
+    uint32_t count = 0;
+    for (size_t i = 0; i + keyLength <= length; i++) {
+        if (memcmp(payload + i, key, keyLength) == 0) {
+            count++;
+        }
+    }
+    return max(count, 1u);
+}
+
+int simHttpPost(const char *host, uint16_t port, const char *path, const char *contentType,
+                const uint8_t *payload, size_t length, char *response, size_t responseSize) {
+    int status;
+    if (simTargetActive()) {
+        // Fleet runs: a real server decides, on the wall clock
+        status = simTargetPost(contentType, payload, length, response, responseSize);
+    } else {
+        // Request and response on the air, then the scenario decides the reply
+        simAdvanceUs(SIM_HTTP_ROUND_TRIP_US + length * 8ULL);
+        status = simConditions().httpStatus;
+        if (status == 0) {
+            status = HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        
+        const char *body = (status >= 200 && status < 300) ? "{\"status\":\"ok\"}" : "{\"error\":\"simulated\"}";
+        snprintf(response, responseSize, "%s", body);
+    }
+    simRecordHttp(status, length, countReadings(contentType, payload, length));
+    
+    Serial.printf("[server] POST %s:%u%s (%s, %u bytes) -> %d\n", host, port, path,
+                  contentType[0] ? contentType : "no content type", (unsigned)length, status);
+    return status;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,287 @@
+/*
+ * PlantBot2 Host Simulation - GPIO, ADC and I2C
+ * 
+ * See sim.h. Analog inputs are turned back into raw ADC counts with the
+ * board calibration in plantbot2_board.h, so the firmware's conversions
+ * reproduce the scenario values.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_adc/adc_continuous.h>
+#include "plantbot2_board.h"
+#include "sim.h"
+
+#define SIM_GPIO_COUNT          32
+#define SIM_ADC_NOISE_COUNTS    3       // Peak noise on every conversion
+#define SIM_AHT20_MEASURE_US    80000   // Conversion time after a trigger
+
+static uint8_t pinLevels[SIM_GPIO_COUNT];
+static uint8_t pinModes[SIM_GPIO_COUNT];
+
+TwoWire Wire;
+
+// GPIO
+
+int simPinLevel(int pin) {
+    return (pin >= 0 && pin < SIM_GPIO_COUNT) ? pinLevels[pin] : LOW;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= SIM_GPIO_COUNT) {
+        return;
+    }
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+        pinLevels[pin] = HIGH;
+    } else if (mode != OUTPUT) {
+        pinLevels[pin] = LOW;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < SIM_GPIO_COUNT && pinModes[pin] == OUTPUT) {
+        pinLevels[pin] = level ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return simPinLevel(pin);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    for (int pin = 0; pin < SIM_GPIO_COUNT; pin++) {
+        if (config->pin_bit_mask & (1ULL << pin)) {
+            pinMode(pin, config->mode == GPIO_MODE_OUTPUT ? OUTPUT
+                         : config->pull_up_en ? INPUT_PULLUP
+                         : config->pull_down_en ? INPUT_PULLDOWN : INPUT);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t pin, gpio_pull_mode_t mode) {
+    if (pin >= 0 && pin < SIM_GPIO_COUNT && pinModes[pin] != OUTPUT) {
+        pinLevels[pin] = (mode == GPIO_PULLUP_ONLY || mode == GPIO_PULLUP_PULLDOWN) ? HIGH : LOW;
+    }
+    return ESP_OK;
+}
+
+// ADC
+
+static int noisyCounts(float counts) {
+    int noise = (int)(simRandom() % (2 * SIM_ADC_NOISE_COUNTS + 1)) - SIM_ADC_NOISE_COUNTS;
+    return constrain((int)lroundf(counts) + noise, 0, 4095);
+}
+
+static int adcCounts(int pin) {
+    SimConditions conditions = simConditions();
+    switch (pin) {
+    case PIN_BATTERY_READ:
+        // Inverse of voltage = m * adc + c
+        return noisyCounts((conditions.batteryMv / 1000.0f - BATTERY_CALIB_INTERCEPT) / BATTERY_CALIB_SLOPE);
+    case PIN_LIGHT_SENSOR:
+        return noisyCounts(conditions.light);
+    case PIN_MOISTURE_SENS:
+        return noisyCounts(conditions.moisture);
+    default:
+        return 0;
+    }
+}
+
+uint16_t analogRead(uint8_t pin) {
+    delayMicroseconds(20);
+    return adcCounts(pin);
+}
+
+struct SimAdcContinuous {
+    adc_digi_pattern_config_t pattern[SOC_ADC_PATT_LEN_MAX];
+    uint32_t patternLength;
+    uint32_t sampleFreqHz;
+    bool running;
+};
+
+esp_err_t adc_continuous_io_to_channel(int ioNum, adc_unit_t *unit, adc_channel_t *channel) {
+    // ESP32-C6: GPIO0-6 are ADC1 channels 0-6
+    if (ioNum < 0 || ioNum > ADC_CHANNEL_6) {
+        return ESP_FAIL;
+    }
+    *unit = ADC_UNIT_1;
+    *channel = (adc_channel_t)ioNum;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *config, adc_continuous_handle_t *handle) {
+    (void)config;
+    *handle = new SimAdcContinuous();
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config) {
+    if (config->pattern_num == 0 || config->pattern_num > SOC_ADC_PATT_LEN_MAX) {
+        return ESP_FAIL;
+    }
+    memcpy(handle->pattern, config->adc_pattern, config->pattern_num * sizeof(adc_digi_pattern_config_t));
+    handle->patternLength = config->pattern_num;
+    handle->sampleFreqHz = config->sample_freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) {
+    handle->running = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) {
+    handle->running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_flush_pool(adc_continuous_handle_t handle) {
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buffer, uint32_t length,
+                              uint32_t *outLength, uint32_t timeoutMs) {
+    if (!handle->running || handle->patternLength == 0) {
+        delay(timeoutMs);
+        return ESP_FAIL;
+    }
+    
+    // A full frame of conversions, cycling through the pattern
+    uint32_t conversions = length / SOC_ADC_DIGI_RESULT_BYTES;
+    for (uint32_t i = 0; i < conversions; i++) {
+        const adc_digi_pattern_config_t &entry = handle->pattern[i % handle->patternLength];
+        adc_digi_output_data_t sample = {};
+        sample.type2.channel = entry.channel;
+        sample.type2.unit = entry.unit;
+        sample.type2.data = adcCounts(entry.channel);
+        memcpy(&buffer[i * SOC_ADC_DIGI_RESULT_BYTES], &sample, SOC_ADC_DIGI_RESULT_BYTES);
+    }
+    *outLength = conversions * SOC_ADC_DIGI_RESULT_BYTES;
+    
+    delayMicroseconds(conversions * 1000000ULL / max(handle->sampleFreqHz, 1u));
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle) {
+    delete handle;
+    return ESP_OK;
+}
+
+// I2C bus with an AHT20
+
+static uint64_t aht20ReadyAtUs = 0;     // End of the running conversion
+static uint8_t aht20Result[7];          // Status, humidity, temperature, CRC
+
+static bool aht20Present(uint16_t address) {
+    return address == I2C_ADDR_AHT20 && simPinLevel(PIN_I2C_POWER) == HIGH;
+}
+
+static uint8_t aht20Crc(const uint8_t *data, size_t length) {
+    // CRC-8, polynomial 0x31, initial value 0xFF
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void aht20Trigger() {
+    SimConditions conditions = simConditions();
+    uint32_t rawHumidity = (uint32_t)constrain(conditions.humidity / 100.0f * 1048576.0f, 0.0f, 1048575.0f);
+    uint32_t rawTemperature = (uint32_t)constrain((conditions.temperature + 50.0f) / 200.0f * 1048576.0f,
+                                                  0.0f, 1048575.0f);
+    
+    aht20Result[0] = 0x18; // Idle, calibrated
+    aht20Result[1] = rawHumidity >> 12;
+    aht20Result[2] = rawHumidity >> 4;
+    aht20Result[3] = ((rawHumidity & 0x0F) << 4) | (rawTemperature >> 16);
+    aht20Result[4] = rawTemperature >> 8;
+    aht20Result[5] = rawTemperature;
+    aht20Result[6] = aht20Crc(aht20Result, 6);
+    aht20ReadyAtUs = simNowUs() + SIM_AHT20_MEASURE_US;
+    simRecordReading();
+}
+
+static uint8_t aht20Status() {
+    return simNowUs() < aht20ReadyAtUs ? 0x98 : 0x18;
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    (void)frequency;
+    _enabled = true;
+    return true;
+}
+
+bool TwoWire::end() {
+    _enabled = false;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    (void)frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+    _address = address;
+    _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (_txLength >= sizeof(_txBuffer)) {
+        return 0;
+    }
+    _txBuffer[_txLength++] = data;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    delayMicroseconds(100 + 90 * _txLength);
+    if (!_enabled || !aht20Present(_address)) {
+        return 2; // Address NACK
+    }
+    
+    if (_txLength >= 1 && _txBuffer[0] == 0xAC) {
+        aht20Trigger();
+    }
+    return 0;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t quantity, bool sendStop) {
+    (void)sendStop;
+    _rxLength = 0;
+    _rxIndex = 0;
+    delayMicroseconds(100 + 90 * quantity);
+    if (!_enabled || !aht20Present(address) || quantity > sizeof(_rxBuffer)) {
+        return 0;
+    }
+    
+    _rxBuffer[0] = aht20Status();
+    for (size_t i = 1; i < quantity; i++) {
+        _rxBuffer[i] = i < sizeof(aht20Result) ? aht20Result[i] : 0xFF;
+    }
+    _rxLength = quantity;
+    return quantity;
+}
+
+int TwoWire::available() {
+    return (int)(_rxLength - _rxIndex);
+}
+
+int TwoWire::read() {
+    return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,255 @@
+/*
+ * PlantBot2 Host Simulation - Flash and NVS
+ * 
+ * See sim.h. Every device has its own flash and NVS in memory shared with
+ * the run process, so both outlive the wake process like the real chip's
+ * flash outlives a reset. Sectors read as erased until first used.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <Preferences.h>
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define SIM_FLASH_SECTOR_SIZE   4096
+#define SIM_FLASH_SECTORS       (0x1E0000 / SIM_FLASH_SECTOR_SIZE)  // "tlog" in partitions.csv
+#define SIM_FLASH_WRITE_US      60      // Page program, up to 256 bytes
+#define SIM_FLASH_ERASE_US      45000   // Sector erase
+#define SIM_FLASH_READ_BYTES_PER_US 16  // Cached SPI flash reads
+#define SIM_NVS_ENTRIES         16
+#define SIM_NVS_VALUE_SIZE      64
+#define SIM_NVS_WRITE_US        1500    // Entry write including the page bookkeeping
+
+struct SimNvsEntry {
+    char name[16];          // Namespace
+    char key[16];
+    uint32_t length;        // 0 = unused
+    uint8_t value[SIM_NVS_VALUE_SIZE];
+};
+
+struct SimStorage {
+    uint32_t flashWrites;
+    uint32_t nvsWrites;
+    uint32_t eraseCount[SIM_FLASH_SECTORS];     // 0 = never used, reads as erased
+    SimNvsEntry nvs[SIM_NVS_ENTRIES];
+    uint8_t flash[SIM_FLASH_SECTORS][SIM_FLASH_SECTOR_SIZE];
+};
+
+static SimStorage *regions = nullptr;
+static uint32_t regionCount = 0;
+static SimStorage *storage = nullptr;
+
+static const esp_partition_t logPartition = {
+    ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, 0x210000, SIM_FLASH_SECTORS * SIM_FLASH_SECTOR_SIZE,
+    SIM_FLASH_SECTOR_SIZE, "tlog", false,
+};
+
+bool simStorageBegin(uint32_t devices) {
+    // Only the pages a device touches are ever allocated
+    regions = (SimStorage *)mmap(nullptr, devices * sizeof(SimStorage), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (regions == MAP_FAILED) {
+        perror("mmap");
+        regions = nullptr;
+        return false;
+    }
+    regionCount = devices;
+    simStorageSelect(1);
+    return true;
+}
+
+void simStorageSelect(uint32_t device) {
+    storage = (regions != nullptr && device >= 1 && device <= regionCount) ? &regions[device - 1] : nullptr;
+}
+
+void simStoragePrintSummary() {
+    uint64_t writes = 0, erases = 0, nvsWrites = 0;
+    uint32_t maxErases = 0;
+    for (uint32_t d = 0; d < regionCount; d++) {
+        writes += regions[d].flashWrites;
+        nvsWrites += regions[d].nvsWrites;
+        for (uint32_t sector = 0; sector < SIM_FLASH_SECTORS; sector++) {
+            // Counts start at 1 when a sector comes into use
+            uint32_t count = regions[d].eraseCount[sector];
+            erases += count > 0 ? count - 1 : 0;
+            maxErases = max(maxErases, count > 0 ? count - 1 : 0);
+        }
+    }
+    printf("Flash: %llu writes, %llu sector erases (at most %u per sector), %llu NVS writes\n",
+           (unsigned long long)writes, (unsigned long long)erases, maxErases, (unsigned long long)nvsWrites);
+}
+
+// Flash partition
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (storage == nullptr || type != logPartition.type ||
+        (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != logPartition.subtype) ||
+        (label != nullptr && strcmp(label, logPartition.label) != 0)) {
+        return nullptr;
+    }
+    return &logPartition;
+}
+
+static bool inPartition(const esp_partition_t *partition, size_t offset, size_t size) {
+    return partition == &logPartition && storage != nullptr && offset <= partition->size &&
+           size <= partition->size - offset;
+}
+
+// Factory-fresh sectors are erased
+static void useSector(uint32_t sector) {
+    if (storage->eraseCount[sector] == 0) {
+        memset(storage->flash[sector], 0xFF, SIM_FLASH_SECTOR_SIZE);
+        storage->eraseCount[sector] = 1;
+    }
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size) {
+    if (!inPartition(partition, src_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    delayMicroseconds(2 + size / SIM_FLASH_READ_BYTES_PER_US);
+    
+    uint8_t *out = (uint8_t *)dst;
+    while (size > 0) {
+        uint32_t sector = src_offset / SIM_FLASH_SECTOR_SIZE;
+        size_t inSector = src_offset % SIM_FLASH_SECTOR_SIZE;
+        size_t chunk = min(size, SIM_FLASH_SECTOR_SIZE - inSector);
+        if (storage->eraseCount[sector] == 0) {
+            memset(out, 0xFF, chunk);
+        } else {
+            memcpy(out, &storage->flash[sector][inSector], chunk);
+        }
+        out += chunk;
+        src_offset += chunk;
+        size -= chunk;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size) {
+    if (!inPartition(partition, dst_offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Programming only clears bits; one program operation per page touched
+    const uint8_t *in = (const uint8_t *)src;
+    for (size_t i = 0; i < size; i++) {
+        size_t offset = dst_offset + i;
+        uint32_t sector = offset / SIM_FLASH_SECTOR_SIZE;
+        useSector(sector);
+        storage->flash[sector][offset % SIM_FLASH_SECTOR_SIZE] &= in[i];
+    }
+    size_t pages = size > 0 ? (dst_offset + size - 1) / 256 - dst_offset / 256 + 1 : 0;
+    delayMicroseconds(pages * SIM_FLASH_WRITE_US);
+    storage->flashWrites++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size) {
+    if (!inPartition(partition, offset, size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset % SIM_FLASH_SECTOR_SIZE != 0 || size % SIM_FLASH_SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    for (uint32_t sector = offset / SIM_FLASH_SECTOR_SIZE; sector < (offset + size) / SIM_FLASH_SECTOR_SIZE; sector++) {
+        useSector(sector);
+        memset(storage->flash[sector], 0xFF, SIM_FLASH_SECTOR_SIZE);
+        storage->eraseCount[sector]++;
+        delayMicroseconds(SIM_FLASH_ERASE_US);
+    }
+    return ESP_OK;
+}
+
+// NVS
+
+static SimNvsEntry *findEntry(const char *name, const char *key) {
+    for (int i = 0; i < SIM_NVS_ENTRIES; i++) {
+        SimNvsEntry &entry = storage->nvs[i];
+        if (entry.length > 0 && strcmp(entry.name, name) == 0 && strcmp(entry.key, key) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel) {
+    (void)partitionLabel;
+    if (storage == nullptr || strlen(name) >= sizeof(_name)) {
+        return false;
+    }
+    strcpy(_name, name);
+    _readOnly = readOnly;
+    _open = true;
+    return true;
+}
+
+void Preferences::end() {
+    _open = false;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+    if (!_open || _readOnly || length == 0 || length > SIM_NVS_VALUE_SIZE ||
+        strlen(key) >= sizeof(SimNvsEntry::key)) {
+        return 0;
+    }
+    
+    SimNvsEntry *entry = findEntry(_name, key);
+    for (int i = 0; entry == nullptr && i < SIM_NVS_ENTRIES; i++) {
+        if (storage->nvs[i].length == 0) {
+            entry = &storage->nvs[i];
+            strcpy(entry->name, _name);
+            strcpy(entry->key, key);
+        }
+    }
+    if (entry == nullptr) {
+        return 0; // NVS full
+    }
+    
+    memcpy(entry->value, value, length);
+    entry->length = length;
+    storage->nvsWrites++;
+    delayMicroseconds(SIM_NVS_WRITE_US);
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength) {
+    const SimNvsEntry *entry = _open ? findEntry(_name, key) : nullptr;
+    if (entry == nullptr || entry->length > maxLength) {
+        return 0;
+    }
+    memcpy(buffer, entry->value, entry->length);
+    return entry->length;
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+    uint32_t value;
+    const SimNvsEntry *entry = _open ? findEntry(_name, key) : nullptr;
+    if (entry == nullptr || entry->length != sizeof(value)) {
+        return defaultValue;
+    }
+    memcpy(&value, entry->value, sizeof(value));
+    return value;
+}
+
+bool Preferences::remove(const char *key) {
+    SimNvsEntry *entry = (_open && !_readOnly) ? findEntry(_name, key) : nullptr;
+    if (entry == nullptr) {
+        return false;
+    }
+    entry->length = 0;
+    return true;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,46 @@
+/*
+ * PlantBot2 Power Policy
+ * 
+ * See power_policy.h.
+ */
+
+#include "power_policy.h"
+#include "rtc_arena.h"
+#include "rtc_ring.h"
+
+// Battery voltage history for trend analysis (RTC arena)
+typedef RtcRing<uint16_t, BATTERY_TREND_SAMPLES> BatteryHistory;
+
+static BatteryHistory &batteryHistory() {
+    return *rtcArenaRegion<BatteryHistory>(RTC_REGION_POWER);
+}
+
+void updateBatteryHistory(int32_t batteryMv) {
+    BatteryHistory &history = batteryHistory();
+    history.push((uint16_t)constrain(batteryMv, (int32_t)0, (int32_t)UINT16_MAX));
+    
+    Serial.printf("Battery history updated: %ldmV (%d of %d)\n", (long)batteryMv, history.count(),
+                  BatteryHistory::CAPACITY);
+}
+
+BatteryTrend batteryTrend(int recentSteps) {
+    const BatteryHistory &history = batteryHistory();
+    BatteryTrend trend = {};
+    trend.samples = history.count();
+    if (trend.samples == 0) {
+        return trend;
+    }
+    
+    // The ring keeps running sums, so none of this walks the history.
+    // Rises telescope to the difference between their end points; the
+    // policies scale their per-reading thresholds by the step count
+    trend.currentMv = history.newest();
+    trend.overallSteps = trend.samples - 1;
+    trend.overallRiseMv = history.rise(trend.overallSteps);
+    trend.recentSteps = min(recentSteps, trend.overallSteps);
+    trend.recentRiseMv = history.rise(trend.recentSteps);
+    trend.meanMv = history.mean();
+    trend.slopeUv = history.slope(1000);
+    
+    return trend;
+}
@@ -0,0 +1,137 @@
+/*
+ * PlantBot2 Reading Batch
+ * 
+ * See reading_batch.h.
+ */
+
+#include "reading_batch.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include "fixed_point.h"
+#include <time.h>
+
+// Ring buffer of queued readings and the previous wake's reading for
+// threshold crossing detection (RTC arena)
+struct BatchState {
+    BatchedReading buffer[BATCH_BUFFER_SIZE];
+    uint8_t head;               // Index of the oldest reading
+    uint8_t length;
+    uint32_t sequence;          // Readings ever queued since power-on
+    bool previousValid;
+    bool previousDry;
+    bool previousLowBattery;
+};
+
+static BatchState &batchState() {
+    return *rtcArenaRegion<BatchState>(RTC_REGION_BATCH);
+}
+
+void batchAppend(const SensorData &data, bool charging) {
+    BatchedReading reading;
+    reading.takenAt = (uint32_t)time(nullptr);
+    reading.temperatureCenti = (int16_t)fixedSaturate(data.temperature, 100, INT16_MIN + 1, INT16_MAX,
+                                                      BATCH_TEMPERATURE_NONE);
+    reading.humidityCenti = (uint16_t)fixedSaturate(data.humidity, 100, 0, 10000, BATCH_CENTI_NONE);
+    reading.batteryMv = (uint16_t)fixedSaturate(data.batteryVoltage, 1000, 0, UINT16_MAX, 0);
+    reading.lightLevel = (uint16_t)constrain(data.lightLevel, 0, UINT16_MAX);
+    reading.moistureLevel = (uint16_t)constrain(data.moistureLevel, 0, UINT16_MAX);
+    reading.moistureCenti = (uint16_t)fixedSaturate(data.moisturePercent, 100, 0, 10000, BATCH_CENTI_NONE);
+    reading.flags = (data.lowBattery ? BATCH_FLAG_LOW_BATTERY : 0) |
+                    (charging ? BATCH_FLAG_CHARGING : 0);
+    
+    BatchState &batch = batchState();
+    if (batch.length == BATCH_BUFFER_SIZE) {
+        // Buffer full (uploads keep failing) - overwrite the oldest reading
+        batch.head = (batch.head + 1) % BATCH_BUFFER_SIZE;
+        batch.length--;
+    }
+    
+    batch.buffer[(batch.head + batch.length) % BATCH_BUFFER_SIZE] = reading;
+    batch.length++;
+    batch.sequence++;
+}
+
+uint32_t batchFirstSequence() {
+    const BatchState &batch = batchState();
+    return batch.sequence - batch.length;
+}
+
+int batchCount() {
+    return batchState().length;
+}
+
+const BatchedReading &batchAt(int index) {
+    const BatchState &batch = batchState();
+    return batch.buffer[(batch.head + index) % BATCH_BUFFER_SIZE];
+}
+
+uint32_t batchAgeS(const BatchedReading &reading) {
+    return (uint32_t)time(nullptr) - reading.takenAt;
+}
+
+bool batchUploadDue(bool powerOnReset, int pendingReadings) {
+    const BatchState &batch = batchState();
+    int queued = batch.length + pendingReadings;
+    if (queued > 0 && (powerOnReset || queued >= BATCH_SIZE)) {
+        return true;
+    }
+    
+    return batch.length > 0 && batchAgeS(batchAt(0)) >= BATCH_MAX_AGE_MINUTES * 60UL;
+}
+
+bool batchThresholdEvent(const SensorData &data) {
+    BatchState &batch = batchState();
+    bool isDry = data.moisturePercent < BATCH_FLUSH_MOISTURE_PERCENT;
+    bool event = false;
+    
+    if (batch.previousValid) {
+        // Soil just dried out past the alert level
+        if (isDry && !batch.previousDry) {
+            Serial.printf("📦 Moisture dropped below %d%%, uploading early\n", BATCH_FLUSH_MOISTURE_PERCENT);
+            event = true;
+        }
+        
+        // Battery just entered the low range
+        if (data.lowBattery && !batch.previousLowBattery) {
+            Serial.println("📦 Battery became low, uploading early");
+            event = true;
+        }
+    }
+    
+    batch.previousDry = isDry;
+    batch.previousLowBattery = data.lowBattery;
+    batch.previousValid = true;
+    
+    return event;
+}
+
+void batchClear() {
+    BatchState &batch = batchState();
+    batch.head = 0;
+    batch.length = 0;
+}
+
+void batchDropOldest(int count) {
+    BatchState &batch = batchState();
+    count = constrain(count, 0, (int)batch.length);
+    batch.head = (batch.head + count) % BATCH_BUFFER_SIZE;
+    batch.length -= count;
+}
+
+void batchShiftClock(int32_t stepS) {
+    BatchState &batch = batchState();
+    for (int i = 0; i < batch.length; i++) {
+        batch.buffer[(batch.head + i) % BATCH_BUFFER_SIZE].takenAt += stepS;
+    }
+}
+
+void batchToSensorData(const BatchedReading &reading, SensorData &data) {
+    data.temperature = reading.temperatureCenti == BATCH_TEMPERATURE_NONE ? NAN : reading.temperatureCenti / 100.0f;
+    data.humidity = reading.humidityCenti == BATCH_CENTI_NONE ? NAN : reading.humidityCenti / 100.0f;
+    data.batteryVoltage = reading.batteryMv / 1000.0f;
+    data.lightLevel = reading.lightLevel;
+    data.moistureLevel = reading.moistureLevel;
+    data.moisturePercent = reading.moistureCenti == BATCH_CENTI_NONE ? NAN : reading.moistureCenti / 100.0f;
+    data.timestamp = reading.takenAt;
+    data.lowBattery = (reading.flags & BATCH_FLAG_LOW_BATTERY) != 0;
+}
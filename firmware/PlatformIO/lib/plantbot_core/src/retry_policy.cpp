@@ -0,0 +1,190 @@
+/*
+ * PlantBot2 Retry Policy
+ * 
+ * See retry_policy.h.
+ */
+
+#include "retry_policy.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <esp_mac.h>
+#include <time.h>
+
+// Backoff and circuit breaker state (RTC arena)
+struct RetryState {
+    uint8_t consecutiveFailures;    // Failed wakes since the last success
+    uint8_t deferrals;              // Follow-up wakes used for the current reading
+    uint8_t breakerTrips;           // Times the breaker opened while failing
+    UplinkError lastError;
+    uint32_t breakerUntil;          // time(nullptr) when the radio may try again
+};
+
+static RetryState &retryState() {
+    return *rtcArenaRegion<RetryState>(RTC_REGION_RETRY);
+}
+
+// Per-device pseudo-random value for a backoff step (FNV-1a over MAC and step)
+static uint32_t jitterHash(uint32_t step) {
+    uint8_t mac[6] = {};
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ ((step >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+    return hash;
+}
+
+// base * 2^exponent capped at maxMs, plus up to half of that again as jitter
+static uint32_t backoffMs(uint32_t baseMs, uint32_t exponent, uint32_t maxMs, uint32_t step) {
+    uint64_t delayMs = (uint64_t)baseMs << min(exponent, (uint32_t)16);
+    if (delayMs > maxMs) {
+        delayMs = maxMs;
+    }
+    
+    uint32_t half = (uint32_t)delayMs / 2;
+    return (uint32_t)delayMs + jitterHash(step) % (half + 1);
+}
+
+static void recordFailedWake() {
+    RetryState &state = retryState();
+    if (state.consecutiveFailures < 255) {
+        state.consecutiveFailures++;
+    }
+    
+    if (state.consecutiveFailures >= CIRCUIT_BREAKER_THRESHOLD) {
+        uint32_t cooldownMs = backoffMs(CIRCUIT_BREAKER_COOLDOWN_MINUTES * 60000UL, state.breakerTrips,
+                                        CIRCUIT_BREAKER_MAX_COOLDOWN_MINUTES * 60000UL,
+                                        0x10000 + state.breakerTrips);
+        state.breakerUntil = (uint32_t)time(nullptr) + cooldownMs / 1000;
+        if (state.breakerTrips < 255) {
+            state.breakerTrips++;
+        }
+        Serial.printf("🔌 Circuit breaker open for %lu minutes after %d failed wakes\n",
+                      (unsigned long)(cooldownMs / 60000), state.consecutiveFailures);
+    }
+}
+
+bool retryRadioAllowed() {
+    const RetryState &state = retryState();
+    if (state.consecutiveFailures < CIRCUIT_BREAKER_THRESHOLD) {
+        return true;
+    }
+    
+    int32_t remaining = (int32_t)(state.breakerUntil - (uint32_t)time(nullptr));
+    if (remaining > 0) {
+        Serial.printf("🔌 Circuit breaker open, radio rests for %ld more minutes\n", (long)(remaining / 60));
+        return false;
+    }
+    
+    // Half-open: this wake's attempt decides whether the breaker closes
+    Serial.println("🔌 Circuit breaker half-open, trying the radio");
+    return true;
+}
+
+RetryDecision retryOnFailure(UplinkError error, int attempt, bool canDefer) {
+    RetryState &state = retryState();
+    state.lastError = error;
+    
+    RetryDecision decision = {RETRY_GIVE_UP, 0};
+    switch (error) {
+        case UPLINK_ERR_DNS:
+        case UPLINK_ERR_TCP:
+        case UPLINK_ERR_TLS:
+            // Usually transient on the local network - worth a quick retry
+            if (attempt < MAX_RETRIES) {
+                decision.action = RETRY_NOW;
+                decision.delayMs = backoffMs(RETRY_BASE_MS, attempt - 1, RETRY_INWAKE_MAX_MS, attempt);
+            }
+            break;
+        
+        case UPLINK_ERR_HTTP_5XX:
+            // Server overloaded or cold-starting - give it time, asleep if allowed
+            if (canDefer && RETRY_DEFER_BASE_MS > 0) {
+#if RETRY_MAX_DEFERRALS > 0
+                if (state.deferrals < RETRY_MAX_DEFERRALS) {
+                    decision.action = RETRY_DEFER;
+                    decision.delayMs = backoffMs(RETRY_DEFER_BASE_MS, state.deferrals, RETRY_DEFER_MAX_MS,
+                                                 0x100 + state.deferrals);
+                }
+#endif
+            } else if (attempt < MAX_RETRIES) {
+                decision.action = RETRY_NOW;
+                decision.delayMs = backoffMs(RETRY_BASE_MS * 4, attempt - 1, RETRY_INWAKE_MAX_MS, attempt);
+            }
+            break;
+        
+        case UPLINK_ERR_HTTP_4XX:
+            // The server reached a verdict on the payload itself
+            decision.action = RETRY_DROP;
+            break;
+        
+        case UPLINK_ERR_WIFI:
+        default:
+            break;
+    }
+    
+    if (decision.action == RETRY_DEFER) {
+        state.deferrals++;
+    } else if (decision.action != RETRY_NOW) {
+        state.deferrals = 0;
+    }
+    if (decision.action == RETRY_DEFER || decision.action == RETRY_GIVE_UP) {
+        recordFailedWake();
+    }
+    
+    Serial.printf("Retry policy: %s -> %s", uplinkErrorName(error),
+                  decision.action == RETRY_NOW ? "retry" :
+                  decision.action == RETRY_DEFER ? "defer" :
+                  decision.action == RETRY_DROP ? "drop" : "give up");
+    if (decision.action == RETRY_NOW || decision.action == RETRY_DEFER) {
+        Serial.printf(" in %lu ms", (unsigned long)decision.delayMs);
+    }
+    Serial.println();
+    
+    return decision;
+}
+
+void retryOnSuccess() {
+    RetryState &state = retryState();
+    state.consecutiveFailures = 0;
+    state.deferrals = 0;
+    state.breakerTrips = 0;
+    state.breakerUntil = 0;
+    state.lastError = UPLINK_OK;
+}
+
+uint8_t retryConsecutiveFailures() {
+    return retryState().consecutiveFailures;
+}
+
+uint8_t retryDeferrals() {
+    return retryState().deferrals;
+}
+
+UplinkError retryLastError() {
+    return retryState().lastError;
+}
+
+const char *uplinkErrorName(UplinkError error) {
+    switch (error) {
+        case UPLINK_ERR_WIFI:
+            return "wifi";
+        case UPLINK_ERR_DNS:
+            return "dns";
+        case UPLINK_ERR_TCP:
+            return "tcp";
+        case UPLINK_ERR_TLS:
+            return "tls";
+        case UPLINK_ERR_HTTP_5XX:
+            return "http_5xx";
+        case UPLINK_ERR_HTTP_4XX:
+            return "http_4xx";
+        case UPLINK_OK:
+        default:
+            return "ok";
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * PlantBot2 RTC Arena
+ * 
+ * See rtc_arena.h.
+ */
+
+#include "rtc_arena.h"
+#include <esp_rom_crc.h>
+
+#define RTC_ARENA_MAGIC     0x41435452  // "RTCA"
+
+struct __attribute__((packed)) RtcArenaHeader {
+    uint32_t magic;
+    uint16_t version;                   // RTC_ARENA_VERSION
+    uint8_t regionCount;                // RTC_REGION_COUNT
+    uint8_t reserved;
+    uint32_t crc;                       // CRC-32 over the header (this field as 0) and the used bytes
+    uint16_t used;                      // Bytes allocated in data
+    uint16_t offset[RTC_REGION_COUNT];
+    uint16_t size[RTC_REGION_COUNT];    // 0 = not allocated yet
+};
+
+struct RtcArena {
+    RtcArenaHeader header;
+    alignas(8) uint8_t data[RTC_ARENA_SIZE];
+};
+
+static_assert(RTC_ARENA_SIZE <= 65535, "RTC arena offsets are 16-bit");
+
+// Zeroed on power-on, so the magic doesn't match until the first seal
+RTC_DATA_ATTR static RtcArena arena;
+
+// This wake
+static bool arenaChecked = false;
+
+static uint32_t arenaCrc() {
+    RtcArenaHeader header = arena.header;
+    header.crc = 0;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&header, sizeof(header));
+    return esp_rom_crc32_le(crc, arena.data, min((size_t)header.used, (size_t)RTC_ARENA_SIZE));
+}
+
+void rtcArenaBegin() {
+    if (arenaChecked) {
+        return;
+    }
+    arenaChecked = true;
+    
+    const RtcArenaHeader &header = arena.header;
+    const char *problem = nullptr;
+    if (header.magic == 0) {
+        problem = "power-on";
+    } else if (header.magic != RTC_ARENA_MAGIC) {
+        problem = "no arena header";
+    } else if (header.version != RTC_ARENA_VERSION || header.regionCount != RTC_REGION_COUNT) {
+        problem = "layout version changed";
+    } else if (header.used > RTC_ARENA_SIZE || header.crc != arenaCrc()) {
+        problem = "CRC mismatch";
+    }
+    if (problem == nullptr) {
+        return;
+    }
+    
+    // Not sealed by the previous wake - nothing in it can be trusted
+    memset(&arena, 0, sizeof(arena));
+    arena.header.magic = RTC_ARENA_MAGIC;
+    arena.header.version = RTC_ARENA_VERSION;
+    arena.header.regionCount = RTC_REGION_COUNT;
+    Serial.printf("🧠 RTC state starts fresh (%s)\n", problem);
+}
+
+void rtcArenaSeal() {
+    arena.header.crc = arenaCrc();
+}
+
+void *rtcArenaAllocate(RtcRegion region, size_t size, size_t align, const void *initial) {
+    rtcArenaBegin();
+    
+    RtcArenaHeader &header = arena.header;
+    if (header.size[region] == size) {
+        return arena.data + header.offset[region];
+    }
+    
+    // Bump allocation; a region whose size changed between builds is
+    // allocated again and its old block stays unused until the next reset
+    size_t offset = (header.used + align - 1) / align * align;
+    if (offset + size > RTC_ARENA_SIZE) {
+        // Stale blocks of resized regions, or the build outgrew
+        // RTC_ARENA_SIZE: discard the arena so the reset starts fresh
+        Serial.printf("❌ RTC arena full: region %d needs %u bytes, %u of %u in use - resetting\n", region,
+                      (unsigned)size, (unsigned)header.used, (unsigned)RTC_ARENA_SIZE);
+        Serial.flush();
+        memset(&arena, 0, sizeof(arena));
+        abort();
+    }
+    header.offset[region] = offset;
+    header.size[region] = size;
+    header.used = offset + size;
+    
+    void *block = arena.data + offset;
+    
+    if (initial != nullptr) {
+        memcpy(block, initial, size);
+    } else {
+        memset(block, 0, size);
+    }
+    return block;
+}
@@ -0,0 +1,70 @@
+/*
+ * PlantBot2 Change-Driven Uplink
+ * 
+ * See uplink_deadband.h.
+ */
+
+#include "uplink_deadband.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <time.h>
+
+// Last transmitted values (RTC arena)
+struct TransmittedValues {
+    bool valid;
+    float temperature;
+    float humidity;
+    float moisturePercent;
+    float batteryVoltage;
+    uint32_t sentAt;    // time(nullptr) when recorded
+};
+
+static TransmittedValues &lastTransmitted() {
+    return *rtcArenaRegion<TransmittedValues>(RTC_REGION_DEADBAND);
+}
+
+bool deadbandHeartbeatDue() {
+    const TransmittedValues &last = lastTransmitted();
+    if (!last.valid) {
+        return true;
+    }
+    
+    return (uint32_t)time(nullptr) - last.sentAt >= HEARTBEAT_MAX_SILENCE_MINUTES * 60UL;
+}
+
+UplinkReason deadbandEvaluate(const SensorData &data) {
+    const TransmittedValues &last = lastTransmitted();
+    if (last.valid) {
+        bool moved = fabsf(data.temperature - last.temperature) >= DEADBAND_TEMPERATURE_C ||
+                     fabsf(data.humidity - last.humidity) >= DEADBAND_HUMIDITY_PERCENT ||
+                     fabsf(data.moisturePercent - last.moisturePercent) >= DEADBAND_MOISTURE_PERCENT ||
+                     fabsf(data.batteryVoltage - last.batteryVoltage) >= DEADBAND_BATTERY_V;
+        if (moved) {
+            return UPLINK_DELTA;
+        }
+    }
+    
+    return deadbandHeartbeatDue() ? UPLINK_HEARTBEAT : UPLINK_SCHEDULED;
+}
+
+void deadbandRecord(const SensorData &data) {
+    TransmittedValues &last = lastTransmitted();
+    last.temperature = data.temperature;
+    last.humidity = data.humidity;
+    last.moisturePercent = data.moisturePercent;
+    last.batteryVoltage = data.batteryVoltage;
+    last.sentAt = (uint32_t)time(nullptr);
+    last.valid = true;
+}
+
+const char *uplinkReasonName(UplinkReason reason) {
+    switch (reason) {
+        case UPLINK_DELTA:
+            return "delta";
+        case UPLINK_HEARTBEAT:
+            return "heartbeat";
+        case UPLINK_SCHEDULED:
+        default:
+            return "scheduled";
+    }
+}
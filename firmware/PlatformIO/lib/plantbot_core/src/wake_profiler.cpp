@@ -0,0 +1,107 @@
+/*
+ * PlantBot2 Wake-Cycle Profiler
+ * 
+ * See wake_profiler.h.
+ */
+
+#include "wake_profiler.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <esp_timer.h>
+
+static const char *const phaseFieldNames[PHASE_COUNT] = {
+    "t_boot_ms",
+    "t_setup_hardware_ms",
+    "t_init_radio_ms",
+    "t_read_sensors_ms",
+    "t_connect_wifi_ms",
+    "t_dns_ms",
+    "t_tls_ms",
+    "t_http_post_ms",
+    "t_gpio_sleep_ms",
+    "t_deep_sleep_ms",
+};
+
+// Ring buffer of completed cycles (RTC arena)
+struct ProfileHistory {
+    WakeProfile cycles[PROFILE_HISTORY_CYCLES];
+    uint8_t index;
+    uint8_t count;
+};
+
+static ProfileHistory &profileHistory() {
+    return *rtcArenaRegion<ProfileHistory>(RTC_REGION_PROFILER);
+}
+
+// Current wake
+static WakeProfile currentProfile;
+static int64_t phaseStartUs[PHASE_COUNT];
+static uint16_t phasesMeasured = 0;
+static portMUX_TYPE phasesLock = portMUX_INITIALIZER_UNLOCKED;  // The WiFi task ends phases too
+static int64_t setupStartUs = 0;
+
+void profilerBegin(uint32_t bootCount) {
+    setupStartUs = esp_timer_get_time();
+    
+    memset(&currentProfile, 0, sizeof(currentProfile));
+    currentProfile.bootCount = bootCount;
+    currentProfile.phaseUs[PHASE_BOOT] = (uint32_t)setupStartUs;
+    phasesMeasured = 1 << PHASE_BOOT;
+}
+
+void profilerStart(WakePhase phase) {
+    phaseStartUs[phase] = esp_timer_get_time();
+}
+
+void profilerEnd(WakePhase phase) {
+    uint32_t elapsedUs = (uint32_t)(esp_timer_get_time() - phaseStartUs[phase]);
+    
+    portENTER_CRITICAL(&phasesLock);
+    currentProfile.phaseUs[phase] += elapsedUs;
+    phasesMeasured |= 1 << phase;
+    portEXIT_CRITICAL(&phasesLock);
+}
+
+uint32_t profilerPhaseUs(WakePhase phase) {
+    if (phasesMeasured & (1 << phase)) {
+        return currentProfile.phaseUs[phase];
+    }
+    
+    const WakeProfile *previous = profilerHistory(0);
+    return previous ? previous->phaseUs[phase] : 0;
+}
+
+const char *profilerFieldName(WakePhase phase) {
+    return phaseFieldNames[phase];
+}
+
+const WakeProfile *profilerHistory(int age) {
+    const ProfileHistory &history = profileHistory();
+    if (age < 0 || age >= history.count) {
+        return nullptr;
+    }
+    
+    int index = (history.index - 1 - age + PROFILE_HISTORY_CYCLES) % PROFILE_HISTORY_CYCLES;
+    return &history.cycles[index];
+}
+
+void profilerCommit() {
+    currentProfile.awakeUs = (uint32_t)(esp_timer_get_time() - setupStartUs);
+    
+    ProfileHistory &history = profileHistory();
+    history.cycles[history.index] = currentProfile;
+    history.index = (history.index + 1) % PROFILE_HISTORY_CYCLES;
+    if (history.count < PROFILE_HISTORY_CYCLES) {
+        history.count++;
+    }
+}
+
+void profilerPrint() {
+    Serial.println("⏱️ Wake phase timing:");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (phasesMeasured & (1 << i)) {
+            Serial.printf("   %-22s %8.1f ms\n", phaseFieldNames[i], currentProfile.phaseUs[i] / 1000.0);
+        }
+    }
+    Serial.printf("   Awake so far: %.1f ms\n", (esp_timer_get_time() - setupStartUs) / 1000.0);
+}
@@ -14,17 +14,12 @@
 #include <Adafruit_AHTX0.h>
 #include <driver/gpio.h>
 #include "plantbot2_pins.h"
+#include "fixed_point.h"
 
 // Test configuration
 #define TEST_DELAY_MS     3000   // Delay between test phases
 #define BLINK_PERIOD_MS   500    // LED blink period
 #define PUMP_TEST_MS      100    // Short pump test duration for safety
-#define I2C_FREQ          100000 // 100kHz I2C frequency
-
-// Battery voltage calculation constants
-#define ADC_MAX_VALUE     4095.0
-#define ADC_REF_VOLTAGE   3.3
-#define VOLTAGE_DIVIDER   1.51   // R37(51k) + R38(100k) / R38(100k)
 
 // Test result tracking
 typedef struct {
@@ -142,7 +137,7 @@ void initializeI2C() {
     
     // Initialize I2C with custom pins
     Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
-    Wire.setClock(I2C_FREQ);
+    Wire.setClock(I2C_FREQUENCY);
     
     Serial.println("✓ I2C bus initialized");
     Serial.print("  - SDA: GPIO");
@@ -150,7 +145,7 @@ void initializeI2C() {
     Serial.print("  - SCL: GPIO");
     Serial.println(PIN_I2C_SCL);
     Serial.print("  - Frequency: ");
-    Serial.print(I2C_FREQ / 1000);
+    Serial.print(I2C_FREQUENCY / 1000);
     Serial.println(" kHz\n");
 }
 
@@ -560,11 +555,8 @@ float readBatteryVoltage() {
         delay(10);
     }
     
-    float adcAverage = adcSum / (float)numReadings;
-    // Calculate actual voltage using divider ratio
-    float voltage = (adcAverage / ADC_MAX_VALUE) * ADC_REF_VOLTAGE * VOLTAGE_DIVIDER;
-    
-    return voltage;
+    // Same linear calibration as the application firmware (see fixed_point.h)
+    return batteryMvFromAdc(adcSum, numReadings) / 1000.0f;
 }
 
 void blinkStatusLED(int count, int delayMs) {
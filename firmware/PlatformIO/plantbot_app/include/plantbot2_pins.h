@@ -1,58 +1,30 @@
 /*
  * PlantBot2 Pin Definitions
  * 
- * Hardware pin mapping for ESP32-C6-MINI-1-N4
+ * Firmware configuration; the board pin mapping is in plantbot2_board.h
  * Version: 1.0
  */
 
 #ifndef PLANTBOT2_PINS_H
 #define PLANTBOT2_PINS_H
 
-// GPIO Pin Assignments
-#define PIN_STATUS_LED     0   // GPIO0 - Status LED (boot strapping pin)
-#define PIN_BATTERY_READ   1   // GPIO1 - Battery voltage monitor (ADC1_CH1)
-#define PIN_LIGHT_SENSOR   2   // GPIO2 - Light sensor input (ADC1_CH2)
-#define PIN_I2C_POWER      3   // GPIO3 - I2C sensor power control
-#define PIN_MOISTURE_SENS  4   // GPIO4 - Soil moisture sensor (ADC1_CH4)
-#define PIN_PUMP_CONTROL   5   // GPIO5 - Pump control output
-// GPIO6 - BAT pin (not used in firmware)
-// GPIO7 - Reserved
-#define PIN_USER_GPIO      8   // GPIO8 - User expansion pin
-#define PIN_BOOT_BUTTON    9   // GPIO9 - Boot/User button
-// GPIO10-11 - Reserved
-// GPIO12 - USB D-
-// GPIO13 - USB D+
-#define PIN_I2C_SDA       14   // GPIO14 - I2C data line
-#define PIN_I2C_SCL       15   // GPIO15 - I2C clock line
+#include "plantbot2_board.h"   // Pin mapping and calibration (lib/plantbot_board)
 
-// I2C Configuration
-#define I2C_FREQUENCY     100000  // 100kHz standard mode
-#define I2C_ADDR_AHT20    0x38    // AHT20 temperature/humidity sensor
-
-// ADC Configuration
-#define ADC_RESOLUTION    12      // 12-bit ADC (0-4095)
-#define ADC_MAX_VALUE     4095.0  // Maximum ADC reading
-#define ADC_REF_VOLTAGE   3.3     // ADC reference voltage
-
-// Battery Monitoring - Linear calibration values (y = mx + c)
-// Calculated from measurements: 3.0V→3168, 3.2V→3182, 3.8V→3374, 4.2V→3444
-#define BATTERY_CALIB_SLOPE    0.003944  // m: voltage per ADC unit
-#define BATTERY_CALIB_INTERCEPT -9.436   // c: voltage offset
+// Battery Thresholds
 #define BATTERY_MIN_VOLTAGE    3.0   // Minimum safe battery voltage (UVLO threshold)
-#define BATTERY_MAX_VOLTAGE    4.2   // Maximum battery voltage
-#define USB_DETECT_VOLTAGE     4.5   // Voltage threshold for USB detection
 #define BATTERY_LOW_VOLTAGE    3.5   // Low battery warning threshold
 #define BATTERY_CRITICAL_VOLTAGE 3.2 // Critical battery - 24hr sleep
 #define BATTERY_UVLO_VOLTAGE   3.0   // Under voltage lockout - no WiFi
-#define CHARGING_DETECT_VOLTAGE 4.0  // Voltage threshold for charging detection
-#define BATTERY_TREND_SAMPLES  10    // Number of samples for trend analysis
-#define BATTERY_ADC_SAMPLES    20    // Number of ADC samples to average
 
 // Power Management
 #define SLEEP_DURATION_MINUTES 120  // Default sleep duration (2 hours)
 #define SLEEP_DURATION_US      (SLEEP_DURATION_MINUTES * 60 * 1000000ULL)
 #define WIFI_TIMEOUT_MS        30000 // 30 second WiFi connection timeout
-#define SENSOR_WARMUP_MS       2000  // 2 second sensor warmup time
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 2000 // Fast reconnect (cached BSSID/channel/IP) timeout
+#define WIFI_LEASE_CACHE_S     43200 // Reuse cached IP for half the DHCP lease, at most 12 hours
+#define SENSOR_WARMUP_MS       2000  // 2 second sensor warmup time (overlaps WiFi association)
+#define WIFI_TASK_STACK_SIZE   8192  // Stack for the WiFi connect task (WiFiManager portal included)
+#define WIFI_TASK_PRIORITY     1     // Same priority as the Arduino loop task
 #define CRITICAL_BATTERY_SLEEP_HOURS 24  // Sleep 24 hours if battery critical
 #define UVLO_SLEEP_HOURS       48    // Sleep 48 hours if under voltage lockout
 
@@ -64,13 +36,41 @@
 #define CHARGING_SLEEP_MINUTES  120    // Sleep time when charging detected (2 hours)
 #define CRITICAL_SLEEP_MINUTES  1440   // Critical battery sleep (24 hours)
 #define UVLO_SLEEP_MINUTES      2880   // UVLO sleep (48 hours)
-
-// Moisture Sensor Calibration
-#define MOISTURE_WET_VALUE    1300   // ADC value for 100% moisture (fully wet)
-#define MOISTURE_DRY_VALUE    1850   // ADC value for 0% moisture (fully dry)
+#define POWER_POLICY_STEADY     0      // Charging = sustained rise above CHARGING_DETECT_VOLTAGE
+#define POWER_POLICY_SOLAR      1      // Charging = recent rise, bright light or near-full voltage
+#define POWER_POLICY            POWER_POLICY_STEADY
 
 // Application Configuration
 #define SERIAL_BAUD_RATE      115200
-#define MAX_RETRIES           3      // Maximum upload retry attempts
+#define PROFILE_HISTORY_CYCLES 8     // Wake-cycle timing breakdowns kept in RTC memory
+#define RTC_ARENA_SIZE        2560   // Bytes of RTC memory for state kept across deep sleep (rtc_arena.h)
+
+// Store-and-forward Batching
+#define BATCH_SIZE            1      // Readings per upload (1 = upload every wake, e.g. 8 to batch)
+#define BATCH_BUFFER_SIZE     24     // Readings kept in RTC memory while uploads fail
+#define BATCH_MAX_AGE_MINUTES 720    // Upload once the oldest queued reading is this old
+#define BATCH_FLUSH_MOISTURE_PERCENT 20 // Upload early when soil dries out below this
+
+// Change-driven Uplink - skip readings within these deadbands of the last transmitted values
+#define DEADBAND_ENABLED          0     // 1 = only transmit on change or heartbeat
+#define DEADBAND_TEMPERATURE_C    0.5   // °C
+#define DEADBAND_HUMIDITY_PERCENT 3.0   // %RH
+#define DEADBAND_MOISTURE_PERCENT 5.0   // % moisture
+#define DEADBAND_BATTERY_V        0.05  // Volts
+#define HEARTBEAT_MAX_SILENCE_MINUTES 720 // Transmit at least this often (12 hours)
+#define NTP_SERVER            "pool.ntp.org" // Clock source for batched reading timestamps
+#define NTP_SYNC_TIMEOUT_MS   5000   // Maximum wait for the first NTP sync
+#define CLOCK_VALID_EPOCH     1700000000 // System time above this is a real (synced) epoch
+#define MAX_RETRIES           3      // Upload attempts per wake
+
+// Retry Policy - exponential backoff with per-device jitter, kept in RTC memory
+#define RETRY_BASE_MS          500   // First in-wake retry delay after a network error
+#define RETRY_INWAKE_MAX_MS    4000  // Longest backoff waited out awake
+#define RETRY_DEFER_BASE_MS    0     // First deferred retry after a 5xx (0 = retry awake)
+#define RETRY_DEFER_MAX_MS     900000 // Longest deferred retry sleep (15 minutes)
+#define RETRY_MAX_DEFERRALS    0     // Follow-up wakes per failed upload
+#define CIRCUIT_BREAKER_THRESHOLD 5   // Failed wakes in a row before the radio rests
+#define CIRCUIT_BREAKER_COOLDOWN_MINUTES 360  // First rest period, doubles while failing
+#define CIRCUIT_BREAKER_MAX_COOLDOWN_MINUTES 2880 // Longest rest period (48 hours)
 
 #endif // PLANTBOT2_PINS_H
\ No newline at end of file
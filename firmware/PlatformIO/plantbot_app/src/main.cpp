@@ -13,100 +13,189 @@
 #include <WiFi.h>
 #include <WiFiManager.h>
 #include <WiFiMulti.h>
-#include <Wire.h>
-#include <Adafruit_AHTX0.h>
 #include <esp_sleep.h>
 #include <esp_wifi.h>
-#include <esp_bt.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
 #include <esp_pm.h>
 #include <InfluxDbClient.h>
 #include <InfluxDbCloud.h>
+#include <HTTPClient.h>
 #include "plantbot2_pins.h"
+#include "sensor_data.h"
+#include "reading_batch.h"
+#include "uplink_deadband.h"
+#include "wake_profiler.h"
+#include "board.h"
+#include "adc_sampler.h"
+#include "power_policy.h"
+#include "retry_policy.h"
+#include "rtc_arena.h"
 #include "credentials.h"
 
 // WiFiMulti for InfluxDB client
 WiFiMulti wifiMulti;
 
-// RTC memory variables (survive deep sleep)
-RTC_DATA_ATTR int bootCount = 0;
-RTC_DATA_ATTR bool wifiConfigured = false;
-RTC_DATA_ATTR uint32_t failedUploads = 0;
-RTC_DATA_ATTR float batteryHistory[BATTERY_TREND_SAMPLES] = {0};
-RTC_DATA_ATTR int batteryHistoryIndex = 0;
-RTC_DATA_ATTR bool batteryHistoryFull = false;
-RTC_DATA_ATTR uint32_t lastSleepDuration = SLEEP_DURATION_MINUTES;
+// Fast-reconnect cache: last good AP and IP lease
+struct WiFiCache {
+    bool valid;
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    time_t leaseExpiry;   // System time keeps running through deep sleep
+};
+
+// State kept across deep sleep (RTC arena region, set up first thing in setup())
+struct WakeState {
+    int bootCount;
+    bool wifiConfigured;
+    uint32_t failedUploads;
+    uint32_t lastSleepDuration;
+    WiFiCache wifiCache;
+};
+static const WakeState initialWakeState = {0, false, 0, SLEEP_DURATION_MINUTES, {}};
+WakeState *rtcState = nullptr;
+
+// Connection statistics for this wake (reported with the reading)
+unsigned long wifiConnectMs = 0;
+bool wifiFastConnect = false;
+
+// Why this wake's reading is transmitted (reported with the reading)
+UplinkReason uplinkReason = UPLINK_SCHEDULED;
+
+// Retry policy outcome of the last failed upload in this wake
+RetryDecision uploadRetry = {RETRY_GIVE_UP, 0};
+
+// Wake pipeline: WiFi association runs in its own task while sensors warm up
+SemaphoreHandle_t wifiDoneSemaphore = nullptr;
+volatile bool wifiTaskResult = false;
 
 // Global objects
-Adafruit_AHTX0 aht;
 WiFiManager wifiManager;
 
-// InfluxDB client instance with preconfigured InfluxCloud certificate
-InfluxDBClient influxClient(INFLUX_URL, INFLUX_ORG, INFLUX_BUCKET, INFLUX_TOKEN, InfluxDbCloud2CACert);
+// Trust anchor for the InfluxDB connection. Define INFLUX_TRUST_ANCHOR in
+// credentials.h as the PEM of the single intermediate that issues the
+// InfluxDB Cloud certificate to avoid loading the full CA bundle every wake.
+#ifndef INFLUX_TRUST_ANCHOR
+#define INFLUX_TRUST_ANCHOR InfluxDbCloud2CACert
+#endif
 
-// Sensor data structure
-struct SensorData {
-    float temperature;
-    float humidity;
-    float batteryVoltage;
-    int lightLevel;
-    int moistureLevel;
-    float moisturePercent;
-    uint32_t timestamp;
-    bool lowBattery;
-};
+// InfluxDB client instance with the configured trust anchor
+InfluxDBClient influxClient(INFLUX_URL, INFLUX_ORG, INFLUX_BUCKET, INFLUX_TOKEN, INFLUX_TRUST_ANCHOR);
 
 // Function declarations
-void setupHardware();
-void configureGPIOForSleep();
-void initializeRadio();
-bool readSensors(SensorData &data);
 bool connectWiFi();
+void startWiFiTask();
+bool waitForWiFiTask();
+bool connectWiFiFast();
+uint32_t dhcpLeaseSeconds();
+void saveWiFiCache();
 bool uploadData(const SensorData &data, uint32_t sleepMinutes);
+Point buildSensorPoint(const SensorData &data);
+bool writeBatch(Point &latestPoint);
+bool syncClock(int32_t &stepS);
 void setupInfluxDB();
-void enterDeepSleep(uint64_t sleepTimeUs);
-float readBatteryVoltage();
-void blinkStatusLED(int count, int delayMs = 200);
-void printWakeupReason();
-void updateBatteryHistory(float voltage);
-bool isCharging();
-uint32_t calculateDynamicSleepTime(float batteryVoltage, int lightLevel);
-float calculateMoisturePercent(int moistureReading);
 
 void setup() {
     Serial.begin(SERIAL_BAUD_RATE);
-    delay(1000);
     
-    bootCount++;
+    // Give the USB serial monitor time to attach on first power-up only
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+        delay(1000);
+    }
+    
+    // State the previous wake left in RTC memory, cleared unless it was sealed
+    rtcArenaBegin();
+    rtcState = rtcArenaRegion<WakeState>(RTC_REGION_WAKE, &initialWakeState);
+    
+    rtcState->bootCount++;
+    profilerBegin(rtcState->bootCount);
     
     Serial.println("\n=== PlantBot2 Starting ===");
-    Serial.printf("Boot count: %d\n", bootCount);
-    printWakeupReason();
+    Serial.printf("Boot count: %d\n", rtcState->bootCount);
+    printWakeupReason(rtcState->lastSleepDuration);
     
-    // Setup hardware
+    // Setup hardware (sensor rail is powered, warmup runs in the background)
+    profilerStart(PHASE_SETUP_HARDWARE);
     setupHardware();
+    profilerEnd(PHASE_SETUP_HARDWARE);
     
     // Initialize radio stack (needed after deep deinit)
+    profilerStart(PHASE_INIT_RADIO);
     initializeRadio();
+    profilerEnd(PHASE_INIT_RADIO);
     
     // Setup InfluxDB
     setupInfluxDB();
     
+    // Battery first - it decides whether the radio may be powered at all
+    profilerStart(PHASE_READ_SENSORS);
+    int32_t batteryMv = readBatteryMv();
+    float batteryVoltage = batteryMv / 1000.0f;
+    
+    // Store-and-forward: the radio is only powered when the batch is due.
+    // With deadbands this wake's reading is only certain to be queued when
+    // a heartbeat is due; otherwise the decision waits for the sensors.
+    bool powerOnReset = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED);
+    int pendingReadings = (DEADBAND_ENABLED && !powerOnReset && !deadbandHeartbeatDue()) ? 0 : 1;
+    bool uploadDue = batchUploadDue(powerOnReset, pendingReadings);
+    
+    // Circuit breaker: after repeated failed wakes the radio rests for a while
+    // and readings just queue up
+    bool radioAllowed = retryRadioAllowed();
+    if (!radioAllowed) {
+        uploadDue = false;
+    }
+    
+    // Start WiFi association and DHCP while the sensors warm up and are sampled.
+    // Below the critical threshold the radio stays off to prevent brownout.
+    if (uploadDue && batteryVoltage > BATTERY_CRITICAL_VOLTAGE) {
+        startWiFiTask();
+    }
+    
+    // Trigger the AHT20 conversion now, the result is collected in readSensors()
+    aht.startMeasurement();
+    
     // Read sensors
     SensorData sensorData;
-    bool sensorsOK = readSensors(sensorData);
+    bool sensorsOK = readSensors(sensorData, batteryVoltage);
+    profilerEnd(PHASE_READ_SENSORS);
     
     if (!sensorsOK) {
         Serial.println("❌ Sensor reading failed, entering sleep");
+        waitForWiFiTask(); // Don't tear the radio down mid-association
         blinkStatusLED(3, 100); // Error indication
         enterDeepSleep(SLEEP_DURATION_US);
     }
     
     // Update battery history for trend analysis
-    updateBatteryHistory(sensorData.batteryVoltage);
+    updateBatteryHistory(batteryMv);
+    
+    // Change-driven uplink: a reading within the deadbands of the last
+    // transmitted values is dropped unless the radio is needed anyway
+    uplinkReason = deadbandEvaluate(sensorData);
+    bool thresholdEvent = batchThresholdEvent(sensorData);
+    bool significant = !DEADBAND_ENABLED || uplinkReason != UPLINK_SCHEDULED ||
+                       thresholdEvent || powerOnReset;
+    bool startRadio = radioAllowed && !uploadDue &&
+                      (thresholdEvent || batchUploadDue(powerOnReset, significant ? 1 : 0));
+    
+    // Queue the reading - it is kept across sleeps until an upload succeeds
+    if (significant || uploadDue || startRadio) {
+        deadbandRecord(sensorData);
+        batchAppend(sensorData, isCharging());
+        Serial.printf("📦 Reading queued (%s)\n", uplinkReasonName(uplinkReason));
+    } else {
+        Serial.println("📉 Reading within deadbands, not transmitted");
+    }
     
     // Calculate dynamic sleep time based on battery and light levels
-    uint32_t sleepMinutes = calculateDynamicSleepTime(sensorData.batteryVoltage, sensorData.lightLevel);
-    lastSleepDuration = sleepMinutes;
+    uint32_t sleepMinutes = calculateDynamicSleepTime(batteryMv, sensorData.lightLevel);
+    rtcState->lastSleepDuration = sleepMinutes;
     
     // Check for UVLO (Under Voltage Lock Out) - critical safety check
     if (sensorData.batteryVoltage <= BATTERY_UVLO_VOLTAGE) {
@@ -141,17 +230,31 @@ void setup() {
         enterDeepSleep(UVLO_SLEEP_HOURS * 60 * 60 * 1000000ULL);
     }
     
-    // Connect to WiFi and upload data
-    if (connectWiFi()) {
+    // This reading made the batch due (change, heartbeat or threshold event)
+    if (startRadio) {
+        uploadDue = true;
+        startWiFiTask();
+    }
+    
+    // Join the WiFi task and upload data
+    if (!uploadDue) {
+        Serial.printf("📦 %d/%d readings queued, radio stays off\n", batchCount(), BATCH_SIZE);
+    } else if (waitForWiFiTask()) {
         Serial.println("📡 WiFi connected");
         
         if (uploadData(sensorData, sleepMinutes)) {
             Serial.println("✅ Data uploaded successfully");
-            failedUploads = 0;
+            batchClear();
+            rtcState->failedUploads = 0;
             blinkStatusLED(2, 200); // Success indication
+        } else if (uploadRetry.action == RETRY_DROP) {
+            // Re-sending would be rejected again and block every later reading
+            Serial.println("🗑️ Readings rejected by the server, dropped");
+            batchClear();
+            blinkStatusLED(4, 100); // Upload failed indication
         } else {
             Serial.println("❌ Data upload failed");
-            failedUploads++;
+            rtcState->failedUploads++;
             blinkStatusLED(4, 100); // Upload failed indication
         }
         
@@ -160,14 +263,17 @@ void setup() {
         WiFi.mode(WIFI_OFF);
     } else {
         Serial.println("❌ WiFi connection failed");
-        failedUploads++;
+        rtcState->failedUploads++;
+        retryOnFailure(UPLINK_ERR_WIFI, 1);
         blinkStatusLED(6, 100); // WiFi failed indication
     }
     
-    Serial.printf("Failed uploads: %d\n", failedUploads);
+    Serial.printf("Failed uploads: %d\n", rtcState->failedUploads);
     Serial.printf("💤 Entering deep sleep for %d minutes\n", sleepMinutes);
     Serial.printf("🔋 Battery trend: %s\n", isCharging() ? "Charging" : "Discharging");
     
+    profilerPrint();
+    
     // Configure GPIOs for minimal power consumption
     configureGPIOForSleep();
     
@@ -180,50 +286,6 @@ void loop() {
     delay(1000);
 }
 
-void setupHardware() {
-    Serial.println("🔧 Initializing hardware...");
-    
-    // Configure output pins
-    pinMode(PIN_STATUS_LED, OUTPUT);
-    pinMode(PIN_PUMP_CONTROL, OUTPUT);
-    pinMode(PIN_I2C_POWER, OUTPUT);
-    
-    // Configure input pins
-    pinMode(PIN_BATTERY_READ, INPUT);
-    pinMode(PIN_LIGHT_SENSOR, INPUT);
-    pinMode(PIN_MOISTURE_SENS, INPUT);
-    pinMode(PIN_BOOT_BUTTON, INPUT_PULLUP);
-    pinMode(PIN_USER_GPIO, INPUT_PULLUP);
-    
-    // Set safe initial states
-    digitalWrite(PIN_STATUS_LED, LOW);
-    digitalWrite(PIN_PUMP_CONTROL, LOW);
-    digitalWrite(PIN_I2C_POWER, HIGH); // Power on sensors
-    
-    // Wait for sensor power stabilization
-    delay(SENSOR_WARMUP_MS);
-    
-    // Initialize I2C
-    Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
-    Wire.setClock(I2C_FREQUENCY);
-    
-    Serial.println("✅ Hardware initialized");
-}
-
-void initializeRadio() {
-    Serial.println("📡 Initializing radio stack...");
-    
-    // Initialize WiFi stack - ignore errors as it might already be initialized
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    esp_wifi_init(&cfg);
-    
-    // Initialize Bluetooth controller - ignore errors as it might already be initialized  
-    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-    esp_bt_controller_init(&bt_cfg);
-    
-    Serial.println("✅ Radio stack initialized");
-}
-
 void setupInfluxDB() {
     Serial.println("⚡ Setting up InfluxDB...");
     
@@ -232,122 +294,14 @@ void setupInfluxDB() {
     
     // Skip connection validation to avoid time-dependent crashes
     Serial.println("InfluxDB client ready (skipping validation for power efficiency)");
-}
-
-void configureGPIOForSleep() {
-    Serial.println("🔧 Configuring GPIOs for sleep...");
-    
-    // Explicitly deinitialize I2C first to ensure proper shutdown
-    Wire.end();
-    Serial.println("✅ I2C bus deinitialized");
-    
-    // Turn off all outputs to minimize current draw
-    digitalWrite(PIN_STATUS_LED, LOW);
-    digitalWrite(PIN_PUMP_CONTROL, LOW);
-    digitalWrite(PIN_I2C_POWER, LOW); // Power down sensors
-    
-    // Add delay to ensure sensors are properly powered down
-    delay(100);
-    Serial.println("✅ Sensors powered down");
-    
-    // Configure all GPIOs as inputs with pull-ups to prevent floating
-    gpio_config_t io_conf = {};
-    io_conf.intr_type = GPIO_INTR_DISABLE;
-    io_conf.mode = GPIO_MODE_INPUT;
-    io_conf.pin_bit_mask = (1ULL << PIN_STATUS_LED) |
-                          (1ULL << PIN_PUMP_CONTROL) |
-                          (1ULL << PIN_I2C_POWER) |
-                          (1ULL << PIN_USER_GPIO) |
-                          (1ULL << PIN_I2C_SDA) |
-                          (1ULL << PIN_I2C_SCL);
-    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    gpio_config(&io_conf);
-    
-    // Configure ADC pins as inputs with pull-ups (they're already inputs but ensure low power)
-    gpio_config_t adc_conf = {};
-    adc_conf.intr_type = GPIO_INTR_DISABLE;
-    adc_conf.mode = GPIO_MODE_INPUT;
-    adc_conf.pin_bit_mask = (1ULL << PIN_BATTERY_READ) |
-                           (1ULL << PIN_LIGHT_SENSOR) |
-                           (1ULL << PIN_MOISTURE_SENS);
-    adc_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    adc_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    gpio_config(&adc_conf);
-    
-    Serial.println("✅ GPIOs and peripherals configured for minimal power consumption");
-}
-
-bool readSensors(SensorData &data) {
-    Serial.println("📊 Reading sensors...");
-    
-    // Initialize sensor data
-    memset(&data, 0, sizeof(data));
-    data.timestamp = millis();
-    
-    // Read battery voltage with improved accuracy
-    data.batteryVoltage = readBatteryVoltage();
-    data.lowBattery = (data.batteryVoltage < BATTERY_LOW_VOLTAGE && data.batteryVoltage > BATTERY_UVLO_VOLTAGE);
-    
-    // Read light sensor
-    long lightSum = 0;
-    for (int i = 0; i < 5; i++) {
-        lightSum += analogRead(PIN_LIGHT_SENSOR);
-        delay(10);
-    }
-    data.lightLevel = lightSum / 5;
-    
-    // Read moisture sensor
-    long moistSum = 0;
-    for (int i = 0; i < 5; i++) {
-        moistSum += analogRead(PIN_MOISTURE_SENS);
-        delay(10);
-    }
-    data.moistureLevel = moistSum / 5;
-    data.moisturePercent = calculateMoisturePercent(data.moistureLevel);
-    
-    // Read AHT20 temperature and humidity with retries
-    bool ahtSuccess = false;
-    for (int retry = 0; retry < 3 && !ahtSuccess; retry++) {
-        if (retry > 0) {
-            Serial.printf("AHT20 retry %d/3\n", retry + 1);
-            // Power cycle the sensor on retries
-            digitalWrite(PIN_I2C_POWER, LOW);
-            delay(100);
-            digitalWrite(PIN_I2C_POWER, HIGH);
-            delay(500);
-        }
-        
-        if (aht.begin()) {
-            delay(200); // Extended stabilization time
-            
-            sensors_event_t humidity, temp;
-            if (aht.getEvent(&humidity, &temp)) {
-                data.temperature = temp.temperature;
-                data.humidity = humidity.relative_humidity;
-                
-                // Validate readings
-                if (data.temperature >= -20 && data.temperature <= 60 &&
-                    data.humidity >= 0 && data.humidity <= 100) {
-                    ahtSuccess = true;
-                } else {
-                    Serial.println("❌ AHT20 readings out of range");
-                }
-            } else {
-                Serial.println("❌ Failed to read AHT20");
-            }
-        } else {
-            Serial.println("❌ AHT20 initialization failed");
-        }
-    }
     
-    if (!ahtSuccess) {
-        Serial.println("❌ AHT20 failed after all retries");
-        return false;
-    }
-    
-    Serial.println("✅ All sensors read successfully");
-    return true;
+#if BATCH_SIZE > 1
+    // Queued readings are written in one request with second-precision timestamps
+    influxClient.setWriteOptions(WriteOptions()
+                                     .writePrecision(WritePrecision::S)
+                                     .batchSize(BATCH_BUFFER_SIZE + 1)
+                                     .bufferSize(BATCH_BUFFER_SIZE + 1));
+#endif
 }
 
 bool connectWiFi() {
@@ -356,11 +310,26 @@ bool connectWiFi() {
     // Disable WiFi sleep mode for faster connection
     WiFi.setSleep(false);
     
-    // Try to connect with stored credentials first
     WiFi.mode(WIFI_STA);
+    unsigned long startTime = millis();
+    wifiFastConnect = false;
+    
+    // Try the cached AP and IP lease first - skips the channel scan and DHCP
+    if (connectWiFiFast()) {
+        wifiConnectMs = millis() - startTime;
+        wifiFastConnect = true;
+        Serial.printf("⚡ Fast reconnect to %s in %lu ms\n", WiFi.SSID().c_str(), wifiConnectMs);
+        Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
+        
+        // Add to WiFiMulti for InfluxDB client
+        wifiMulti.addAP(WiFi.SSID().c_str(), WiFi.psk().c_str());
+        
+        return true;
+    }
+    
+    // Try to connect with stored credentials (full scan + DHCP)
     WiFi.begin();
     
-    unsigned long startTime = millis();
     while (WiFi.status() != WL_CONNECTED && 
            millis() - startTime < WIFI_TIMEOUT_MS) {
         delay(500);
@@ -368,10 +337,13 @@ bool connectWiFi() {
     }
     
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.printf("\n✅ Connected to %s\n", WiFi.SSID().c_str());
+        wifiConnectMs = millis() - startTime;
+        Serial.printf("\n✅ Connected to %s in %lu ms\n", WiFi.SSID().c_str(), wifiConnectMs);
         Serial.printf("IP: %s\n", WiFi.localIP().toString().c_str());
         Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
         
+        saveWiFiCache();
+        
         // Add to WiFiMulti for InfluxDB client
         wifiMulti.addAP(WiFi.SSID().c_str(), WiFi.psk().c_str());
         
@@ -381,7 +353,7 @@ bool connectWiFi() {
     Serial.println("\n❌ Stored credentials failed");
     
     // If this is the first boot or after many failures, start config portal
-    if (bootCount <= 3 || failedUploads > 10) {
+    if (rtcState->bootCount <= 3 || rtcState->failedUploads > 10) {
         Serial.println("🔧 Starting WiFi configuration portal...");
         
         // Start config portal with timeout
@@ -390,7 +362,9 @@ bool connectWiFi() {
         
         if (wifiManager.autoConnect("PlantBot2-Setup")) {
             Serial.println("✅ WiFi configured via portal");
-            wifiConfigured = true;
+            rtcState->wifiConfigured = true;
+            wifiConnectMs = millis() - startTime;
+            saveWiFiCache();
             
             // Add to WiFiMulti for InfluxDB client
             wifiMulti.addAP(WiFi.SSID().c_str(), WiFi.psk().c_str());
@@ -405,264 +379,293 @@ bool connectWiFi() {
     return false;
 }
 
-bool uploadData(const SensorData &data, uint32_t sleepMinutes) {
-    Serial.println("📤 Uploading data to InfluxDB...");
-    
-    // Calculate next heartbeat time
-    unsigned long nextHeartbeatEpoch = (millis() / 1000) + (sleepMinutes * 60);
-    
-    // Create data point
-    Point sensorPoint("plantbot_sensors");
-    
-    // Add tags (indexed fields)
-    String deviceId = WiFi.macAddress();
-    deviceId.replace(":", "_");
-    sensorPoint.addTag("device_id", deviceId);
-    sensorPoint.addTag("location", "garden");  // You can customize this
-    
-    // Add fields (measured values)
-    sensorPoint.addField("temperature", data.temperature);
-    sensorPoint.addField("humidity", data.humidity);
-    sensorPoint.addField("battery_voltage", data.batteryVoltage);
-    sensorPoint.addField("light_level", data.lightLevel);
-    sensorPoint.addField("moisture_level", data.moistureLevel);
-    sensorPoint.addField("moisture_percent", data.moisturePercent);
-    sensorPoint.addField("boot_count", bootCount);
-    sensorPoint.addField("rssi", WiFi.RSSI());
-    sensorPoint.addField("low_battery", data.lowBattery);
-    sensorPoint.addField("sleep_minutes", (int)sleepMinutes);
-    sensorPoint.addField("next_heartbeat", (int)nextHeartbeatEpoch);
-    sensorPoint.addField("charging", isCharging());
-    
-    // Always use server time - no client timestamp set
-    Serial.println("Using server timestamp for power efficiency");
-    
-    Serial.printf("Data point: %s\n", influxClient.pointToLineProtocol(sensorPoint).c_str());
-    
-    // Attempt upload with retries
-    for (int attempt = 1; attempt <= MAX_RETRIES; attempt++) {
-        Serial.printf("Upload attempt %d/%d\n", attempt, MAX_RETRIES);
-        
-        // Write data point to InfluxDB
-        if (influxClient.writePoint(sensorPoint)) {
-            Serial.println("✅ Data uploaded successfully");
-            return true;
-        } else {
-            Serial.print("❌ InfluxDB write failed: ");
-            Serial.println(influxClient.getLastErrorMessage());
-            
-            if (attempt < MAX_RETRIES) {
-                delay(2000); // Wait before retry
-            }
-        }
-    }
-    
-    return false;
+void wifiTask(void *) {
+    profilerStart(PHASE_CONNECT_WIFI);
+    wifiTaskResult = connectWiFi();
+    profilerEnd(PHASE_CONNECT_WIFI);
+    xSemaphoreGive(wifiDoneSemaphore);
+    vTaskDelete(nullptr);
 }
 
-void enterDeepSleep(uint64_t sleepTimeUs) {
-    uint32_t sleepMinutes = sleepTimeUs / 60000000ULL;
-    Serial.printf("💤 Entering deep sleep for %d minutes\n", sleepMinutes);
-    
-    // Complete WiFi shutdown for maximum power savings
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
-    if (esp_wifi_stop() == ESP_OK) {
-        Serial.println("✅ WiFi stopped");
-    }
-    if (esp_wifi_deinit() == ESP_OK) {
-        Serial.println("✅ WiFi deinitialized");
-    }
-    
-    // Complete Bluetooth shutdown
-    if (esp_bt_controller_disable() == ESP_OK) {
-        Serial.println("✅ Bluetooth disabled");
+void startWiFiTask() {
+    wifiDoneSemaphore = xSemaphoreCreateBinary();
+    wifiTaskResult = false;
+    
+    if (xTaskCreate(wifiTask, "wifi", WIFI_TASK_STACK_SIZE, nullptr,
+                    WIFI_TASK_PRIORITY, nullptr) != pdPASS) {
+        // Out of memory - fall back to the sequential path
+        Serial.println("❌ Failed to start WiFi task, connecting inline");
+        wifiTaskResult = connectWiFi();
+        xSemaphoreGive(wifiDoneSemaphore);
     }
-    if (esp_bt_controller_deinit() == ESP_OK) {
-        Serial.println("✅ Bluetooth deinitialized");
+}
+
+bool waitForWiFiTask() {
+    if (wifiDoneSemaphore == nullptr) {
+        return false; // Radio was never started this wake
     }
     
-    // Additional power management - disable unnecessary peripherals
-    esp_wifi_set_ps(WIFI_PS_NONE);
+    xSemaphoreTake(wifiDoneSemaphore, portMAX_DELAY);
+    vSemaphoreDelete(wifiDoneSemaphore);
+    wifiDoneSemaphore = nullptr;
     
-    // Configure wake up source (timer)
-    esp_sleep_enable_timer_wakeup(sleepTimeUs);
-    
-    // Note: GPIO9 is not an RTC GPIO on ESP32-C6, so external wakeup is not available
-    // Only timer wakeup is configured
-    
-    Serial.println("Going to sleep now...");
-    Serial.flush();
-    delay(100); // Ensure serial output completes
-    
-    // Enter deep sleep
-    esp_deep_sleep_start();
+    return wifiTaskResult;
 }
 
-float readBatteryVoltage() {
-    // Take multiple readings for accuracy with improved averaging
-    long adcSum = 0;
-    int validReadings = 0;
-    
-    // Take more samples and filter out obvious outliers
-    for (int i = 0; i < BATTERY_ADC_SAMPLES; i++) {
-        int reading = analogRead(PIN_BATTERY_READ);
-        // Basic outlier filtering - reject readings at extremes
-        if (reading > 50 && reading < 4000) {
-            adcSum += reading;
-            validReadings++;
-        }
-        delay(10); // Longer delay for more stable readings
+bool connectWiFiFast() {
+    WiFiCache &cache = rtcState->wifiCache;
+    if (!cache.valid) {
+        return false;
     }
     
-    if (validReadings == 0) {
-        Serial.println("❌ No valid battery readings!");
-        return 0.0;
+    // Don't reuse an address the DHCP server may have handed out again
+    if (time(nullptr) >= cache.leaseExpiry) {
+        Serial.println("IP lease cache expired, using DHCP");
+        cache.valid = false;
+        return false;
     }
     
-    float adcAverage = adcSum / (float)validReadings;
+    // Credentials stay in NVS, only the AP details are cached in RTC memory
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+        return false;
+    }
     
-    // Linear calibration: voltage = m * adc + c
-    float voltage = BATTERY_CALIB_SLOPE * adcAverage + BATTERY_CALIB_INTERCEPT;
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway),
+                IPAddress(cache.subnet), IPAddress(cache.dns));
+    WiFi.begin((const char *)conf.sta.ssid, (const char *)conf.sta.password,
+               cache.channel, cache.bssid, true);
     
-    Serial.printf("Battery ADC: %.1f (from %d samples), Voltage: %.2fV\n", 
-                  adcAverage, validReadings, voltage);
+    unsigned long startTime = millis();
+    while (WiFi.status() != WL_CONNECTED &&
+           millis() - startTime < WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        delay(10);
+    }
     
-    return voltage;
+    if (WiFi.status() == WL_CONNECTED) {
+        return true;
+    }
+    
+    // AP moved or lease no longer valid - drop cache and fall back to full scan
+    Serial.println("⚠️ Fast reconnect failed, falling back to full scan");
+    cache.valid = false;
+    WiFi.disconnect();
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Re-enable DHCP
+    return false;
 }
 
-void blinkStatusLED(int count, int delayMs) {
-    for (int i = 0; i < count; i++) {
-        digitalWrite(PIN_STATUS_LED, HIGH);
-        delay(delayMs);
-        digitalWrite(PIN_STATUS_LED, LOW);
-        delay(delayMs);
-    }
+// Lease the DHCP server granted at the last bind, 0 when unknown
+uint32_t dhcpLeaseSeconds() {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif *lwipNetif = netif != nullptr ? (struct netif *)esp_netif_get_netif_impl(netif) : nullptr;
+    struct dhcp *dhcp = lwipNetif != nullptr ? netif_dhcp_data(lwipNetif) : nullptr;
+    return dhcp != nullptr ? dhcp->offered_t0_lease : 0;
 }
 
-void printWakeupReason() {
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-    
-    switch(wakeup_reason) {
-        case ESP_SLEEP_WAKEUP_EXT1:
-            Serial.println("🔘 Wakeup: External signal (BOOT button)");
-            break;
-        case ESP_SLEEP_WAKEUP_TIMER:
-            Serial.printf("⏰ Wakeup: Timer (slept %d minutes)\n", lastSleepDuration);
-            break;
-        case ESP_SLEEP_WAKEUP_UNDEFINED:
-        default:
-            Serial.println("🔄 Wakeup: Power on reset");
-            break;
+void saveWiFiCache() {
+    WiFiCache &cache = rtcState->wifiCache;
+    
+    // The address is reused without renewing it, so only until DHCP would
+    // have renewed it (half the lease)
+    uint32_t leaseS = dhcpLeaseSeconds();
+    if (leaseS < 2) {
+        Serial.println("No DHCP lease known, WiFi cache not saved");
+        cache.valid = false;
+        return;
     }
+    
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+    cache.leaseExpiry = time(nullptr) + min(leaseS / 2, (uint32_t)WIFI_LEASE_CACHE_S);
+    cache.valid = true;
+    
+    Serial.printf("WiFi cache saved (channel %d, lease %lu s)\n", cache.channel, (unsigned long)leaseS);
 }
 
-void updateBatteryHistory(float voltage) {
-    // Read current ADC for debugging
-    float currentADC = analogRead(PIN_BATTERY_READ);
+bool uploadData(const SensorData &data, uint32_t sleepMinutes) {
+    Serial.println("📤 Uploading data to InfluxDB...");
     
-    batteryHistory[batteryHistoryIndex] = voltage;
-    batteryHistoryIndex = (batteryHistoryIndex + 1) % BATTERY_TREND_SAMPLES;
+    // Calculate next heartbeat time
+    unsigned long nextHeartbeatEpoch = (millis() / 1000) + (sleepMinutes * 60);
+    
+    // Create data point with tags and measured values
+    Point sensorPoint = buildSensorPoint(data);
     
-    if (batteryHistoryIndex == 0) {
-        batteryHistoryFull = true;
+    // Add wake metadata
+    sensorPoint.addField("boot_count", rtcState->bootCount);
+    sensorPoint.addField("rssi", WiFi.RSSI());
+    sensorPoint.addField("sleep_minutes", (int)sleepMinutes);
+    sensorPoint.addField("next_heartbeat", (int)nextHeartbeatEpoch);
+    sensorPoint.addField("charging", isCharging());
+    sensorPoint.addField("wifi_connect_ms", (int)wifiConnectMs);
+    sensorPoint.addField("wifi_fast_connect", wifiFastConnect);
+    sensorPoint.addField("uplink_reason", uplinkReasonName(uplinkReason));
+    sensorPoint.addField("failed_wakes", (int)retryConsecutiveFailures());
+    sensorPoint.addField("last_error", uplinkErrorName(retryLastError()));
+    
+    // Wake-cycle phase timing (sleep preparation is from the previous cycle)
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        sensorPoint.addField(profilerFieldName((WakePhase)i), profilerPhaseUs((WakePhase)i) / 1000.0f);
+    }
+    const WakeProfile *previousCycle = profilerHistory(0);
+    if (previousCycle) {
+        sensorPoint.addField("t_prev_awake_ms", previousCycle->awakeUs / 1000.0f);
     }
     
-    Serial.printf("ADC: %.0f, Battery history updated: %.2fV (index %d)\n", currentADC, voltage, batteryHistoryIndex);
-}
-
-bool isCharging() {
-    if (!batteryHistoryFull && batteryHistoryIndex < 2) {
-        return false; // Not enough data
+#if BATCH_SIZE > 1
+    // Queued readings need absolute timestamps. The clock is synced once and
+    // keeps running through deep sleep; queued readings are rebased to it.
+    int32_t clockStepS = 0;
+    if (!syncClock(clockStepS)) {
+        Serial.println("❌ Clock sync failed, keeping readings queued");
+        return false;
     }
+    batchShiftClock(clockStepS);
+    Serial.printf("Uploading %d queued readings with device timestamps\n", batchCount());
+#else
+    // Always use server time - no client timestamp set
+    Serial.println("Using server timestamp for power efficiency");
+#endif
     
-    int samples = batteryHistoryFull ? BATTERY_TREND_SAMPLES : batteryHistoryIndex;
-    float trend = 0;
+    Serial.printf("Data point: %s\n", influxClient.pointToLineProtocol(sensorPoint).c_str());
     
-    // Calculate average trend over available samples
-    for (int i = 1; i < samples; i++) {
-        int currentIdx = (batteryHistoryIndex - 1 - i + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        int prevIdx = (batteryHistoryIndex - 2 - i + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        trend += batteryHistory[currentIdx] - batteryHistory[prevIdx];
+    // Resolve the InfluxDB host up front so the lookup can be timed separately;
+    // the client's own lookup then hits the lwIP DNS cache. The TLS handshake
+    // happens inside writePoint() and is counted in the HTTP POST phase.
+    String influxHost = String(INFLUX_URL);
+    influxHost.replace("https://", "");
+    influxHost.replace("http://", "");
+    int hostEnd = influxHost.indexOf('/');
+    if (hostEnd >= 0) {
+        influxHost = influxHost.substring(0, hostEnd);
+    }
+    int portStart = influxHost.indexOf(':');
+    if (portStart >= 0) {
+        influxHost = influxHost.substring(0, portStart);
     }
     
-    trend /= (samples - 1);
+    profilerStart(PHASE_DNS);
+    IPAddress influxIP;
+    bool resolved = WiFi.hostByName(influxHost.c_str(), influxIP);
+    profilerEnd(PHASE_DNS);
+    if (!resolved) {
+        Serial.printf("❌ DNS lookup failed for %s\n", influxHost.c_str());
+        retryOnFailure(UPLINK_ERR_DNS, MAX_RETRIES);
+        return false;
+    }
     
-    // Check if battery is charging (positive trend and high voltage)
-    float currentVoltage = batteryHistory[(batteryHistoryIndex - 1 + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES];
-    bool charging = (trend > 0.02 && currentVoltage > CHARGING_DETECT_VOLTAGE);
+    // Attempt upload, retrying as the retry policy decides
+    for (int attempt = 1; ; attempt++) {
+        Serial.printf("Upload attempt %d\n", attempt);
+        
+        // Write data point to InfluxDB
+        profilerStart(PHASE_HTTP_POST);
+#if BATCH_SIZE > 1
+        bool written = writeBatch(sensorPoint);
+#else
+        bool written = influxClient.writePoint(sensorPoint);
+#endif
+        profilerEnd(PHASE_HTTP_POST);
+        
+        if (written) {
+            Serial.println("✅ Data uploaded successfully");
+            retryOnSuccess();
+            return true;
+        }
+        
+        Serial.print("❌ InfluxDB write failed: ");
+        Serial.println(influxClient.getLastErrorMessage());
+        
+        // The client reports HTTP status codes, or HTTPClient errors when no
+        // response arrived (connection refused covers TCP and TLS failures)
+        int statusCode = influxClient.getLastStatusCode();
+        UplinkError error;
+        if (statusCode >= 400 && statusCode < 500) {
+            error = UPLINK_ERR_HTTP_4XX;
+        } else if (statusCode == HTTPC_ERROR_CONNECTION_REFUSED) {
+            error = UPLINK_ERR_TCP;
+        } else {
+            error = UPLINK_ERR_HTTP_5XX;
+        }
+        
+        uploadRetry = retryOnFailure(error, attempt);
+        if (uploadRetry.action != RETRY_NOW) {
+            return false;
+        }
+        delay(uploadRetry.delayMs);
+    }
+}
+
+Point buildSensorPoint(const SensorData &data) {
+    Point point("plantbot_sensors");
     
-    Serial.printf("Battery trend: %.3fV/reading, Current: %.2fV, Charging: %s\n", 
-                  trend, currentVoltage, charging ? "Yes" : "No");
+    // Add tags (indexed fields)
+    String deviceId = WiFi.macAddress();
+    deviceId.replace(":", "_");
+    point.addTag("device_id", deviceId);
+    point.addTag("location", "garden");  // You can customize this
     
-    return charging;
+    // Add fields (measured values)
+    point.addField("temperature", data.temperature);
+    point.addField("humidity", data.humidity);
+    point.addField("battery_voltage", data.batteryVoltage);
+    point.addField("light_level", data.lightLevel);
+    point.addField("moisture_level", data.moistureLevel);
+    point.addField("moisture_percent", data.moisturePercent);
+    point.addField("low_battery", data.lowBattery);
+    
+    return point;
 }
 
-uint32_t calculateDynamicSleepTime(float batteryVoltage, int lightLevel) {
-    uint32_t sleepMinutes = NORMAL_SLEEP_MINUTES;
-    
-    // UVLO check - should not reach here but safety first
-    if (batteryVoltage <= BATTERY_UVLO_VOLTAGE) {
-        return UVLO_SLEEP_MINUTES;
-    }
-    
-    // Critical battery check
-    if (batteryVoltage <= BATTERY_CRITICAL_VOLTAGE) {
-        Serial.printf("🔋 Critical battery (%.2fV): 24hr sleep\n", batteryVoltage);
-        return CRITICAL_SLEEP_MINUTES;
-    }
-    
-    // Check if charging conditions are met
-    bool highLight = (lightLevel > CHARGING_LIGHT_THRESHOLD);
-    bool chargingDetected = isCharging();
-    
-    if (highLight && (batteryVoltage > CHARGING_DETECT_VOLTAGE || chargingDetected)) {
-        // Charging conditions: use minimum sleep time
-        sleepMinutes = MIN_SLEEP_MINUTES;
-        Serial.printf("🔋 Charging detected (%.2fV): minimum sleep\n", batteryVoltage);
-    } else if (batteryVoltage < BATTERY_LOW_VOLTAGE) {
-        // Linear scaling from 2hrs (4.2V) to 6hrs (3.5V)
-        // batteryVoltage ranges from 3.5V (low) to 4.2V (high)
-        float voltageRange = BATTERY_MAX_VOLTAGE - BATTERY_LOW_VOLTAGE; // 4.2 - 3.5 = 0.7V
-        float voltageRatio = (batteryVoltage - BATTERY_LOW_VOLTAGE) / voltageRange;
-        voltageRatio = max(0.0f, min(1.0f, voltageRatio)); // Clamp to 0-1
+bool writeBatch(Point &latestPoint) {
+    // Start from an empty buffer so a retry doesn't duplicate points
+    influxClient.resetBuffer();
+    time_t now = time(nullptr);
+    
+    // Older queued readings carry the measured values only,
+    // the latest one (this wake) also carries the wake metadata
+    int count = batchCount();
+    for (int i = 0; i < count - 1; i++) {
+        const BatchedReading &queued = batchAt(i);
+        SensorData reading;
+        batchToSensorData(queued, reading);
         
-        // Linear interpolation: 6hrs when ratio=0 (3.5V), 2hrs when ratio=1 (4.2V)
-        sleepMinutes = MAX_SLEEP_MINUTES - (MAX_SLEEP_MINUTES - MIN_SLEEP_MINUTES) * voltageRatio;
-        
-        Serial.printf("🔋 Low battery scaling: %.2fV → %.1f ratio → %d min\n", 
-                      batteryVoltage, voltageRatio, sleepMinutes);
-    } else {
-        // Normal/high battery level: use minimum sleep time (2 hours)
-        sleepMinutes = MIN_SLEEP_MINUTES;
-        Serial.printf("🔋 Normal battery (%.2fV): standard sleep\n", batteryVoltage);
+        Point point = buildSensorPoint(reading);
+        point.addField("charging", (queued.flags & BATCH_FLAG_CHARGING) != 0);
+        point.setTime(now - batchAgeS(queued));
+        influxClient.writePoint(point);
     }
     
-    // Ensure sleep time is within bounds
-    sleepMinutes = max((uint32_t)MIN_SLEEP_MINUTES, min((uint32_t)MAX_SLEEP_MINUTES, sleepMinutes));
-    
-    Serial.printf("Final sleep decision: Battery=%.2fV, Light=%d, Sleep=%d min (%.1f hrs)\n", 
-                  batteryVoltage, lightLevel, sleepMinutes, sleepMinutes/60.0);
+    latestPoint.setTime(now - batchAgeS(batchAt(count - 1)));
+    influxClient.writePoint(latestPoint);
     
-    return sleepMinutes;
+    return influxClient.flushBuffer();
 }
 
-float calculateMoisturePercent(int moistureReading) {
-    // Convert ADC reading to moisture percentage
-    // Lower ADC values = more moisture (inverted scale)
-    
-    if (moistureReading <= MOISTURE_WET_VALUE) {
-        return 100.0; // Saturated - 100% moisture
+bool syncClock(int32_t &stepS) {
+    stepS = 0;
+    if (time(nullptr) > CLOCK_VALID_EPOCH) {
+        return true; // Already set on an earlier wake
     }
     
-    if (moistureReading >= MOISTURE_DRY_VALUE) {
-        return 0.0; // Dry - 0% moisture
+    Serial.println("🕒 Syncing clock via NTP...");
+    time_t before = time(nullptr);
+    unsigned long startTime = millis();
+    configTime(0, 0, NTP_SERVER);
+    
+    while (time(nullptr) <= CLOCK_VALID_EPOCH && millis() - startTime < NTP_SYNC_TIMEOUT_MS) {
+        delay(50);
     }
     
-    // Linear interpolation between wet and dry values
-    float percent = 100.0 * (float)(MOISTURE_DRY_VALUE - moistureReading) / 
-                    (float)(MOISTURE_DRY_VALUE - MOISTURE_WET_VALUE);
+    if (time(nullptr) <= CLOCK_VALID_EPOCH) {
+        return false;
+    }
     
-    // Ensure result is between 0-100%
-    return max(0.0f, min(100.0f, percent));
-}
\ No newline at end of file
+    // Step excludes the time spent waiting for the sync
+    stepS = (int32_t)(time(nullptr) - before - (millis() - startTime) / 1000);
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+ * PlantBot2 Background Sampler
+ * 
+ * Short sampling wakes between full wakes. Moisture, light and battery
+ * are read from the ADC with the sensor rail powered just long enough to
+ * settle. WiFi, BLE, I2C and logging are all skipped. Samples accumulate
+ * in RTC memory (min/max/mean since the last upload and a daily light
+ * integral). A full wake is only started early when a sample crosses a
+ * threshold; otherwise it follows the normal upload schedule.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef BACKGROUND_SAMPLER_H
+#define BACKGROUND_SAMPLER_H
+
+#include <Arduino.h>
+
+// Accumulated samples since the last successful upload
+struct SamplerSummary {
+    uint16_t count;
+    float moistureMin;          // %
+    float moistureMax;
+    float moistureMean;
+    uint16_t lightMin;          // raw ADC
+    uint16_t lightMax;
+    uint16_t lightMean;
+    float batteryMin;           // Volts
+    float lightIntegral;        // Light (raw) x hours since the current day started
+    float lightDailyIntegral;   // Same for the previous full day, 0 until one has passed
+};
+
+// True when this timer wake is a background sample rather than a full wake.
+// Call once, early in setup().
+bool samplerBackgroundWake();
+
+// Add a sample. A full wake's reading sets the reference for the moisture
+// change threshold. Returns true when a background sample warrants an
+// early full wake.
+bool samplerAdd(float moisturePercent, int lightLevel, float batteryVoltage, bool fullWake);
+
+// Sleep after a full wake: remembers when the next full wake is due and
+// returns the sleep until the first background sample (or sleepTimeUs
+// unchanged when background sampling is off or wouldn't fit)
+uint64_t samplerSchedule(uint64_t sleepTimeUs);
+
+// Sleep after a background sample: the next sample or the full wake, whichever is first
+uint64_t samplerNextSleepUs();
+
+void samplerSummary(SamplerSummary &summary);
+
+// Start a new summary after a successful upload
+void samplerReset();
+
+#endif // BACKGROUND_SAMPLER_H
@@ -0,0 +1,135 @@
+/*
+ * PlantBot2 BLE Advertisement Codec
+ * 
+ * Layout of the manufacturer-specific data broadcast in BLE uplink mode.
+ * The newest queued readings are packed into one non-connectable
+ * advertisement so that any nearby scanner can collect them without a
+ * connection. Header-only and free of Arduino dependencies so scanner
+ * gateways and host tools can decode it.
+ * 
+ * Manufacturer data layout (version 1, little-endian):
+ *   offset  size  field
+ *   0       2     company identifier (BLE_ADVERT_COMPANY_ID)
+ *   2       1     version
+ *   3       1     flags (BLE_ADVERT_FLAG_*)
+ *   4       4     sequence number of the newest reading
+ *   8       1     reading count N
+ *   9       12*N  readings, newest first:
+ *                   age (minutes) u16, temperature (0.01 °C) i16,
+ *                   humidity (0.01 %RH) u16, moisture (0.01 %) u16,
+ *                   light (raw) u16, battery (mV) u16
+ *   9+12N   4     truncated HMAC-SHA256 of bytes 0..8+12N
+ *                 (only with BLE_ADVERT_FLAG_AUTH, see ble_advert_auth.h)
+ * 
+ * A single reading with a tag is 27 bytes including the AD header, which
+ * fits a legacy advertisement; more readings need extended advertising.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef BLE_ADVERT_H
+#define BLE_ADVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "telemetry_codec.h"
+
+#define BLE_ADVERT_VERSION        1
+#define BLE_ADVERT_COMPANY_ID     0xFFFF  // Bluetooth SIG ID reserved for testing
+#define BLE_ADVERT_AD_TYPE        0xFF    // Manufacturer specific data
+#define BLE_ADVERT_HEADER_SIZE    9
+#define BLE_ADVERT_READING_SIZE   12
+#define BLE_ADVERT_TAG_SIZE       4
+#define BLE_ADVERT_LEGACY_MAX     31      // Legacy advertising data limit
+#define BLE_ADVERT_DATA_SIZE(n, auth) \
+    ((size_t)BLE_ADVERT_HEADER_SIZE + (size_t)(n) * BLE_ADVERT_READING_SIZE + ((auth) ? BLE_ADVERT_TAG_SIZE : 0))
+
+#define BLE_ADVERT_FLAG_AUTH      0x01
+#define BLE_ADVERT_FLAG_CHARGING  0x02
+#define BLE_ADVERT_FLAG_LOW_BATTERY 0x04
+
+struct BleAdvertHeader {
+    uint8_t flags;
+    uint32_t sequence;
+    uint8_t readingCount;
+};
+
+struct BleAdvertReading {
+    uint16_t ageMinutes;
+    int16_t temperatureCenti;
+    uint16_t humidityCenti;
+    uint16_t moistureCenti;
+    uint16_t lightLevel;
+    uint16_t batteryMv;
+};
+
+// Encode a complete AD structure (length, type, manufacturer data) into out.
+// With BLE_ADVERT_FLAG_AUTH the tag is left zeroed for bleAdvertSign().
+// Returns the AD structure length or 0 if it doesn't fit.
+static inline size_t bleAdvertEncode(const BleAdvertHeader &header, const BleAdvertReading *readings,
+                                     uint8_t *out, size_t capacity) {
+    size_t dataLength = BLE_ADVERT_DATA_SIZE(header.readingCount, header.flags & BLE_ADVERT_FLAG_AUTH);
+    if (dataLength + 2 > capacity || dataLength + 1 > 255) {
+        return 0;
+    }
+    
+    uint8_t *p = out;
+    *p++ = dataLength + 1;
+    *p++ = BLE_ADVERT_AD_TYPE;
+    p = telemetryPut16(p, BLE_ADVERT_COMPANY_ID);
+    *p++ = BLE_ADVERT_VERSION;
+    *p++ = header.flags;
+    p = telemetryPut32(p, header.sequence);
+    *p++ = header.readingCount;
+    
+    for (int i = 0; i < header.readingCount; i++) {
+        const BleAdvertReading &r = readings[i];
+        p = telemetryPut16(p, r.ageMinutes);
+        p = telemetryPut16(p, (uint16_t)r.temperatureCenti);
+        p = telemetryPut16(p, r.humidityCenti);
+        p = telemetryPut16(p, r.moistureCenti);
+        p = telemetryPut16(p, r.lightLevel);
+        p = telemetryPut16(p, r.batteryMv);
+    }
+    
+    if (header.flags & BLE_ADVERT_FLAG_AUTH) {
+        memset(p, 0, BLE_ADVERT_TAG_SIZE);
+    }
+    
+    return dataLength + 2;
+}
+
+// Decode manufacturer data as reported by a scanner (starting at the
+// company identifier); up to maxReadings readings are stored. Returns false
+// on a foreign company ID, unknown version or truncated data. The tag is
+// not checked here.
+static inline bool bleAdvertDecode(const uint8_t *in, size_t length, BleAdvertHeader &header,
+                                   BleAdvertReading *readings, size_t maxReadings) {
+    if (length < BLE_ADVERT_HEADER_SIZE || telemetryGet16(in) != BLE_ADVERT_COMPANY_ID ||
+        in[2] != BLE_ADVERT_VERSION) {
+        return false;
+    }
+    
+    header.flags = in[3];
+    header.sequence = telemetryGet32(in + 4);
+    header.readingCount = in[8];
+    if (length < BLE_ADVERT_DATA_SIZE(header.readingCount, header.flags & BLE_ADVERT_FLAG_AUTH)) {
+        return false;
+    }
+    
+    const uint8_t *p = in + BLE_ADVERT_HEADER_SIZE;
+    for (size_t i = 0; i < header.readingCount && i < maxReadings; i++) {
+        BleAdvertReading &r = readings[i];
+        r.ageMinutes = telemetryGet16(p);
+        r.temperatureCenti = (int16_t)telemetryGet16(p + 2);
+        r.humidityCenti = telemetryGet16(p + 4);
+        r.moistureCenti = telemetryGet16(p + 6);
+        r.lightLevel = telemetryGet16(p + 8);
+        r.batteryMv = telemetryGet16(p + 10);
+        p += BLE_ADVERT_READING_SIZE;
+    }
+    
+    return true;
+}
+
+#endif // BLE_ADVERT_H
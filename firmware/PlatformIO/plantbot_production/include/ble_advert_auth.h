@@ -0,0 +1,65 @@
+/*
+ * PlantBot2 BLE Advertisement Authentication
+ * 
+ * Per-device tag over the advertisement (see ble_advert.h): HMAC-SHA256
+ * under the device key, truncated to BLE_ADVERT_TAG_SIZE bytes. The data
+ * is authenticated, not encrypted. A scanner holding the key rejects
+ * forged advertisements and, by tracking the sequence number, replayed
+ * ones. Uses mbedTLS, which host tools can link as well.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef BLE_ADVERT_AUTH_H
+#define BLE_ADVERT_AUTH_H
+
+#include "ble_advert.h"
+#include <mbedtls/md.h>
+
+#define BLE_ADVERT_KEY_SIZE 16
+
+static inline bool bleAdvertTag(const uint8_t key[BLE_ADVERT_KEY_SIZE], const uint8_t *data,
+                                size_t length, uint8_t tag[BLE_ADVERT_TAG_SIZE]) {
+    uint8_t digest[32];
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, BLE_ADVERT_KEY_SIZE,
+                        data, length, digest) != 0) {
+        return false;
+    }
+    
+    memcpy(tag, digest, BLE_ADVERT_TAG_SIZE);
+    return true;
+}
+
+// Fill in the tag of an AD structure produced by bleAdvertEncode()
+static inline bool bleAdvertSign(const uint8_t key[BLE_ADVERT_KEY_SIZE], uint8_t *ad, size_t length) {
+    if (length < BLE_ADVERT_DATA_SIZE(0, true) + 2) {
+        return false;
+    }
+    
+    uint8_t *data = ad + 2;
+    size_t signedLength = length - 2 - BLE_ADVERT_TAG_SIZE;
+    return bleAdvertTag(key, data, signedLength, data + signedLength);
+}
+
+// Check the tag of manufacturer data decoded with bleAdvertDecode()
+static inline bool bleAdvertVerify(const uint8_t key[BLE_ADVERT_KEY_SIZE], const uint8_t *in,
+                                   size_t length, const BleAdvertHeader &header) {
+    if (!(header.flags & BLE_ADVERT_FLAG_AUTH)) {
+        return false;
+    }
+    
+    size_t signedLength = BLE_ADVERT_DATA_SIZE(header.readingCount, true) - BLE_ADVERT_TAG_SIZE;
+    uint8_t tag[BLE_ADVERT_TAG_SIZE];
+    if (length < signedLength + BLE_ADVERT_TAG_SIZE || !bleAdvertTag(key, in, signedLength, tag)) {
+        return false;
+    }
+    
+    // Constant time comparison
+    uint8_t diff = 0;
+    for (int i = 0; i < BLE_ADVERT_TAG_SIZE; i++) {
+        diff |= tag[i] ^ in[signedLength + i];
+    }
+    return diff == 0;
+}
+
+#endif // BLE_ADVERT_AUTH_H
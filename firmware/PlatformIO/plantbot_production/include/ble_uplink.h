@@ -0,0 +1,25 @@
+/*
+ * PlantBot2 BLE Broadcast Uplink
+ * 
+ * Broadcasts the newest queued readings in non-connectable advertisements
+ * (see ble_advert.h) for a nearby scanner gateway to pick up. The burst is
+ * BLE_ADV_EVENTS advertising events long and nothing is acknowledged.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef BLE_UPLINK_H
+#define BLE_UPLINK_H
+
+#include <Arduino.h>
+
+// Bring up the BLE host on top of the controller started in initializeRadio()
+bool bleBegin();
+
+// Broadcast one AD structure for BLE_ADV_EVENTS events; returns when done
+bool bleBroadcast(const uint8_t *advert, size_t length);
+
+// Shut the BLE host down again
+void bleEnd();
+
+#endif // BLE_UPLINK_H
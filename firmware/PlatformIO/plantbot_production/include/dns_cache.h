@@ -0,0 +1,23 @@
+/*
+ * PlantBot2 DNS Cache
+ * 
+ * Resolver cache in RTC memory. Lookups go straight to the DHCP-provided
+ * DNS server so the record TTL is known; the address is then reused across
+ * wakes until the TTL runs out or a connection to it fails.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Resolve host (or parse an IP literal), using the cache while it is fresh
+bool dnsResolve(const char *host, IPAddress &ip);
+
+// Drop the cached address, e.g. after a failed connection
+void dnsInvalidate(const char *host);
+
+#endif // DNS_CACHE_H
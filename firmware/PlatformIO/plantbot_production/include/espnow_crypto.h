@@ -0,0 +1,58 @@
+/*
+ * PlantBot2 ESP-NOW Frame Encryption
+ * 
+ * AES-128-GCM sealing and opening of ESP-NOW frames (see espnow_frame.h)
+ * with mbedTLS, shared by the node and gateway builds.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESPNOW_CRYPTO_H
+#define ESPNOW_CRYPTO_H
+
+#include "espnow_frame.h"
+#include <mbedtls/gcm.h>
+
+// Build a complete frame in out (capacity >= length + ESPNOW_OVERHEAD).
+// The nonce must never repeat under the same key. Returns the frame length or 0.
+static inline size_t espnowSeal(const uint8_t key[ESPNOW_KEY_SIZE], const EspNowHeader &header,
+                                const uint8_t nonce[ESPNOW_NONCE_SIZE], const uint8_t *plain,
+                                size_t length, uint8_t *out, size_t capacity) {
+    if (length + ESPNOW_OVERHEAD > capacity) {
+        return 0;
+    }
+    
+    espnowWriteHeader(header, out);
+    uint8_t *nonceOut = out + ESPNOW_HEADER_SIZE;
+    uint8_t *ciphertext = nonceOut + ESPNOW_NONCE_SIZE;
+    memcpy(nonceOut, nonce, ESPNOW_NONCE_SIZE);
+    
+    mbedtls_gcm_context gcm;
+    mbedtls_gcm_init(&gcm);
+    int ret = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, ESPNOW_KEY_SIZE * 8);
+    if (ret == 0) {
+        ret = mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, length, nonce, ESPNOW_NONCE_SIZE,
+                                        out, ESPNOW_HEADER_SIZE, plain, ciphertext,
+                                        ESPNOW_TAG_SIZE, ciphertext + length);
+    }
+    mbedtls_gcm_free(&gcm);
+    
+    return ret == 0 ? length + ESPNOW_OVERHEAD : 0;
+}
+
+// Authenticate and decrypt a parsed frame into plain (ciphertextLength bytes)
+static inline bool espnowOpen(const uint8_t key[ESPNOW_KEY_SIZE], const EspNowParts &parts, uint8_t *plain) {
+    mbedtls_gcm_context gcm;
+    mbedtls_gcm_init(&gcm);
+    int ret = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, ESPNOW_KEY_SIZE * 8);
+    if (ret == 0) {
+        ret = mbedtls_gcm_auth_decrypt(&gcm, parts.ciphertextLength, parts.nonce, ESPNOW_NONCE_SIZE,
+                                       parts.header, ESPNOW_HEADER_SIZE, parts.tag, ESPNOW_TAG_SIZE,
+                                       parts.ciphertext, plain);
+    }
+    mbedtls_gcm_free(&gcm);
+    
+    return ret == 0;
+}
+
+#endif // ESPNOW_CRYPTO_H
@@ -0,0 +1,82 @@
+/*
+ * PlantBot2 ESP-NOW Frame
+ * 
+ * Envelope for sending a telemetry frame (see telemetry_codec.h) from a
+ * node to the gateway over ESP-NOW. The telemetry frame is encrypted with
+ * AES-128-GCM under the network key; the envelope header is authenticated
+ * but sent in the clear. Header-only and free of Arduino dependencies.
+ * 
+ * Frame layout (version 1, little-endian):
+ *   offset  size  field
+ *   0       2     magic "PN"
+ *   2       1     version
+ *   3       1     flags (reserved, 0)
+ *   4       4     session (node power-on count, never decreases)
+ *   8       4     sequence number of the first reading
+ *   12      12    nonce
+ *   24      n     encrypted telemetry frame
+ *   24+n    16    GCM tag
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESPNOW_FRAME_H
+#define ESPNOW_FRAME_H
+
+#include "telemetry_codec.h"
+
+#define ESPNOW_FRAME_VERSION   1
+#define ESPNOW_HEADER_SIZE     12
+#define ESPNOW_NONCE_SIZE      12
+#define ESPNOW_TAG_SIZE        16
+#define ESPNOW_KEY_SIZE        16
+#define ESPNOW_OVERHEAD        (ESPNOW_HEADER_SIZE + ESPNOW_NONCE_SIZE + ESPNOW_TAG_SIZE)
+#define ESPNOW_MAX_FRAME       250  // ESP-NOW v1 payload limit
+#define ESPNOW_MAX_READINGS    ((ESPNOW_MAX_FRAME - ESPNOW_OVERHEAD - TELEMETRY_HEADER_SIZE) / TELEMETRY_READING_SIZE)
+
+struct EspNowHeader {
+    uint8_t flags;
+    uint32_t session;
+    uint32_t firstSequence;
+};
+
+// Pointers into a received frame
+struct EspNowParts {
+    const uint8_t *header;      // ESPNOW_HEADER_SIZE bytes, the GCM additional data
+    const uint8_t *nonce;
+    const uint8_t *ciphertext;
+    size_t ciphertextLength;
+    const uint8_t *tag;
+};
+
+// Write the clear header; returns ESPNOW_HEADER_SIZE
+static inline size_t espnowWriteHeader(const EspNowHeader &header, uint8_t *out) {
+    uint8_t *p = out;
+    *p++ = 'P';
+    *p++ = 'N';
+    *p++ = ESPNOW_FRAME_VERSION;
+    *p++ = header.flags;
+    p = telemetryPut32(p, header.session);
+    telemetryPut32(p, header.firstSequence);
+    return ESPNOW_HEADER_SIZE;
+}
+
+// Split a received frame; false on a bad magic, unknown version or short frame
+static inline bool espnowParse(const uint8_t *in, size_t length, EspNowHeader &header, EspNowParts &parts) {
+    if (length < ESPNOW_OVERHEAD || in[0] != 'P' || in[1] != 'N' || in[2] != ESPNOW_FRAME_VERSION) {
+        return false;
+    }
+    
+    header.flags = in[3];
+    header.session = telemetryGet32(in + 4);
+    header.firstSequence = telemetryGet32(in + 8);
+    
+    parts.header = in;
+    parts.nonce = in + ESPNOW_HEADER_SIZE;
+    parts.ciphertext = parts.nonce + ESPNOW_NONCE_SIZE;
+    parts.ciphertextLength = length - ESPNOW_OVERHEAD;
+    parts.tag = parts.ciphertext + parts.ciphertextLength;
+    return true;
+}
+
+#endif // ESPNOW_FRAME_H
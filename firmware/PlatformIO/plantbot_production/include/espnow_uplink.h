@@ -0,0 +1,31 @@
+/*
+ * PlantBot2 ESP-NOW Uplink
+ * 
+ * Node side of the gateway uplink: telemetry frames are sealed with the
+ * network key (see espnow_crypto.h) and sent to ESPNOW_GATEWAY_MAC on
+ * ESPNOW_CHANNEL without joining an access point. A frame counts as
+ * delivered once the gateway's radio acknowledges it.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef ESPNOW_UPLINK_H
+#define ESPNOW_UPLINK_H
+
+#include <Arduino.h>
+
+// Start or resume the gateway session. Call from setup() before the
+// radio task starts: its RTC arena region is claimed here.
+void espnowPrepare();
+
+// Bring up the radio on the gateway channel and register the gateway peer
+bool espnowBegin();
+
+// Send one telemetry frame whose first reading has the given sequence
+// number, retrying up to ESPNOW_SEND_RETRIES times. True once acknowledged.
+bool espnowSend(const uint8_t *frame, size_t length, uint32_t firstSequence);
+
+// Tear down ESP-NOW (the caller switches WiFi off)
+void espnowEnd();
+
+#endif // ESPNOW_UPLINK_H
@@ -0,0 +1,90 @@
+/*
+ * PlantBot2 Flash Telemetry Log
+ * 
+ * Append-only record log in the "tlog" data partition (partitions.csv).
+ * Every queued reading is also written here, so readings that fall out of
+ * the RTC batch while the uplink is down, or are lost with RTC memory on a
+ * power-on reset, can still be delivered once it is back.
+ * 
+ * No filesystem: the partition is a ring of 4 KB sectors, each starting
+ * with a header slot that holds the sequence number of its first record,
+ * followed by 127 fixed-size 32-byte records. A record is a single write
+ * that never crosses a 256-byte flash page. When the head sector is full
+ * the next one is erased, so every sector is erased once per pass over the
+ * partition and the oldest readings are overwritten.
+ * 
+ * The position in the log is kept in RTC memory and only rebuilt from the
+ * sector headers after a power-on reset. The backlog upload cursor is
+ * persisted in NVS after every acknowledged backlog request.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <Arduino.h>
+#include "reading_batch.h"
+
+#define FLASH_LOG_RECORD_SIZE       32
+#define FLASH_LOG_SECTOR_SIZE       4096
+#define FLASH_LOG_SECTOR_RECORDS    (FLASH_LOG_SECTOR_SIZE / FLASH_LOG_RECORD_SIZE - 1)
+#define FLASH_LOG_SECTOR_MAGIC      0x474C4250  // "PBLG"
+
+// One reading as stored in flash (32 bytes, CRC-16/CCITT over the rest)
+struct __attribute__((packed)) FlashLogRecord {
+    uint32_t sequence;          // Position in the log, never reused
+    uint32_t takenAt;           // time(nullptr) in the power cycle it was taken in
+    uint16_t powerCycle;        // Power-on resets since the log was formatted
+    int16_t temperatureCenti;   // 0.01 °C
+    uint16_t humidityCenti;     // 0.01 %RH
+    uint16_t batteryMv;         // millivolts
+    uint16_t lightLevel;        // raw ADC
+    uint16_t moistureLevel;     // raw ADC
+    uint16_t moistureCenti;     // 0.01 %
+    uint8_t flags;              // BATCH_FLAG_*
+    uint8_t reserved[7];        // Left erased (0xFF)
+    uint16_t crc;
+};
+
+// Header slot at the start of every sector in use
+struct __attribute__((packed)) FlashLogSectorHeader {
+    uint32_t magic;             // FLASH_LOG_SECTOR_MAGIC
+    uint32_t firstSequence;     // Sequence number of the sector's first record
+    uint32_t check;             // ~firstSequence
+};
+
+// CRC-16/CCITT-FALSE over everything before the record's CRC field (also
+// used by the host tools that read partition images)
+uint16_t flashLogRecordCrc(const FlashLogRecord &record);
+
+// Find and mount the partition; without it every other call is a no-op
+bool flashLogBegin();
+
+// Write a queued reading to the head of the log
+void flashLogAppend(const BatchedReading &reading);
+
+// The count appended readings before the newest pending ones were
+// delivered from the RTC batch; the pending ones are still queued there.
+// Readings that were appended but dropped from the batch before it was
+// delivered become backlog.
+void flashLogBatchDelivered(int count, int pending = 0);
+
+// Logged readings not known to be delivered
+uint32_t flashLogBacklog();
+
+// Oldest backlog readings, in order and with consecutive sequence numbers.
+// Returns the number read (0 when the backlog is empty).
+int flashLogReadBacklog(FlashLogRecord *records, int maxRecords);
+
+// The first count readings returned by flashLogReadBacklog were delivered
+void flashLogBacklogDelivered(int count);
+
+// Power-on resets since the log was formatted, as recorded with new readings
+uint16_t flashLogPowerCycle();
+
+// Seconds since a record was taken, or UINT32_MAX when it is from an
+// earlier power cycle (the clock restarted since)
+uint32_t flashLogAgeS(const FlashLogRecord &record);
+
+#endif // FLASH_LOG_H
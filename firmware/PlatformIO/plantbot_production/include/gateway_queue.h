@@ -0,0 +1,135 @@
+/*
+ * PlantBot2 Gateway Queue
+ * 
+ * Duplicate suppression and forward batching for the ESP-NOW gateway.
+ * Nodes number their readings (see batchFirstSequence()), so a frame that
+ * is re-sent after a lost ACK only contributes readings the gateway hasn't
+ * seen. Accepted frames wait in a fixed-size queue until enough have
+ * arrived or the oldest has waited long enough, then go out together.
+ * Header-only and free of Arduino dependencies.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef GATEWAY_QUEUE_H
+#define GATEWAY_QUEUE_H
+
+#include "espnow_frame.h"
+#include "plantbot2_pins.h"
+
+// Per-node high-water mark
+struct GatewayNode {
+    uint8_t mac[6];
+    uint32_t session;
+    uint32_t nextSequence;      // First reading number not yet accepted
+    uint32_t lastSeenMs;
+};
+
+struct GatewayDedup {
+    GatewayNode nodes[GATEWAY_MAX_NODES];
+    int count;
+};
+
+// One accepted frame waiting to be forwarded
+struct GatewayForward {
+    uint8_t mac[6];
+    int8_t rssi;
+    uint32_t receivedMs;
+    TelemetryHeader header;
+    TelemetryReading readings[ESPNOW_MAX_READINGS];
+    uint8_t readingCount;
+};
+
+struct GatewayQueue {
+    GatewayForward items[GATEWAY_QUEUE_SIZE];
+    int head;                   // Index of the oldest item
+    int count;
+    uint32_t dropped;           // Items overwritten while the uplink was down
+};
+
+// Record a frame of readingCount readings starting at firstSequence and
+// return how many leading readings were already accepted (readingCount
+// means the whole frame is a duplicate). A later session (node power-cycled)
+// restarts the numbering; a frame from an earlier session is a replay and
+// returns -1. The least recently seen node is evicted when full.
+static inline int gatewayAccept(GatewayDedup &dedup, const uint8_t mac[6], uint32_t session,
+                                uint32_t firstSequence, int readingCount, uint32_t nowMs) {
+    GatewayNode *node = nullptr;
+    for (int i = 0; i < dedup.count; i++) {
+        if (memcmp(dedup.nodes[i].mac, mac, 6) == 0) {
+            node = &dedup.nodes[i];
+            break;
+        }
+    }
+    
+    if (node == nullptr) {
+        if (dedup.count < GATEWAY_MAX_NODES) {
+            node = &dedup.nodes[dedup.count++];
+        } else {
+            node = &dedup.nodes[0];
+            for (int i = 1; i < dedup.count; i++) {
+                if ((int32_t)(dedup.nodes[i].lastSeenMs - node->lastSeenMs) < 0) {
+                    node = &dedup.nodes[i];
+                }
+            }
+        }
+        memcpy(node->mac, mac, 6);
+        node->session = session;
+        node->nextSequence = firstSequence;
+    } else if (session < node->session) {
+        return -1;
+    } else if (session > node->session) {
+        node->session = session;
+        node->nextSequence = firstSequence;
+    }
+    node->lastSeenMs = nowMs;
+    
+    int skip = 0;
+    if ((int32_t)(node->nextSequence - firstSequence) > 0) {
+        uint32_t seen = node->nextSequence - firstSequence;
+        skip = seen < (uint32_t)readingCount ? (int)seen : readingCount;
+    }
+    
+    uint32_t end = firstSequence + readingCount;
+    if ((int32_t)(end - node->nextSequence) > 0) {
+        node->nextSequence = end;
+    }
+    return skip;
+}
+
+// Slot for a new item at the back; the oldest item is dropped when full
+static inline GatewayForward &gatewayQueuePush(GatewayQueue &queue) {
+    if (queue.count == GATEWAY_QUEUE_SIZE) {
+        queue.head = (queue.head + 1) % GATEWAY_QUEUE_SIZE;
+        queue.count--;
+        queue.dropped++;
+    }
+    
+    GatewayForward &item = queue.items[(queue.head + queue.count) % GATEWAY_QUEUE_SIZE];
+    queue.count++;
+    return item;
+}
+
+static inline GatewayForward &gatewayQueueFront(GatewayQueue &queue) {
+    return queue.items[queue.head];
+}
+
+static inline void gatewayQueuePop(GatewayQueue &queue) {
+    if (queue.count > 0) {
+        queue.head = (queue.head + 1) % GATEWAY_QUEUE_SIZE;
+        queue.count--;
+    }
+}
+
+// True when the queue should be forwarded: batchSize items are waiting or
+// the oldest has waited maxDelayMs
+static inline bool gatewayFlushDue(const GatewayQueue &queue, uint32_t nowMs,
+                                   int batchSize, uint32_t maxDelayMs) {
+    if (queue.count == 0) {
+        return false;
+    }
+    
+    return queue.count >= batchSize || nowMs - queue.items[queue.head].receivedMs >= maxDelayMs;
+}
+
+#endif // GATEWAY_QUEUE_H
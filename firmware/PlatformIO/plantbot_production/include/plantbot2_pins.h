@@ -1,60 +1,33 @@
 /*
  * PlantBot2 Pin Definitions
  * 
- * Hardware pin mapping for ESP32-C6-MINI-1-N4
+ * Firmware configuration; the board pin mapping is in plantbot2_board.h
  * Version: 1.0
  */
 
 #ifndef PLANTBOT2_PINS_H
 #define PLANTBOT2_PINS_H
 
-// GPIO Pin Assignments
-#define PIN_STATUS_LED     0   // GPIO0 - Status LED (boot strapping pin)
-#define PIN_BATTERY_READ   1   // GPIO1 - Battery voltage monitor (ADC1_CH1)
-#define PIN_LIGHT_SENSOR   2   // GPIO2 - Light sensor input (ADC1_CH2)
-#define PIN_I2C_POWER      3   // GPIO3 - I2C sensor power control
-#define PIN_MOISTURE_SENS  4   // GPIO4 - Soil moisture sensor (ADC1_CH4)
-#define PIN_PUMP_CONTROL   5   // GPIO5 - Pump control output
-// GPIO6 - BAT pin (not used in firmware)
-// GPIO7 - Reserved
-#define PIN_USER_GPIO      8   // GPIO8 - User expansion pin
-#define PIN_BOOT_BUTTON    9   // GPIO9 - Boot/User button
-// GPIO10-11 - Reserved
-// GPIO12 - USB D-
-// GPIO13 - USB D+
-#define PIN_I2C_SDA       14   // GPIO14 - I2C data line
-#define PIN_I2C_SCL       15   // GPIO15 - I2C clock line
-
-// I2C Configuration
-#define I2C_FREQUENCY     100000  // 100kHz standard mode
-#define I2C_ADDR_AHT20    0x38    // AHT20 temperature/humidity sensor
-
-// ADC Configuration
-#define ADC_RESOLUTION    12      // 12-bit ADC (0-4095)
-#define ADC_MAX_VALUE     4095.0  // Maximum ADC reading
-#define ADC_REF_VOLTAGE   3.3     // ADC reference voltage
-
-// Battery Monitoring - Linear calibration values (y = mx + c)
-// Calculated from measurements: 3.0V→3168, 3.2V→3182, 3.8V→3374, 4.2V→3444
-#define BATTERY_CALIB_SLOPE    0.003944  // m: voltage per ADC unit
-#define BATTERY_CALIB_INTERCEPT -9.436   // c: voltage offset
+#include "plantbot2_board.h"   // Pin mapping and calibration (lib/plantbot_board)
+
+// Battery Thresholds
 #define BATTERY_MIN_VOLTAGE    3.0   // Minimum safe battery voltage (UVLO threshold)
-#define BATTERY_MAX_VOLTAGE    4.2   // Maximum battery voltage
-#define USB_DETECT_VOLTAGE     4.5   // Voltage threshold for USB detection
 #define BATTERY_LOW_VOLTAGE    3.7   // Low battery warning threshold - start scaling
 #define BATTERY_CRITICAL_VOLTAGE 3.7 // Critical battery - deep sleep below this
 #define BATTERY_UVLO_VOLTAGE   3.6   // Under voltage lockout - absolute minimum
-#define CHARGING_DETECT_VOLTAGE 4.0  // Voltage threshold for charging detection
-#define BATTERY_TREND_SAMPLES  10    // Number of samples for trend analysis
-#define BATTERY_ADC_SAMPLES    20    // Number of ADC samples to average
 
 // Power Management
 #define SLEEP_DURATION_MINUTES 120  // Default sleep duration (2 hours)
 #define SLEEP_DURATION_US      (SLEEP_DURATION_MINUTES * 60 * 1000000ULL)
 #define WIFI_TIMEOUT_MS        30000 // 30 second WiFi connection timeout
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 2000 // Fast reconnect (cached BSSID/channel/IP) timeout
+#define WIFI_LEASE_CACHE_S     43200 // Reuse cached IP for half the DHCP lease, at most 12 hours
 #define HTTP_TIMEOUT_MS        30000 // 30 second HTTP timeout (normal)
-#define CLOUD_WAKEUP_DELAY_MS  90000 // 90 second delay for cloud service wake-up
-#define SENSOR_WARMUP_MS       2000  // 2 second sensor warmup time
+#define CLOUD_WAKEUP_DELAY_MS  90000 // Deep sleep before retrying a failed upload (cloud cold start)
+#define WAKEUP_PING_PATH       "/"   // Requested to wake a cold-starting cloud service
+#define SENSOR_WARMUP_MS       2000  // 2 second sensor warmup time (overlaps WiFi association)
+#define WIFI_TASK_STACK_SIZE   8192  // Stack for the WiFi connect task (WiFiManager portal included)
+#define WIFI_TASK_PRIORITY     1     // Same priority as the Arduino loop task
 #define CRITICAL_BATTERY_SLEEP_HOURS 24  // Sleep 24 hours if battery critical
 #define UVLO_SLEEP_HOURS       48    // Sleep 48 hours if under voltage lockout
 
@@ -66,13 +39,90 @@
 #define CHARGING_SLEEP_MINUTES  120    // Sleep time when charging detected (2 hours)
 #define CRITICAL_SLEEP_MINUTES  1440   // Critical battery sleep (24 hours)
 #define UVLO_SLEEP_MINUTES      2880   // UVLO sleep (48 hours)
-
-// Moisture Sensor Calibration
-#define MOISTURE_WET_VALUE    1300   // ADC value for 100% moisture (fully wet)
-#define MOISTURE_DRY_VALUE    1850   // ADC value for 0% moisture (fully dry)
+#define POWER_POLICY_STEADY     0      // Charging = sustained rise above CHARGING_DETECT_VOLTAGE
+#define POWER_POLICY_SOLAR      1      // Charging = recent rise, bright light or near-full voltage
+#define POWER_POLICY            POWER_POLICY_SOLAR
 
 // Application Configuration
 #define SERIAL_BAUD_RATE      115200
-#define MAX_RETRIES           2      // Maximum upload retry attempts
+#define PROFILE_HISTORY_CYCLES 8     // Wake-cycle timing breakdowns kept in RTC memory
+#define RTC_ARENA_SIZE        2560   // Bytes of RTC memory for state kept across deep sleep (rtc_arena.h, ~1.8 KB used)
+
+// Store-and-forward Batching
+#define BATCH_SIZE            1      // Readings per upload (1 = upload every wake, e.g. 8 to batch)
+#define BATCH_BUFFER_SIZE     24     // Readings kept in RTC memory while uploads fail
+#define BATCH_MAX_AGE_MINUTES 720    // Upload once the oldest queued reading is this old
+#define BATCH_FLUSH_MOISTURE_PERCENT 20 // Upload early when soil dries out below this
+
+// Flash Telemetry Log - every queued reading is also kept in the "tlog" partition
+#define FLASH_LOG_ENABLED      1     // 1 = log readings to flash and upload the backlog when back online
+#define FLASH_LOG_UPLOAD_BATCH 48    // Backlog readings per request
+#define FLASH_LOG_MAX_UPLOADS  8     // Backlog requests per wake (WiFi uplink only)
+
+// Background Sampling - short ADC-only wakes between full wakes
+#define SAMPLE_INTERVAL_MINUTES 0    // Moisture/light/battery sample interval (0 = off, e.g. 5)
+#define SAMPLE_WARMUP_MS       200   // Sensor rail settling time for a background sample
+#define SAMPLE_WAKE_MOISTURE_DELTA 10.0 // Full wake when moisture moves this far (% points)
+#define SAMPLE_FULL_WAKE_SLACK_S 30  // Scheduled full wake this close - just do it
+
+// Change-driven Uplink - skip readings within these deadbands of the last transmitted values
+#define DEADBAND_ENABLED          0     // 1 = only transmit on change or heartbeat
+#define DEADBAND_TEMPERATURE_C    0.5   // °C
+#define DEADBAND_HUMIDITY_PERCENT 3.0   // %RH
+#define DEADBAND_MOISTURE_PERCENT 5.0   // % moisture
+#define DEADBAND_BATTERY_V        0.05  // Volts
+#define HEARTBEAT_MAX_SILENCE_MINUTES 720 // Transmit at least this often (12 hours)
+#define MAX_RETRIES           2      // Upload attempts per wake
+
+// Retry Policy - exponential backoff with per-device jitter, kept in RTC memory
+#define RETRY_BASE_MS          500   // First in-wake retry delay after a network error
+#define RETRY_INWAKE_MAX_MS    4000  // Longest backoff waited out awake
+#define RETRY_DEFER_BASE_MS    CLOUD_WAKEUP_DELAY_MS // First deferred retry after a 5xx, HTTPS only (0 = retry awake)
+#define RETRY_DEFER_MAX_MS     900000 // Longest deferred retry sleep (15 minutes)
+#define RETRY_MAX_DEFERRALS    (MAX_RETRIES - 1) // Follow-up wakes per failed upload
+#define CIRCUIT_BREAKER_THRESHOLD 5   // Failed wakes in a row before the radio rests
+#define CIRCUIT_BREAKER_COOLDOWN_MINUTES 360  // First rest period, doubles while failing
+#define CIRCUIT_BREAKER_MAX_COOLDOWN_MINUTES 2880 // Longest rest period (48 hours)
+
+// HTTPS Uplink - TLS session resumption across deep sleep
+#define TLS_SESSION_RESUMPTION 1     // 1 = cache the TLS session for abbreviated handshakes
+#define TLS_SESSION_RTC_SIZE   512   // Sessions up to this size are kept in RTC memory, larger go to NVS
+#define TLS_SESSION_MAX_SIZE   2048  // Largest serialized session (peer certificate included)
+#define TLS_RESPONSE_MAX_SIZE  256   // Response body bytes kept for diagnostics
+
+// DNS Cache - resolved server address reused across wakes within its TTL
+#define DNS_CACHE_ENABLED      1     // 1 = keep resolved addresses in RTC memory
+#define DNS_CACHE_ENTRIES      2     // Hosts cached
+#define DNS_CACHE_MAX_TTL_S    86400 // Upper bound on the record TTL
+#define DNS_CACHE_FALLBACK_TTL_S 60  // TTL when the lookup had to fall back to lwIP
+#define DNS_QUERY_TIMEOUT_MS   2000  // Wait for the DNS server's answer
+
+// Uplink Payload Format
+#define PAYLOAD_FORMAT_JSON    0     // ArduinoJson text payload
+#define PAYLOAD_FORMAT_BINARY  1     // Compact fixed-layout frame (see telemetry_codec.h)
+#ifndef PAYLOAD_FORMAT
+#define PAYLOAD_FORMAT         PAYLOAD_FORMAT_JSON
+#endif
+
+// Uplink Transport
+#define UPLINK_MODE_WIFI       0     // Join the access point and POST to the server
+#define UPLINK_MODE_ESPNOW     1     // Send sealed frames to a mains-powered gateway (see gateway/)
+#define UPLINK_MODE_BLE        2     // Broadcast readings in BLE advertisements (see ble_advert.h)
+#define UPLINK_MODE            UPLINK_MODE_WIFI
+
+// ESP-NOW Gateway - gateway MAC and network key are set in credentials.h
+#define ESPNOW_CHANNEL         1     // Must match the gateway's access point channel
+#define ESPNOW_ACK_TIMEOUT_MS  100   // Wait for the link-layer acknowledgement
+#define ESPNOW_SEND_RETRIES    3     // Re-sends of an unacknowledged frame
+#define GATEWAY_MAX_NODES      32    // Nodes tracked for duplicate suppression
+#define GATEWAY_QUEUE_SIZE     64    // Frames held while the gateway uplink is down
+#define GATEWAY_BATCH_SIZE     8     // Forward once this many frames are waiting
+#define GATEWAY_BATCH_MAX_DELAY_MS 30000 // ...or the oldest has waited this long
+#define GATEWAY_RETRY_MS       60000 // Wait after a failed forward
+
+// BLE Broadcast - optional per-device key (BLE_DEVICE_KEY) is set in credentials.h
+#define BLE_MAX_READINGS       1     // Newest readings per advertisement (1 fits a legacy PDU)
+#define BLE_ADV_INTERVAL_MS    20    // Advertising interval (minimum for non-connectable)
+#define BLE_ADV_EVENTS         5     // Advertising events per wake, each on all three channels
 
 #endif // PLANTBOT2_PINS_H
\ No newline at end of file
@@ -0,0 +1,409 @@
+/*
+ * PlantBot2 Reading Series Codec
+ * 
+ * Compressed block of consecutive readings, in the style of Facebook's
+ * Gorilla time-series encoding. Timestamps are stored as delta-of-delta,
+ * which is 0 for a steady wake interval. Sensor values are fixed-point
+ * integers here rather than floats, so Gorilla's XOR of consecutive values
+ * becomes the zig-zag encoded difference to the previous reading. Both go
+ * in variable-length buckets sized for each PlantBot field, so an
+ * unchanged value costs one bit and typical sensor noise a few.
+ * 
+ * Header-only and free of Arduino dependencies so the same code decodes
+ * blocks on the host (sim -Z benchmarks it on reading traces).
+ * 
+ * Block layout (version 1), little-endian header then an MSB-first
+ * bitstream:
+ *   offset  size  field
+ *   0       2     magic "PS"
+ *   2       1     version
+ *   3       1     flags (reserved, 0)
+ *   4       6     device MAC
+ *   10      4     log sequence number of the first reading (the rest follow
+ *                 with consecutive numbers)
+ *   14      4     device clock (time(nullptr)) when the block was encoded
+ *   18      2     power cycle of the device clock; readings taken in the
+ *                 same power cycle are (device clock - taken at) seconds old
+ *   20      2     reading count N
+ *   22      ...   first reading in full: taken at 32, power cycle 16,
+ *                 temperature 16, humidity 16, battery 16, light 16,
+ *                 moisture 16, moisture % 16, flags 8 (bits)
+ *                 then per further reading:
+ *                   timestamp delta-of-delta: '0' = 0, '10' + 7 bits,
+ *                     '110' + 9, '1110' + 12, '1111' + 32
+ *                   power cycle and flags: '0' = unchanged, '1' + full value
+ *                   each sensor field in the order above: '0' = unchanged,
+ *                     '10' + short, '110' + long zig-zag difference,
+ *                     '111' + full 16-bit value (SERIES_FIELDS widths)
+ *   padded with 0 bits to a whole byte
+ * 
+ * Version: 1.0
+ */
+
+#ifndef SERIES_CODEC_H
+#define SERIES_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "telemetry_codec.h"
+
+#define SERIES_VERSION          1
+#define SERIES_CONTENT_TYPE     "application/x-plantbot-series"
+#define SERIES_HEADER_SIZE      22
+#define SERIES_FIRST_BITS       (32 + 16 + 6 * 16 + 8)
+#define SERIES_READING_MAX_BITS (36 + 17 + 9 + 6 * 19)
+#define SERIES_MAX_SIZE(n)      ((size_t)SERIES_HEADER_SIZE + \
+                                 (SERIES_FIRST_BITS + (size_t)(n) * SERIES_READING_MAX_BITS + 7) / 8)
+#define SERIES_FIELDS           6
+
+// One reading in the same fixed-point units as the RTC batch and flash log
+struct SeriesReading {
+    uint32_t takenAt;           // time(nullptr) in the power cycle it was taken in
+    uint16_t powerCycle;
+    int16_t temperatureCenti;   // 0.01 °C
+    uint16_t humidityCenti;     // 0.01 %RH
+    uint16_t batteryMv;
+    uint16_t lightLevel;        // raw ADC
+    uint16_t moistureLevel;     // raw ADC
+    uint16_t moistureCenti;     // 0.01 %
+    uint8_t flags;              // TELEMETRY_READING_*
+};
+
+struct SeriesHeader {
+    uint8_t mac[6];
+    uint32_t firstSequence;
+    uint32_t deviceTime;
+    uint16_t powerCycle;
+    uint16_t readingCount;
+};
+
+// Difference buckets per sensor field, in bits of the zig-zag value. Sized
+// from readings every two hours: ADC noise fits the short bucket, a
+// day's light or temperature swing the long one.
+struct SeriesField {
+    uint8_t shortBits;
+    uint8_t longBits;
+};
+
+static const SeriesField seriesFields[SERIES_FIELDS] = {
+    {6, 11},    // Temperature: ±0.31 °C, ±10.23 °C
+    {7, 12},    // Humidity: ±0.63 %RH, ±20.47 %RH
+    {4, 9},     // Battery: ±7 mV, ±255 mV
+    {5, 12},    // Light: ±15, ±2047
+    {4, 9},     // Moisture: ±7, ±255
+    {5, 10},    // Moisture %: ±0.15 %, ±5.11 %
+};
+
+static inline uint16_t seriesFieldValue(const SeriesReading &r, int field) {
+    switch (field) {
+    case 0: return (uint16_t)r.temperatureCenti;
+    case 1: return r.humidityCenti;
+    case 2: return r.batteryMv;
+    case 3: return r.lightLevel;
+    case 4: return r.moistureLevel;
+    default: return r.moistureCenti;
+    }
+}
+
+static inline void seriesSetField(SeriesReading &r, int field, uint16_t value) {
+    switch (field) {
+    case 0: r.temperatureCenti = (int16_t)value; break;
+    case 1: r.humidityCenti = value; break;
+    case 2: r.batteryMv = value; break;
+    case 3: r.lightLevel = value; break;
+    case 4: r.moistureLevel = value; break;
+    default: r.moistureCenti = value; break;
+    }
+}
+
+// Zig-zag: small differences of either sign become small unsigned values
+static inline uint32_t seriesZigZag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t seriesUnZigZag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// MSB-first bit stream over a byte buffer
+struct SeriesBits {
+    uint8_t *data;
+    size_t capacityBits;
+    size_t position;
+};
+
+static inline bool seriesPutBits(SeriesBits &bits, uint32_t value, int count) {
+    if (bits.position + count > bits.capacityBits) {
+        return false;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        uint8_t mask = 0x80 >> (bits.position & 7);
+        if ((value >> i) & 1) {
+            bits.data[bits.position >> 3] |= mask;
+        } else {
+            bits.data[bits.position >> 3] &= ~mask;
+        }
+        bits.position++;
+    }
+    return true;
+}
+
+static inline bool seriesGetBits(SeriesBits &bits, int count, uint32_t &value) {
+    if (bits.position + count > bits.capacityBits) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        value = (value << 1) | ((bits.data[bits.position >> 3] >> (7 - (bits.position & 7))) & 1);
+        bits.position++;
+    }
+    return true;
+}
+
+// Encoder state; readings are appended one at a time so a block can be
+// filled until it runs out of space
+struct SeriesEncoder {
+    uint8_t *out;
+    SeriesBits bits;
+    SeriesHeader header;
+    SeriesReading previous;
+    int64_t previousDelta;
+};
+
+static inline bool seriesBegin(SeriesEncoder &encoder, const SeriesHeader &header, uint8_t *out, size_t capacity) {
+    if (capacity < SERIES_HEADER_SIZE) {
+        return false;
+    }
+    encoder.out = out;
+    encoder.bits = {out + SERIES_HEADER_SIZE, (capacity - SERIES_HEADER_SIZE) * 8, 0};
+    encoder.header = header;
+    encoder.header.readingCount = 0;
+    encoder.previousDelta = 0;
+    return true;
+}
+
+static inline bool seriesPutTimestamp(SeriesBits &bits, int64_t deltaOfDelta) {
+    if (deltaOfDelta == 0) {
+        return seriesPutBits(bits, 0, 1);
+    }
+    if (deltaOfDelta >= -63 && deltaOfDelta <= 64) {
+        return seriesPutBits(bits, 0x2, 2) && seriesPutBits(bits, (uint32_t)(deltaOfDelta + 63), 7);
+    }
+    if (deltaOfDelta >= -255 && deltaOfDelta <= 256) {
+        return seriesPutBits(bits, 0x6, 3) && seriesPutBits(bits, (uint32_t)(deltaOfDelta + 255), 9);
+    }
+    if (deltaOfDelta >= -2047 && deltaOfDelta <= 2048) {
+        return seriesPutBits(bits, 0xE, 4) && seriesPutBits(bits, (uint32_t)(deltaOfDelta + 2047), 12);
+    }
+    // Clock restarted or a long gap: the timestamp itself follows
+    return seriesPutBits(bits, 0xF, 4);
+}
+
+static inline bool seriesPutField(SeriesBits &bits, const SeriesField &field, uint16_t previous, uint16_t value) {
+    uint32_t zz = seriesZigZag((int32_t)value - (int32_t)previous);
+    if (zz == 0) {
+        return seriesPutBits(bits, 0, 1);
+    }
+    if (zz < (1u << field.shortBits)) {
+        return seriesPutBits(bits, 0x2, 2) && seriesPutBits(bits, zz, field.shortBits);
+    }
+    if (zz < (1u << field.longBits)) {
+        return seriesPutBits(bits, 0x6, 3) && seriesPutBits(bits, zz, field.longBits);
+    }
+    return seriesPutBits(bits, 0x7, 3) && seriesPutBits(bits, value, 16);
+}
+
+// Append a reading; false (and the block unchanged) when it doesn't fit
+static inline bool seriesAppend(SeriesEncoder &encoder, const SeriesReading &r) {
+    SeriesBits bits = encoder.bits;
+    bool fits;
+    int64_t delta = 0;
+    if (encoder.header.readingCount == 0) {
+        fits = seriesPutBits(bits, r.takenAt, 32) && seriesPutBits(bits, r.powerCycle, 16);
+        for (int field = 0; field < SERIES_FIELDS && fits; field++) {
+            fits = seriesPutBits(bits, seriesFieldValue(r, field), 16);
+        }
+        fits = fits && seriesPutBits(bits, r.flags, 8);
+    } else {
+        const SeriesReading &p = encoder.previous;
+        delta = (int64_t)r.takenAt - p.takenAt;
+        int64_t deltaOfDelta = delta - encoder.previousDelta;
+        bool escaped = !(deltaOfDelta >= -2047 && deltaOfDelta <= 2048);
+        fits = seriesPutTimestamp(bits, deltaOfDelta) && (!escaped || seriesPutBits(bits, r.takenAt, 32));
+        fits = fits && (r.powerCycle == p.powerCycle ? seriesPutBits(bits, 0, 1)
+                                                     : seriesPutBits(bits, 1, 1) && seriesPutBits(bits, r.powerCycle, 16));
+        fits = fits && (r.flags == p.flags ? seriesPutBits(bits, 0, 1)
+                                           : seriesPutBits(bits, 1, 1) && seriesPutBits(bits, r.flags, 8));
+        for (int field = 0; field < SERIES_FIELDS && fits; field++) {
+            fits = seriesPutField(bits, seriesFields[field], seriesFieldValue(p, field), seriesFieldValue(r, field));
+        }
+    }
+    if (!fits || encoder.header.readingCount == UINT16_MAX) {
+        return false;
+    }
+    
+    encoder.bits = bits;
+    encoder.previousDelta = encoder.header.readingCount == 0 ? 0 : delta;
+    encoder.previous = r;
+    encoder.header.readingCount++;
+    return true;
+}
+
+// Write the header and pad the bitstream; returns the block length
+static inline size_t seriesFinish(SeriesEncoder &encoder) {
+    const SeriesHeader &h = encoder.header;
+    uint8_t *p = encoder.out;
+    *p++ = 'P';
+    *p++ = 'S';
+    *p++ = SERIES_VERSION;
+    *p++ = 0;
+    memcpy(p, h.mac, sizeof(h.mac));
+    p += sizeof(h.mac);
+    p = telemetryPut32(p, h.firstSequence);
+    p = telemetryPut32(p, h.deviceTime);
+    p = telemetryPut16(p, h.powerCycle);
+    telemetryPut16(p, h.readingCount);
+    
+    size_t bytes = (encoder.bits.position + 7) / 8;
+    if (encoder.bits.position & 7) {
+        seriesPutBits(encoder.bits, 0, 8 - (encoder.bits.position & 7));
+    }
+    return SERIES_HEADER_SIZE + bytes;
+}
+
+static inline bool seriesGetField(SeriesBits &bits, const SeriesField &field, uint16_t previous, uint16_t &value) {
+    uint32_t prefix, zz;
+    if (!seriesGetBits(bits, 1, prefix)) {
+        return false;
+    }
+    if (prefix == 0) {
+        value = previous;
+        return true;
+    }
+    if (!seriesGetBits(bits, 1, prefix)) {
+        return false;
+    }
+    if (prefix == 0) {
+        if (!seriesGetBits(bits, field.shortBits, zz)) {
+            return false;
+        }
+    } else {
+        if (!seriesGetBits(bits, 1, prefix)) {
+            return false;
+        }
+        if (prefix == 1) {
+            if (!seriesGetBits(bits, 16, zz)) {
+                return false;
+            }
+            value = (uint16_t)zz;
+            return true;
+        }
+        if (!seriesGetBits(bits, field.longBits, zz)) {
+            return false;
+        }
+    }
+    value = (uint16_t)(previous + seriesUnZigZag(zz));
+    return true;
+}
+
+static inline bool seriesGetTimestamp(SeriesBits &bits, const SeriesReading &previous, int64_t &delta,
+                                      uint32_t &takenAt) {
+    // Prefix: number of leading 1 bits, up to four
+    int ones = 0;
+    uint32_t bit = 1;
+    while (ones < 4 && bit == 1) {
+        if (!seriesGetBits(bits, 1, bit)) {
+            return false;
+        }
+        ones += bit;
+    }
+    
+    static const int widths[] = {0, 7, 9, 12};
+    static const int offsets[] = {0, 63, 255, 2047};
+    if (ones == 4) {
+        if (!seriesGetBits(bits, 32, takenAt)) {
+            return false;
+        }
+        delta = (int64_t)takenAt - previous.takenAt;
+        return true;
+    }
+    uint32_t value = 0;
+    if (ones > 0 && !seriesGetBits(bits, widths[ones], value)) {
+        return false;
+    }
+    delta += (int64_t)value - offsets[ones];
+    takenAt = (uint32_t)(previous.takenAt + delta);
+    return true;
+}
+
+// Decode a block; up to maxReadings readings are stored. Returns false on
+// a bad magic, unknown version or truncated block.
+static inline bool seriesDecode(const uint8_t *in, size_t length, SeriesHeader &header,
+                                SeriesReading *readings, size_t maxReadings) {
+    if (length < SERIES_HEADER_SIZE || in[0] != 'P' || in[1] != 'S' || in[2] != SERIES_VERSION) {
+        return false;
+    }
+    memcpy(header.mac, in + 4, sizeof(header.mac));
+    header.firstSequence = telemetryGet32(in + 10);
+    header.deviceTime = telemetryGet32(in + 14);
+    header.powerCycle = telemetryGet16(in + 18);
+    header.readingCount = telemetryGet16(in + 20);
+    
+    SeriesBits bits = {(uint8_t *)in + SERIES_HEADER_SIZE, (length - SERIES_HEADER_SIZE) * 8, 0};
+    SeriesReading previous = {};
+    int64_t delta = 0;
+    for (size_t i = 0; i < header.readingCount; i++) {
+        SeriesReading r = previous;
+        uint32_t value;
+        if (i == 0) {
+            if (!seriesGetBits(bits, 32, r.takenAt) || !seriesGetBits(bits, 16, value)) {
+                return false;
+            }
+            r.powerCycle = value;
+            for (int field = 0; field < SERIES_FIELDS; field++) {
+                if (!seriesGetBits(bits, 16, value)) {
+                    return false;
+                }
+                seriesSetField(r, field, value);
+            }
+            if (!seriesGetBits(bits, 8, value)) {
+                return false;
+            }
+            r.flags = value;
+        } else {
+            if (!seriesGetTimestamp(bits, previous, delta, r.takenAt) || !seriesGetBits(bits, 1, value)) {
+                return false;
+            }
+            if (value == 1) {
+                if (!seriesGetBits(bits, 16, value)) {
+                    return false;
+                }
+                r.powerCycle = value;
+            }
+            if (!seriesGetBits(bits, 1, value)) {
+                return false;
+            }
+            if (value == 1) {
+                if (!seriesGetBits(bits, 8, value)) {
+                    return false;
+                }
+                r.flags = value;
+            }
+            for (int field = 0; field < SERIES_FIELDS; field++) {
+                uint16_t fieldValue;
+                if (!seriesGetField(bits, seriesFields[field], seriesFieldValue(previous, field), fieldValue)) {
+                    return false;
+                }
+                seriesSetField(r, field, fieldValue);
+            }
+        }
+        if (i < maxReadings) {
+            readings[i] = r;
+        }
+        previous = r;
+    }
+    return true;
+}
+
+#endif // SERIES_CODEC_H
@@ -0,0 +1,191 @@
+/*
+ * PlantBot2 Binary Telemetry Codec
+ * 
+ * Compact, versioned fixed-layout encoding of a wake's metadata and its
+ * readings, sent as an alternative to the JSON payload. All multi-byte
+ * fields are little-endian and values use the same fixed-point units as
+ * the RTC reading batch. Header-only and free of Arduino dependencies so
+ * the same code decodes frames on the host.
+ * 
+ * Frame layout (version 1):
+ *   offset  size  field
+ *   0       2     magic "PB"
+ *   2       1     version
+ *   3       1     flags (TELEMETRY_FLAG_*)
+ *   4       6     device MAC
+ *   10      4     boot count
+ *   14      4     uptime (ms)
+ *   18      1     RSSI (dBm, signed)
+ *   19      2     sleep minutes
+ *   21      2     WiFi connect time (ms)
+ *   23      1     uplink reason
+ *   24      20    phase timing, 10 x uint16 ms
+ *   44      1     reading count N
+ *   45      17*N  readings, oldest first:
+ *                   age (s) u32, temperature (0.01 °C) i16,
+ *                   humidity (0.01 %RH) u16, battery (mV) u16,
+ *                   light (raw) u16, moisture (raw) u16,
+ *                   moisture (0.01 %) u16, flags u8
+ * 
+ * A temperature of TELEMETRY_TEMPERATURE_NONE, or humidity or moisture %
+ * of TELEMETRY_CENTI_NONE, means the sensor gave no reading (NaN).
+ * 
+ * Version: 1.0
+ */
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TELEMETRY_VERSION         1
+#define TELEMETRY_CONTENT_TYPE    "application/x-plantbot-telemetry"
+#define TELEMETRY_PHASES          10
+#define TELEMETRY_HEADER_SIZE     45
+#define TELEMETRY_READING_SIZE    17
+#define TELEMETRY_FRAME_SIZE(n)   ((size_t)TELEMETRY_HEADER_SIZE + (size_t)(n) * TELEMETRY_READING_SIZE)
+
+#define TELEMETRY_FLAG_FAST_CONNECT  0x01
+#define TELEMETRY_FLAG_CHARGING      0x02
+
+#define TELEMETRY_READING_LOW_BATTERY 0x01
+#define TELEMETRY_READING_CHARGING    0x02
+
+#define TELEMETRY_TEMPERATURE_NONE    INT16_MIN
+#define TELEMETRY_CENTI_NONE          UINT16_MAX
+
+struct TelemetryHeader {
+    uint8_t flags;
+    uint8_t mac[6];
+    uint32_t bootCount;
+    uint32_t uptimeMs;
+    int8_t rssi;
+    uint16_t sleepMinutes;
+    uint16_t wifiConnectMs;
+    uint8_t uplinkReason;
+    uint16_t phaseMs[TELEMETRY_PHASES];
+    uint8_t readingCount;
+};
+
+struct TelemetryReading {
+    uint32_t ageS;
+    int16_t temperatureCenti;
+    uint16_t humidityCenti;
+    uint16_t batteryMv;
+    uint16_t lightLevel;
+    uint16_t moistureLevel;
+    uint16_t moistureCenti;
+    uint8_t flags;
+};
+
+static inline uint8_t *telemetryPut16(uint8_t *p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+static inline uint8_t *telemetryPut32(uint8_t *p, uint32_t value) {
+    p = telemetryPut16(p, value & 0xFFFF);
+    return telemetryPut16(p, value >> 16);
+}
+
+static inline uint16_t telemetryGet16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t telemetryGet32(const uint8_t *p) {
+    return telemetryGet16(p) | ((uint32_t)telemetryGet16(p + 2) << 16);
+}
+
+// Encode a frame into out; returns the frame length or 0 if it doesn't fit
+static inline size_t telemetryEncode(const TelemetryHeader &header, const TelemetryReading *readings,
+                                     uint8_t *out, size_t capacity) {
+    size_t length = TELEMETRY_FRAME_SIZE(header.readingCount);
+    if (length > capacity) {
+        return 0;
+    }
+    
+    uint8_t *p = out;
+    *p++ = 'P';
+    *p++ = 'B';
+    *p++ = TELEMETRY_VERSION;
+    *p++ = header.flags;
+    memcpy(p, header.mac, sizeof(header.mac));
+    p += sizeof(header.mac);
+    p = telemetryPut32(p, header.bootCount);
+    p = telemetryPut32(p, header.uptimeMs);
+    *p++ = (uint8_t)header.rssi;
+    p = telemetryPut16(p, header.sleepMinutes);
+    p = telemetryPut16(p, header.wifiConnectMs);
+    *p++ = header.uplinkReason;
+    for (int i = 0; i < TELEMETRY_PHASES; i++) {
+        p = telemetryPut16(p, header.phaseMs[i]);
+    }
+    *p++ = header.readingCount;
+    
+    for (int i = 0; i < header.readingCount; i++) {
+        const TelemetryReading &r = readings[i];
+        p = telemetryPut32(p, r.ageS);
+        p = telemetryPut16(p, (uint16_t)r.temperatureCenti);
+        p = telemetryPut16(p, r.humidityCenti);
+        p = telemetryPut16(p, r.batteryMv);
+        p = telemetryPut16(p, r.lightLevel);
+        p = telemetryPut16(p, r.moistureLevel);
+        p = telemetryPut16(p, r.moistureCenti);
+        *p++ = r.flags;
+    }
+    
+    return length;
+}
+
+// Decode a frame; up to maxReadings readings are stored. Returns false on
+// a bad magic, unknown version or truncated frame.
+static inline bool telemetryDecode(const uint8_t *in, size_t length, TelemetryHeader &header,
+                                   TelemetryReading *readings, size_t maxReadings) {
+    if (length < TELEMETRY_HEADER_SIZE || in[0] != 'P' || in[1] != 'B' || in[2] != TELEMETRY_VERSION) {
+        return false;
+    }
+    
+    const uint8_t *p = in + 3;
+    header.flags = *p++;
+    memcpy(header.mac, p, sizeof(header.mac));
+    p += sizeof(header.mac);
+    header.bootCount = telemetryGet32(p);
+    p += 4;
+    header.uptimeMs = telemetryGet32(p);
+    p += 4;
+    header.rssi = (int8_t)*p++;
+    header.sleepMinutes = telemetryGet16(p);
+    p += 2;
+    header.wifiConnectMs = telemetryGet16(p);
+    p += 2;
+    header.uplinkReason = *p++;
+    for (int i = 0; i < TELEMETRY_PHASES; i++) {
+        header.phaseMs[i] = telemetryGet16(p);
+        p += 2;
+    }
+    header.readingCount = *p++;
+    
+    if (length < TELEMETRY_FRAME_SIZE(header.readingCount)) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < header.readingCount && i < maxReadings; i++) {
+        TelemetryReading &r = readings[i];
+        r.ageS = telemetryGet32(p);
+        r.temperatureCenti = (int16_t)telemetryGet16(p + 4);
+        r.humidityCenti = telemetryGet16(p + 6);
+        r.batteryMv = telemetryGet16(p + 8);
+        r.lightLevel = telemetryGet16(p + 10);
+        r.moistureLevel = telemetryGet16(p + 12);
+        r.moistureCenti = telemetryGet16(p + 14);
+        r.flags = p[16];
+        p += TELEMETRY_READING_SIZE;
+    }
+    
+    return true;
+}
+
+#endif // TELEMETRY_CODEC_H
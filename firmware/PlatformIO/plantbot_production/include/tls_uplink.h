@@ -0,0 +1,60 @@
+/*
+ * PlantBot2 TLS Uplink
+ * 
+ * Minimal HTTPS POST client on mbedTLS with session resumption. The
+ * negotiated session (ticket or session ID) is serialized into RTC memory,
+ * or NVS when it is too large, so the next wake can do an abbreviated
+ * handshake. When the server rejects the session a full handshake is done
+ * and the new session replaces the cached one.
+ * 
+ * With TLS_PINNED_SPKI_SHA256 set in credentials.h the server is
+ * authenticated against a single pinned ECDSA P-256 key (the server key or
+ * an intermediate) and only ECDHE-ECDSA-AES128-GCM-SHA256 is offered.
+ * Without a pin the chain and hostname are verified against the ESP-IDF
+ * certificate bundle, which costs more time in the full handshake.
+ * 
+ * Version: 1.0
+ */
+
+#ifndef TLS_UPLINK_H
+#define TLS_UPLINK_H
+
+#include <Arduino.h>
+
+// Handshake timing (survives deep sleep)
+struct TlsStats {
+    bool lastResumed;           // Most recent handshake was abbreviated
+    uint32_t lastHandshakeMs;   // Most recent handshake, either kind
+    uint32_t fullHandshakeMs;   // Most recent full handshake
+    uint32_t resumedHandshakeMs; // Most recent abbreviated handshake
+    uint32_t fullCount;
+    uint32_t resumedCount;
+    uint32_t verifyUs;          // Pinned key check of the most recent handshake
+};
+
+enum TlsResult : uint8_t {
+    TLS_OK,
+    TLS_ERR_TCP,            // Connection to the server failed
+    TLS_ERR_HANDSHAKE       // Setup, handshake or server key check failed
+};
+
+// Open TCP to ip and run the TLS handshake for host (SNI), offering the cached session
+TlsResult tlsConnect(const char *host, const IPAddress &ip, uint16_t port);
+
+// Send a POST over the open connection, returns the HTTP status code or -1.
+// Up to a few hundred bytes of the response body are returned in response.
+int tlsPost(const char *host, const char *path, const char *contentType,
+            const uint8_t *payload, size_t length, String &response);
+
+// Send a HEAD request without waiting for the response
+void tlsPing(const char *host, const char *path);
+
+// Close the connection and free the TLS context
+void tlsClose();
+
+// Drop the cached session so the next handshake is a full one
+void tlsForgetSession();
+
+const TlsStats &tlsStats();
+
+#endif // TLS_UPLINK_H
@@ -0,0 +1,141 @@
+/*
+ * PlantBot2 Background Sampler
+ * 
+ * See background_sampler.h.
+ */
+
+#include "background_sampler.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <esp_sleep.h>
+#include <time.h>
+
+// Sample statistics and schedule (RTC arena)
+struct SamplerState {
+    bool pending;               // Sleeping between background samples
+    uint32_t fullWakeAt;        // time(nullptr) when the next full wake is due
+    uint32_t lastSampleAt;
+    float referenceMoisture;    // Moisture at the last full wake
+    bool previousDry;
+    
+    uint16_t count;
+    float moistureMin;
+    float moistureMax;
+    float moistureSum;
+    uint16_t lightMin;
+    uint16_t lightMax;
+    uint32_t lightSum;
+    float batteryMin;
+    
+    uint32_t dayStartedAt;
+    float lightIntegral;
+    float lightDailyIntegral;
+};
+
+static SamplerState &samplerState() {
+    return *rtcArenaRegion<SamplerState>(RTC_REGION_SAMPLER);
+}
+
+bool samplerBackgroundWake() {
+    SamplerState &sampler = samplerState();
+    bool background = sampler.pending && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER &&
+                      (int32_t)(sampler.fullWakeAt - (uint32_t)time(nullptr)) > SAMPLE_FULL_WAKE_SLACK_S;
+    if (!background) {
+        sampler.pending = false;
+    }
+    return background;
+}
+
+bool samplerAdd(float moisturePercent, int lightLevel, float batteryVoltage, bool fullWake) {
+    SamplerState &sampler = samplerState();
+    uint32_t now = (uint32_t)time(nullptr);
+    uint16_t light = (uint16_t)constrain(lightLevel, 0, 65535);
+    
+    // Light integral: each sample stands for the time since the previous one
+    if (sampler.dayStartedAt == 0) {
+        sampler.dayStartedAt = now;
+    } else if (sampler.lastSampleAt != 0) {
+        uint32_t elapsedS = min(now - sampler.lastSampleAt, (uint32_t)MAX_SLEEP_MINUTES * 60);
+        sampler.lightIntegral += light * (elapsedS / 3600.0f);
+    }
+    if (now - sampler.dayStartedAt >= 86400) {
+        sampler.lightDailyIntegral = sampler.lightIntegral;
+        sampler.lightIntegral = 0;
+        sampler.dayStartedAt = now;
+    }
+    sampler.lastSampleAt = now;
+    
+    if (sampler.count == 0) {
+        sampler.moistureMin = sampler.moistureMax = moisturePercent;
+        sampler.lightMin = sampler.lightMax = light;
+        sampler.batteryMin = batteryVoltage;
+        sampler.moistureSum = 0;
+        sampler.lightSum = 0;
+    }
+    sampler.moistureMin = min(sampler.moistureMin, moisturePercent);
+    sampler.moistureMax = max(sampler.moistureMax, moisturePercent);
+    sampler.lightMin = min(sampler.lightMin, light);
+    sampler.lightMax = max(sampler.lightMax, light);
+    sampler.batteryMin = min(sampler.batteryMin, batteryVoltage);
+    sampler.moistureSum += moisturePercent;
+    sampler.lightSum += light;
+    if (sampler.count < UINT16_MAX) {
+        sampler.count++;
+    }
+    
+    bool dry = moisturePercent < BATCH_FLUSH_MOISTURE_PERCENT;
+    bool becameDry = dry && !sampler.previousDry;
+    sampler.previousDry = dry;
+    
+    if (fullWake) {
+        sampler.referenceMoisture = moisturePercent;
+        return false;
+    }
+    
+    // Drying out, a watering event, or a battery the full wake must protect
+    bool wake = becameDry ||
+                fabsf(moisturePercent - sampler.referenceMoisture) >= SAMPLE_WAKE_MOISTURE_DELTA ||
+                batteryVoltage < BATTERY_CRITICAL_VOLTAGE;
+    if (wake) {
+        sampler.pending = false;
+    }
+    return wake;
+}
+
+uint64_t samplerSchedule(uint64_t sleepTimeUs) {
+    SamplerState &sampler = samplerState();
+    uint64_t intervalUs = SAMPLE_INTERVAL_MINUTES * 60 * 1000000ULL;
+    if (SAMPLE_INTERVAL_MINUTES == 0 || sleepTimeUs <= intervalUs) {
+        sampler.pending = false;
+        return sleepTimeUs;
+    }
+    
+    sampler.pending = true;
+    sampler.fullWakeAt = (uint32_t)time(nullptr) + (uint32_t)(sleepTimeUs / 1000000ULL);
+    return intervalUs;
+}
+
+uint64_t samplerNextSleepUs() {
+    const SamplerState &sampler = samplerState();
+    uint32_t remainingS = sampler.fullWakeAt - (uint32_t)time(nullptr);
+    return min(remainingS, (uint32_t)SAMPLE_INTERVAL_MINUTES * 60) * 1000000ULL;
+}
+
+void samplerSummary(SamplerSummary &summary) {
+    const SamplerState &sampler = samplerState();
+    summary.count = sampler.count;
+    summary.moistureMin = sampler.moistureMin;
+    summary.moistureMax = sampler.moistureMax;
+    summary.moistureMean = sampler.count ? sampler.moistureSum / sampler.count : 0;
+    summary.lightMin = sampler.lightMin;
+    summary.lightMax = sampler.lightMax;
+    summary.lightMean = sampler.count ? sampler.lightSum / sampler.count : 0;
+    summary.batteryMin = sampler.batteryMin;
+    summary.lightIntegral = sampler.lightIntegral;
+    summary.lightDailyIntegral = sampler.lightDailyIntegral;
+}
+
+void samplerReset() {
+    SamplerState &sampler = samplerState();
+    sampler.count = 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * PlantBot2 BLE Broadcast Uplink
+ * 
+ * See ble_uplink.h.
+ */
+
+#include "ble_uplink.h"
+#include "plantbot2_pins.h"
+
+#if UPLINK_MODE == UPLINK_MODE_BLE
+
+#include <BLEDevice.h>
+#include <BLEAdvertising.h>
+#include "ble_advert.h"
+
+bool bleBegin() {
+    BLEDevice::init("");
+    if (!BLEDevice::getInitialized()) {
+        Serial.println("❌ BLE init failed");
+        return false;
+    }
+    
+    Serial.println("📶 BLE ready");
+    return true;
+}
+
+bool bleBroadcast(const uint8_t *advert, size_t length) {
+    BLEMultiAdvertising advertising(1);
+    
+    // Non-connectable and non-scannable, so the controller only transmits.
+    // A payload that fits uses a legacy PDU so older scanners see it too.
+    esp_ble_gap_ext_adv_params_t params = {};
+    params.type = (length <= BLE_ADVERT_LEGACY_MAX) ? ESP_BLE_GAP_SET_EXT_ADV_PROP_LEGACY_NONCONN
+                                                    : ESP_BLE_GAP_SET_EXT_ADV_PROP_NONCONN_NONSCANNABLE_UNDIRECTED;
+    params.interval_min = BLE_ADV_INTERVAL_MS * 8 / 5;   // 0.625ms units
+    params.interval_max = BLE_ADV_INTERVAL_MS * 8 / 5;
+    params.channel_map = ADV_CHNL_ALL;
+    params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    params.peer_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    params.filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY;
+    params.tx_power = EXT_ADV_TX_PWR_NO_PREFERENCE;
+    params.primary_phy = ESP_BLE_GAP_PHY_1M;
+    params.secondary_phy = ESP_BLE_GAP_PHY_1M;
+    
+    if (!advertising.setAdvertisingParams(0, &params) ||
+        !advertising.setAdvertisingData(0, length, advert)) {
+        Serial.println("❌ BLE advertising setup failed");
+        return false;
+    }
+    
+    // The controller stops by itself after BLE_ADV_EVENTS events
+    advertising.setDuration(0, 0, BLE_ADV_EVENTS);
+    if (!advertising.start()) {
+        Serial.println("❌ BLE advertising failed to start");
+        return false;
+    }
+    
+    delay(BLE_ADV_EVENTS * (BLE_ADV_INTERVAL_MS + 10));   // Interval plus the random 0-10ms delay
+    advertising.clear();
+    
+    Serial.printf("📶 Broadcast %u bytes in %d advertising events\n", (unsigned)length, BLE_ADV_EVENTS);
+    return true;
+}
+
+void bleEnd() {
+    BLEDevice::deinit(false);
+}
+
+#endif // UPLINK_MODE == UPLINK_MODE_BLE
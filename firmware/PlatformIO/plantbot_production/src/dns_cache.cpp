@@ -0,0 +1,232 @@
+/*
+ * PlantBot2 DNS Cache
+ * 
+ * See dns_cache.h.
+ */
+
+#include "dns_cache.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <time.h>
+
+#define DNS_PORT        53
+#define DNS_TYPE_A      1
+#define DNS_CLASS_IN    1
+#define DNS_HOST_MAX    64
+
+// Cached addresses (RTC arena)
+struct DnsEntry {
+    char host[DNS_HOST_MAX];
+    uint32_t ip;
+    uint32_t expiresAt;     // time(nullptr) when the TTL runs out
+};
+
+struct DnsCache {
+    DnsEntry entries[DNS_CACHE_ENTRIES];
+};
+
+static DnsEntry *dnsCache() {
+    return rtcArenaRegion<DnsCache>(RTC_REGION_DNS)->entries;
+}
+
+static DnsEntry *findEntry(const char *host) {
+    DnsEntry *cache = dnsCache();
+    for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        if (cache[i].host[0] != 0 && strcmp(cache[i].host, host) == 0) {
+            return &cache[i];
+        }
+    }
+    return nullptr;
+}
+
+// Skip a (possibly compressed) name, returns the offset after it or 0
+static size_t skipName(const uint8_t *msg, size_t length, size_t pos) {
+    while (pos < length) {
+        uint8_t label = msg[pos];
+        if (label == 0) {
+            return pos + 1;
+        }
+        if ((label & 0xC0) == 0xC0) {
+            return pos + 2; // Compression pointer ends the name
+        }
+        pos += label + 1;
+    }
+    return 0;
+}
+
+// Question section of a response against the one sent; names compare
+// without case (RFC 4343), the label lengths are below any letter
+static bool questionMatches(const uint8_t *answer, const uint8_t *question, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (tolower(answer[i]) != tolower(question[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Query the DNS server for an A record, returns its address and TTL
+static bool queryA(const char *host, IPAddress &ip, uint32_t &ttl) {
+    uint8_t msg[512];
+    uint16_t id = (uint16_t)esp_random();
+    
+    // Header: ID, recursion desired, one question
+    size_t pos = 0;
+    msg[pos++] = id >> 8;
+    msg[pos++] = id & 0xFF;
+    msg[pos++] = 0x01;
+    msg[pos++] = 0x00;
+    msg[pos++] = 0x00;
+    msg[pos++] = 0x01;
+    memset(msg + pos, 0, 6);
+    pos += 6;
+    
+    // Question: host as length-prefixed labels
+    const char *label = host;
+    while (*label) {
+        const char *dot = strchr(label, '.');
+        size_t labelLength = dot ? (size_t)(dot - label) : strlen(label);
+        if (labelLength == 0 || labelLength > 63 || pos + labelLength + 6 > sizeof(msg)) {
+            return false;
+        }
+        msg[pos++] = labelLength;
+        memcpy(msg + pos, label, labelLength);
+        pos += labelLength;
+        label += labelLength + (dot ? 1 : 0);
+    }
+    msg[pos++] = 0;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_TYPE_A;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_CLASS_IN;
+    
+    // Kept to check that the response answers this question
+    uint8_t question[sizeof(msg) - 12];
+    size_t questionLength = pos - 12;
+    memcpy(question, msg + 12, questionLength);
+    
+    IPAddress server = WiFi.dnsIP();
+    WiFiUDP udp;
+    if (!udp.begin(0)) {
+        return false;
+    }
+    udp.beginPacket(server, DNS_PORT);
+    udp.write(msg, pos);
+    if (!udp.endPacket()) {
+        udp.stop();
+        return false;
+    }
+    
+    // Datagrams from anywhere but the server queried are ignored
+    unsigned long startTime = millis();
+    int length = 0;
+    while ((length = udp.parsePacket()) == 0 || udp.remoteIP() != server || udp.remotePort() != DNS_PORT) {
+        if (millis() - startTime >= DNS_QUERY_TIMEOUT_MS) {
+            udp.stop();
+            return false;
+        }
+        if (length == 0) {
+            delay(1);
+        }
+    }
+    length = udp.read(msg, sizeof(msg));
+    udp.stop();
+    
+    // Matching ID, a response, RCODE 0, and the question asked echoed back
+    if (length < 12 || msg[0] != (id >> 8) || msg[1] != (id & 0xFF) ||
+        !(msg[2] & 0x80) || (msg[3] & 0x0F) != 0) {
+        return false;
+    }
+    int questions = (msg[4] << 8) | msg[5];
+    int answers = (msg[6] << 8) | msg[7];
+    if (questions != 1 || 12 + questionLength > (size_t)length ||
+        !questionMatches(msg + 12, question, questionLength)) {
+        return false;
+    }
+    pos = 12 + questionLength;
+    
+    // First A record wins; CNAMEs in front of it are skipped
+    for (int i = 0; i < answers; i++) {
+        pos = skipName(msg, length, pos);
+        if (pos == 0 || pos + 10 > (size_t)length) {
+            return false;
+        }
+        uint16_t type = (msg[pos] << 8) | msg[pos + 1];
+        uint16_t rclass = (msg[pos + 2] << 8) | msg[pos + 3];
+        uint32_t recordTtl = ((uint32_t)msg[pos + 4] << 24) | ((uint32_t)msg[pos + 5] << 16) |
+                             ((uint32_t)msg[pos + 6] << 8) | msg[pos + 7];
+        uint16_t dataLength = (msg[pos + 8] << 8) | msg[pos + 9];
+        pos += 10;
+        if (pos + dataLength > (size_t)length) {
+            return false;
+        }
+        
+        if (type == DNS_TYPE_A && rclass == DNS_CLASS_IN && dataLength == 4) {
+            ip = IPAddress(msg[pos], msg[pos + 1], msg[pos + 2], msg[pos + 3]);
+            ttl = recordTtl;
+            return true;
+        }
+        pos += dataLength;
+    }
+    
+    return false;
+}
+
+bool dnsResolve(const char *host, IPAddress &ip) {
+    // Local deployments may use an address directly
+    if (ip.fromString(host)) {
+        return true;
+    }
+    
+    uint32_t now = (uint32_t)time(nullptr);
+    DnsEntry *entry = findEntry(host);
+    if (DNS_CACHE_ENABLED && entry && (int32_t)(entry->expiresAt - now) > 0) {
+        ip = IPAddress(entry->ip);
+        Serial.printf("DNS cache hit: %s -> %s (%lu s left)\n", host, ip.toString().c_str(),
+                      (unsigned long)(entry->expiresAt - now));
+        return true;
+    }
+    
+    uint32_t ttl = 0;
+    if (!queryA(host, ip, ttl)) {
+        // Unusual answer or server - let lwIP resolve it, without a known TTL
+        if (!WiFi.hostByName(host, ip)) {
+            Serial.printf("❌ DNS lookup failed for %s\n", host);
+            return false;
+        }
+        ttl = DNS_CACHE_FALLBACK_TTL_S;
+    }
+    if (ttl > DNS_CACHE_MAX_TTL_S) {
+        ttl = DNS_CACHE_MAX_TTL_S;
+    }
+    
+    if (DNS_CACHE_ENABLED && strlen(host) < DNS_HOST_MAX) {
+        if (!entry) {
+            // Reuse the entry closest to expiry
+            DnsEntry *cache = dnsCache();
+            entry = &cache[0];
+            for (int i = 1; i < DNS_CACHE_ENTRIES; i++) {
+                if ((int32_t)(cache[i].expiresAt - entry->expiresAt) < 0) {
+                    entry = &cache[i];
+                }
+            }
+            strcpy(entry->host, host);
+        }
+        entry->ip = (uint32_t)ip;
+        entry->expiresAt = now + ttl;
+    }
+    
+    Serial.printf("DNS resolved: %s -> %s (TTL %lu s)\n", host, ip.toString().c_str(),
+                  (unsigned long)ttl);
+    return true;
+}
+
+void dnsInvalidate(const char *host) {
+    DnsEntry *entry = findEntry(host);
+    if (entry) {
+        entry->host[0] = 0;
+        entry->expiresAt = 0;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * PlantBot2 ESP-NOW Uplink
+ * 
+ * See espnow_uplink.h.
+ */
+
+#include "espnow_uplink.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include "credentials.h"
+
+#if UPLINK_MODE == UPLINK_MODE_ESPNOW
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_random.h>
+#include <Preferences.h>
+#include "espnow_crypto.h"
+
+// Counts power-ons, so the gateway can tell a rebooted node's restarted
+// sequence numbers from re-sent readings and reject frames of earlier
+// sessions (RTC arena, the count itself in NVS)
+struct EspNowState {
+    uint32_t session;
+};
+
+static EspNowState &espnowState() {
+    return *rtcArenaRegion<EspNowState>(RTC_REGION_ESPNOW);
+}
+
+static const uint8_t gatewayMac[6] = ESPNOW_GATEWAY_MAC;
+static const uint8_t networkKey[ESPNOW_KEY_SIZE] = ESPNOW_NETWORK_KEY;
+
+static SemaphoreHandle_t sendDone = nullptr;
+static volatile bool sendAcked = false;
+
+static void onSent(const uint8_t *mac, esp_now_send_status_t status) {
+    sendAcked = (status == ESP_NOW_SEND_SUCCESS);
+    xSemaphoreGive(sendDone);
+}
+
+void espnowPrepare() {
+    EspNowState &state = espnowState();
+    if (state.session != 0) {
+        return;
+    }
+    
+    // The arena was cleared along with the batch sequence numbers
+    Preferences prefs;
+    prefs.begin("espnow", false);
+    state.session = prefs.getUInt("session", 0) + 1;
+    if (prefs.putUInt("session", state.session) == 0) {
+        Serial.println("⚠️ ESP-NOW session not saved, the gateway may drop this boot's frames");
+    }
+    prefs.end();
+}
+
+bool espnowBegin() {
+    WiFi.mode(WIFI_STA);
+    if (esp_wifi_set_channel(ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE) != ESP_OK ||
+        esp_now_init() != ESP_OK) {
+        Serial.println("❌ ESP-NOW init failed");
+        return false;
+    }
+    
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, gatewayMac, sizeof(gatewayMac));
+    peer.channel = ESPNOW_CHANNEL;
+    peer.ifidx = WIFI_IF_STA;
+    peer.encrypt = false;   // Frames are sealed with AES-GCM above the link layer
+    
+    if (esp_now_add_peer(&peer) != ESP_OK) {
+        Serial.println("❌ ESP-NOW gateway peer not added");
+        esp_now_deinit();
+        return false;
+    }
+    
+    sendDone = xSemaphoreCreateBinary();
+    esp_now_register_send_cb(onSent);
+    Serial.printf("📻 ESP-NOW ready on channel %d\n", ESPNOW_CHANNEL);
+    return true;
+}
+
+bool espnowSend(const uint8_t *frame, size_t length, uint32_t firstSequence) {
+    EspNowHeader header = {0, espnowState().session, firstSequence};
+    uint8_t nonce[ESPNOW_NONCE_SIZE];
+    uint8_t sealed[ESPNOW_MAX_FRAME];
+    
+    for (int attempt = 1; attempt <= ESPNOW_SEND_RETRIES + 1; attempt++) {
+        // Fresh random nonce per transmission, GCM must never reuse one
+        esp_fill_random(nonce, sizeof(nonce));
+        size_t sealedLength = espnowSeal(networkKey, header, nonce, frame, length, sealed, sizeof(sealed));
+        if (sealedLength == 0) {
+            Serial.println("❌ ESP-NOW frame too large or encryption failed");
+            return false;
+        }
+        
+        xSemaphoreTake(sendDone, 0);
+        sendAcked = false;
+        if (esp_now_send(gatewayMac, sealed, sealedLength) == ESP_OK &&
+            xSemaphoreTake(sendDone, pdMS_TO_TICKS(ESPNOW_ACK_TIMEOUT_MS)) == pdTRUE && sendAcked) {
+            return true;
+        }
+        
+        Serial.printf("⚠️ ESP-NOW frame not acknowledged (attempt %d)\n", attempt);
+    }
+    
+    return false;
+}
+
+void espnowEnd() {
+    esp_now_unregister_send_cb();
+    esp_now_deinit();
+    if (sendDone != nullptr) {
+        vSemaphoreDelete(sendDone);
+        sendDone = nullptr;
+    }
+}
+
+#endif // UPLINK_MODE == UPLINK_MODE_ESPNOW
@@ -0,0 +1,390 @@
+/*
+ * PlantBot2 Flash Telemetry Log
+ * 
+ * See flash_log.h.
+ */
+
+#include "flash_log.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <esp_partition.h>
+#include <Preferences.h>
+#include <time.h>
+
+#define FLASH_LOG_PARTITION     "tlog"
+#define FLASH_LOG_STATE_MAGIC   0x544C4F47
+
+static_assert(sizeof(FlashLogRecord) == FLASH_LOG_RECORD_SIZE, "flash log record size");
+
+// Position in the log (RTC arena, rebuilt after power-on).
+// Sequence numbers below cursor are delivered, [cursor, backlogEnd) is the
+// backlog, [backlogEnd, deliveredEnd) went out with the RTC batch and the
+// rest is still queued in it.
+struct FlashLogState {
+    uint32_t magic;
+    uint32_t sectorCount;
+    uint32_t headSector;
+    uint32_t headSlot;          // Next free record slot in the head sector
+    uint32_t nextSequence;
+    uint32_t tailSequence;      // Oldest record still in flash
+    uint32_t cursor;            // Persisted in NVS
+    uint32_t backlogEnd;
+    uint32_t deliveredEnd;
+    uint16_t powerCycle;
+};
+
+static FlashLogState &flashLogState() {
+    return *rtcArenaRegion<FlashLogState>(RTC_REGION_FLASH_LOG);
+}
+
+static const esp_partition_t *partition = nullptr;
+
+uint16_t flashLogRecordCrc(const FlashLogRecord &record) {
+    const uint8_t *data = (const uint8_t *)&record;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < offsetof(FlashLogRecord, crc); i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool recordValid(const FlashLogRecord &record, uint32_t sequence) {
+    return record.sequence == sequence && record.crc == flashLogRecordCrc(record);
+}
+
+static bool slotErased(const FlashLogRecord &record) {
+    const uint8_t *data = (const uint8_t *)&record;
+    for (size_t i = 0; i < sizeof(record); i++) {
+        if (data[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t slotOffset(uint32_t sector, uint32_t slot) {
+    return (size_t)sector * FLASH_LOG_SECTOR_SIZE + (slot + 1) * FLASH_LOG_RECORD_SIZE;
+}
+
+// Sector and slot of a record still in flash (records fill the sectors in ring order)
+static void locate(uint32_t sequence, uint32_t &sector, uint32_t &slot) {
+    const FlashLogState &logState = flashLogState();
+    uint32_t headFirst = logState.nextSequence - logState.headSlot;
+    if (sequence >= headFirst) {
+        sector = logState.headSector;
+        slot = sequence - headFirst;
+        return;
+    }
+    uint32_t back = (headFirst - sequence + FLASH_LOG_SECTOR_RECORDS - 1) / FLASH_LOG_SECTOR_RECORDS;
+    sector = (logState.headSector + logState.sectorCount - back % logState.sectorCount) % logState.sectorCount;
+    slot = sequence - (headFirst - back * FLASH_LOG_SECTOR_RECORDS);
+}
+
+static bool readRecord(uint32_t sequence, FlashLogRecord &record) {
+    uint32_t sector, slot;
+    locate(sequence, sector, slot);
+    return esp_partition_read(partition, slotOffset(sector, slot), &record, sizeof(record)) == ESP_OK &&
+           recordValid(record, sequence);
+}
+
+static bool readSectorHeader(uint32_t sector, uint32_t &firstSequence) {
+    FlashLogSectorHeader header;
+    if (esp_partition_read(partition, (size_t)sector * FLASH_LOG_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK ||
+        header.magic != FLASH_LOG_SECTOR_MAGIC || header.check != ~header.firstSequence) {
+        return false;
+    }
+    firstSequence = header.firstSequence;
+    return true;
+}
+
+// Erase a sector and mark it as starting at firstSequence
+static bool startSector(uint32_t sector, uint32_t firstSequence) {
+    size_t offset = (size_t)sector * FLASH_LOG_SECTOR_SIZE;
+    FlashLogSectorHeader header = {FLASH_LOG_SECTOR_MAGIC, firstSequence, ~firstSequence};
+    if (esp_partition_erase_range(partition, offset, FLASH_LOG_SECTOR_SIZE) != ESP_OK ||
+        esp_partition_write(partition, offset, &header, sizeof(header)) != ESP_OK) {
+        Serial.printf("❌ Flash log sector %lu could not be started\n", (unsigned long)sector);
+        return false;
+    }
+    return true;
+}
+
+static void persistCursor() {
+    const FlashLogState &logState = flashLogState();
+    Preferences prefs;
+    prefs.begin("tlog", false);
+    prefs.putUInt("cursor", logState.cursor);
+    prefs.end();
+}
+
+// Cursor and interval ends never point at overwritten records
+static void clampToTail() {
+    FlashLogState &logState = flashLogState();
+    if (logState.cursor < logState.tailSequence) {
+        // Minus the part that was delivered from the batch
+        uint32_t delivered = min(logState.deliveredEnd, logState.tailSequence);
+        uint32_t lost = logState.tailSequence - logState.cursor -
+                        (delivered > logState.backlogEnd ? delivered - logState.backlogEnd : 0);
+        if (lost > 0) {
+            Serial.printf("⚠️ Flash log full, %lu undelivered readings overwritten\n", (unsigned long)lost);
+        }
+        logState.cursor = logState.tailSequence;
+    }
+    logState.backlogEnd = max(logState.backlogEnd, logState.cursor);
+    logState.deliveredEnd = max(logState.deliveredEnd, logState.backlogEnd);
+}
+
+// Rebuild the position from the sector headers after a power-on reset
+static bool mount(uint32_t sectorCount) {
+    FlashLogState &logState = flashLogState();
+    logState = {};
+    logState.sectorCount = sectorCount;
+    
+    bool found = false;
+    uint32_t tailFirst = 0;
+    for (uint32_t sector = 0; sector < sectorCount; sector++) {
+        uint32_t first;
+        if (!readSectorHeader(sector, first)) {
+            continue;
+        }
+        if (!found || first > logState.nextSequence) {
+            logState.headSector = sector;
+            logState.nextSequence = first;
+        }
+        if (!found || first < tailFirst) {
+            tailFirst = first;
+        }
+        found = true;
+    }
+    
+    if (!found) {
+        Serial.println("🗂️ Flash log empty, formatting");
+        if (!startSector(0, 0)) {
+            return false;
+        }
+        logState.magic = FLASH_LOG_STATE_MAGIC;
+        persistCursor();
+        return true;
+    }
+    
+    // First erased slot of the head sector; torn writes still use up their slot
+    FlashLogRecord page[256 / FLASH_LOG_RECORD_SIZE];
+    uint32_t slot = 0;
+    bool erased = false;
+    while (slot < FLASH_LOG_SECTOR_RECORDS && !erased) {
+        uint32_t run = min((uint32_t)(sizeof(page) / sizeof(page[0])), FLASH_LOG_SECTOR_RECORDS - slot);
+        if (esp_partition_read(partition, slotOffset(logState.headSector, slot), page, run * sizeof(page[0])) != ESP_OK) {
+            return false;
+        }
+        for (uint32_t i = 0; i < run && !erased; i++) {
+            erased = slotErased(page[i]);
+            slot += erased ? 0 : 1;
+        }
+    }
+    logState.headSlot = slot;
+    logState.nextSequence += slot;
+    logState.tailSequence = tailFirst;
+    
+    // Records of this power cycle get the next power cycle number
+    for (uint32_t sequence = logState.nextSequence; sequence > logState.tailSequence; sequence--) {
+        FlashLogRecord last;
+        if (readRecord(sequence - 1, last)) {
+            logState.powerCycle = last.powerCycle + 1;
+            break;
+        }
+        if (logState.nextSequence - sequence >= FLASH_LOG_SECTOR_RECORDS) {
+            break;
+        }
+    }
+    
+    // Everything after the persisted cursor is backlog - the RTC batch is gone
+    Preferences prefs;
+    prefs.begin("tlog", true);
+    logState.cursor = min(prefs.getUInt("cursor", 0), logState.nextSequence);
+    prefs.end();
+    logState.backlogEnd = logState.nextSequence;
+    logState.deliveredEnd = logState.nextSequence;
+    clampToTail();
+    
+    logState.magic = FLASH_LOG_STATE_MAGIC;
+    Serial.printf("🗂️ Flash log: %lu readings, %lu in backlog\n",
+                  (unsigned long)(logState.nextSequence - logState.tailSequence), (unsigned long)flashLogBacklog());
+    return true;
+}
+
+bool flashLogBegin() {
+    const FlashLogState &logState = flashLogState();
+    partition = nullptr;
+#if FLASH_LOG_ENABLED
+    const esp_partition_t *found = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                            FLASH_LOG_PARTITION);
+    uint32_t sectorCount = found ? found->size / FLASH_LOG_SECTOR_SIZE : 0;
+    if (sectorCount < 2) {
+        Serial.println("⚠️ No flash log partition, offline readings are not kept");
+        return false;
+    }
+    
+    partition = found;
+    if (logState.magic == FLASH_LOG_STATE_MAGIC && logState.sectorCount == sectorCount) {
+        return true;
+    }
+    if (!mount(sectorCount)) {
+        Serial.println("❌ Flash log could not be mounted");
+        partition = nullptr;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Move the head to the next sector, dropping the oldest records in it
+static bool rotate() {
+    FlashLogState &logState = flashLogState();
+    uint32_t sector = (logState.headSector + 1) % logState.sectorCount;
+    if (!startSector(sector, logState.nextSequence)) {
+        return false;
+    }
+    logState.headSector = sector;
+    logState.headSlot = 0;
+    
+    uint32_t kept = (logState.sectorCount - 1) * FLASH_LOG_SECTOR_RECORDS;
+    if (logState.nextSequence - logState.tailSequence > kept) {
+        logState.tailSequence = logState.nextSequence - kept;
+        clampToTail();
+    }
+    return true;
+}
+
+void flashLogAppend(const BatchedReading &reading) {
+    FlashLogState &logState = flashLogState();
+    if (partition == nullptr) {
+        return;
+    }
+    if (logState.headSlot >= FLASH_LOG_SECTOR_RECORDS && !rotate()) {
+        return;
+    }
+    
+    FlashLogRecord record;
+    memset(&record, 0xFF, sizeof(record));
+    record.sequence = logState.nextSequence;
+    record.takenAt = reading.takenAt;
+    record.powerCycle = logState.powerCycle;
+    record.temperatureCenti = reading.temperatureCenti;
+    record.humidityCenti = reading.humidityCenti;
+    record.batteryMv = reading.batteryMv;
+    record.lightLevel = reading.lightLevel;
+    record.moistureLevel = reading.moistureLevel;
+    record.moistureCenti = reading.moistureCenti;
+    record.flags = reading.flags;
+    record.crc = flashLogRecordCrc(record);
+    
+    // The slot is used up even if the write fails; readers skip it
+    esp_err_t err = esp_partition_write(partition, slotOffset(logState.headSector, logState.headSlot),
+                                        &record, sizeof(record));
+    logState.headSlot++;
+    logState.nextSequence++;
+    if (err != ESP_OK) {
+        Serial.printf("❌ Flash log write failed: %d\n", err);
+    }
+}
+
+void flashLogBatchDelivered(int count, int pending) {
+    FlashLogState &logState = flashLogState();
+    if (partition == nullptr || count <= 0) {
+        return;
+    }
+    
+    // Before the delivered ones: appended after the previous delivery but
+    // no longer in the batch
+    uint32_t undelivered = logState.nextSequence - logState.deliveredEnd;
+    uint32_t end = logState.nextSequence - min((uint32_t)max(pending, 0), undelivered);
+    uint32_t delivered = min((uint32_t)count, end - logState.deliveredEnd);
+    uint32_t first = end - delivered;
+    if (first > logState.deliveredEnd) {
+        Serial.printf("🗂️ %lu readings dropped from the batch go to the backlog\n",
+                      (unsigned long)(first - logState.deliveredEnd));
+        logState.backlogEnd = first;
+    }
+    logState.deliveredEnd = end;
+    
+    if (logState.cursor >= logState.backlogEnd) {
+        logState.cursor = logState.backlogEnd = logState.deliveredEnd;
+        persistCursor();
+    }
+}
+
+uint32_t flashLogBacklog() {
+    const FlashLogState &logState = flashLogState();
+    return partition ? logState.backlogEnd - logState.cursor : 0;
+}
+
+int flashLogReadBacklog(FlashLogRecord *records, int maxRecords) {
+    FlashLogState &logState = flashLogState();
+    if (partition == nullptr) {
+        return 0;
+    }
+    
+    int count = 0;
+    uint32_t position = logState.cursor;
+    while (count < maxRecords && position < logState.backlogEnd) {
+        // Consecutive slots of one sector in a single read
+        uint32_t sector, slot;
+        locate(position, sector, slot);
+        uint32_t run = min(min((uint32_t)(maxRecords - count), logState.backlogEnd - position),
+                           FLASH_LOG_SECTOR_RECORDS - slot);
+        int start = count;
+        if (esp_partition_read(partition, slotOffset(sector, slot), &records[start],
+                               run * sizeof(FlashLogRecord)) != ESP_OK) {
+            break;
+        }
+        
+        for (uint32_t i = 0; i < run; i++) {
+            if (recordValid(records[start + i], position + i)) {
+                if (count != (int)(start + i)) {
+                    records[count] = records[start + i];
+                }
+                count++;
+            } else if (count > 0) {
+                return count; // Keep the sequence numbers consecutive
+            } else {
+                logState.cursor = position + i + 1; // Torn or failed write
+            }
+        }
+        position += run;
+    }
+    
+    if (count == 0 && logState.cursor >= logState.backlogEnd) {
+        flashLogBacklogDelivered(0);
+    }
+    return count;
+}
+
+void flashLogBacklogDelivered(int count) {
+    FlashLogState &logState = flashLogState();
+    if (partition == nullptr) {
+        return;
+    }
+    
+    logState.cursor = min(logState.cursor + count, logState.backlogEnd);
+    if (logState.cursor >= logState.backlogEnd) {
+        logState.cursor = logState.backlogEnd = logState.deliveredEnd;
+    }
+    persistCursor();
+}
+
+uint16_t flashLogPowerCycle() {
+    return flashLogState().powerCycle;
+}
+
+uint32_t flashLogAgeS(const FlashLogRecord &record) {
+    const FlashLogState &logState = flashLogState();
+    if (record.powerCycle != logState.powerCycle) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)time(nullptr) - record.takenAt;
+}
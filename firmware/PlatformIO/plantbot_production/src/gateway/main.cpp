@@ -0,0 +1,295 @@
+/*
+ * PlantBot2 ESP-NOW Gateway Firmware
+ * 
+ * Mains-powered bridge for nodes built with UPLINK_MODE_ESPNOW. Sealed
+ * frames are received over ESP-NOW, authenticated and decrypted with the
+ * network key, stripped of readings already forwarded, and queued. The
+ * queue is forwarded to the dashboard in bursts over one kept-alive
+ * connection, in the same JSON schema the nodes use for direct uploads.
+ * 
+ * Build with: pio run -e gateway
+ * 
+ * Target: ESP32-C6-MINI-1-N4
+ * Version: 1.0
+ * Author: elektroThing
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiManager.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "plantbot2_pins.h"
+#include "espnow_crypto.h"
+#include "gateway_queue.h"
+#include "uplink_deadband.h"
+#include "credentials.h"
+
+// Raw frame handed from the WiFi task to the loop
+struct RawFrame {
+    uint8_t mac[6];
+    int8_t rssi;
+    uint32_t receivedMs;
+    uint8_t length;
+    uint8_t data[ESPNOW_MAX_FRAME];
+};
+
+static const uint8_t networkKey[ESPNOW_KEY_SIZE] = ESPNOW_NETWORK_KEY;
+
+QueueHandle_t rxQueue = nullptr;
+GatewayDedup dedup = {};
+GatewayQueue forwardQueue = {};
+unsigned long retryAfterMs = 0;
+uint32_t framesRejected = 0;
+uint32_t readingsDuplicate = 0;
+
+#ifdef USE_HTTPS
+WiFiClientSecure client;
+#else
+WiFiClient client;
+#endif
+HTTPClient http;
+WiFiManager wifiManager;
+
+// Function declarations
+void onReceive(const esp_now_recv_info_t *info, const uint8_t *data, int length);
+void handleFrame(const RawFrame &raw);
+bool forwardQueued();
+String buildForwardJson(const GatewayForward &item);
+
+void setup() {
+    Serial.begin(SERIAL_BAUD_RATE);
+    delay(1000);
+    Serial.println("\n🌱 PlantBot2 ESP-NOW Gateway");
+    
+    // The gateway stays associated, so ESP-NOW shares the access point's channel
+    WiFi.mode(WIFI_STA);
+    wifiManager.setConfigPortalTimeout(300); // 5 minutes
+    if (!wifiManager.autoConnect("PlantBot2-Gateway-Setup")) {
+        Serial.println("❌ WiFi configuration failed, restarting");
+        delay(1000);
+        ESP.restart();
+    }
+    
+    Serial.printf("📡 Connected, IP %s\n", WiFi.localIP().toString().c_str());
+    Serial.printf("Gateway MAC (ESPNOW_GATEWAY_MAC): %s\n", WiFi.macAddress().c_str());
+    Serial.printf("Channel: %d\n", WiFi.channel());
+    if (WiFi.channel() != ESPNOW_CHANNEL) {
+        Serial.printf("⚠️ Nodes send on channel %d - set ESPNOW_CHANNEL to %d\n",
+                      ESPNOW_CHANNEL, WiFi.channel());
+    }
+    
+    // Modem sleep would leave the radio off between beacons and miss node
+    // frames and their ACKs - the gateway is mains powered
+    WiFi.setSleep(false);
+    
+    rxQueue = xQueueCreate(16, sizeof(RawFrame));
+    if (rxQueue == nullptr || esp_now_init() != ESP_OK) {
+        Serial.println("❌ ESP-NOW init failed, restarting");
+        delay(1000);
+        ESP.restart();
+    }
+    esp_now_register_recv_cb(onReceive);
+    
+#ifdef USE_HTTPS
+    // The nodes' pinned-key check lives in tls_uplink; the gateway relies on
+    // its own network and doesn't verify the server certificate
+    client.setInsecure();
+#endif
+    http.setReuse(true);
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    
+    Serial.println("✅ Listening for nodes");
+}
+
+void loop() {
+    RawFrame raw;
+    while (xQueueReceive(rxQueue, &raw, pdMS_TO_TICKS(100)) == pdTRUE) {
+        handleFrame(raw);
+    }
+    
+    uint32_t now = millis();
+    if ((int32_t)(now - retryAfterMs) >= 0 &&
+        gatewayFlushDue(forwardQueue, now, GATEWAY_BATCH_SIZE, GATEWAY_BATCH_MAX_DELAY_MS)) {
+        if (!forwardQueued()) {
+            retryAfterMs = millis() + GATEWAY_RETRY_MS;
+        }
+    }
+}
+
+void onReceive(const esp_now_recv_info_t *info, const uint8_t *data, int length) {
+    // Runs in the WiFi task - copy and leave the work to the loop
+    if (length <= 0 || length > ESPNOW_MAX_FRAME) {
+        return;
+    }
+    
+    RawFrame raw;
+    memcpy(raw.mac, info->src_addr, sizeof(raw.mac));
+    raw.rssi = info->rx_ctrl ? info->rx_ctrl->rssi : 0;
+    raw.receivedMs = millis();
+    raw.length = length;
+    memcpy(raw.data, data, length);
+    xQueueSend(rxQueue, &raw, 0);
+}
+
+void handleFrame(const RawFrame &raw) {
+    EspNowHeader envelope;
+    EspNowParts parts;
+    uint8_t plain[ESPNOW_MAX_FRAME];
+    TelemetryHeader header;
+    TelemetryReading readings[ESPNOW_MAX_READINGS];
+    
+    // Forged, corrupted or foreign frames fail the tag check. The node MAC
+    // inside the frame must match the sender, so a frame can't be replayed
+    // as another node's.
+    if (!espnowParse(raw.data, raw.length, envelope, parts) ||
+        !espnowOpen(networkKey, parts, plain) ||
+        !telemetryDecode(plain, parts.ciphertextLength, header, readings, ESPNOW_MAX_READINGS) ||
+        header.readingCount > ESPNOW_MAX_READINGS ||
+        memcmp(header.mac, raw.mac, sizeof(raw.mac)) != 0) {
+        framesRejected++;
+        Serial.printf("⚠️ Frame from %02X:%02X:%02X:%02X:%02X:%02X rejected (%lu so far)\n",
+                      raw.mac[0], raw.mac[1], raw.mac[2], raw.mac[3], raw.mac[4], raw.mac[5],
+                      (unsigned long)framesRejected);
+        return;
+    }
+    
+    int skip = gatewayAccept(dedup, raw.mac, envelope.session, envelope.firstSequence,
+                             header.readingCount, raw.receivedMs);
+    if (skip < 0) {
+        framesRejected++;
+        Serial.println("⚠️ Frame from an earlier session dropped (replay)");
+        return;
+    }
+    readingsDuplicate += skip;
+    if (skip == header.readingCount) {
+        Serial.println("🔁 Duplicate frame dropped");
+        return;
+    }
+    
+    GatewayForward &item = gatewayQueuePush(forwardQueue);
+    memcpy(item.mac, raw.mac, sizeof(item.mac));
+    item.rssi = raw.rssi;
+    item.receivedMs = raw.receivedMs;
+    item.header = header;
+    item.readingCount = header.readingCount - skip;
+    memcpy(item.readings, readings + skip, item.readingCount * sizeof(TelemetryReading));
+    
+    Serial.printf("📥 %d readings from %02X:%02X:%02X:%02X:%02X:%02X (RSSI %d), %d frames queued\n",
+                  item.readingCount, raw.mac[0], raw.mac[1], raw.mac[2], raw.mac[3], raw.mac[4],
+                  raw.mac[5], raw.rssi, forwardQueue.count);
+}
+
+bool forwardQueued() {
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("❌ WiFi down, forwarding postponed");
+        WiFi.reconnect();
+        return false;
+    }
+    
+    // One connection for the whole burst - HTTPClient keeps it open between POSTs
+    if (!http.begin(client, SERVER_HOST, SERVER_PORT, DATA_ENDPOINT)) {
+        return false;
+    }
+    http.addHeader("Content-Type", "application/json");
+    
+    int forwarded = 0;
+    bool ok = true;
+    while (forwardQueue.count > 0) {
+        String json = buildForwardJson(gatewayQueueFront(forwardQueue));
+        int httpResponseCode = http.POST(json);
+        
+        if (httpResponseCode >= 400 && httpResponseCode < 500) {
+            // The server will never take this one - don't block the queue on it
+            Serial.printf("❌ Forward rejected: %d, frame dropped\n", httpResponseCode);
+        } else if (httpResponseCode != 200) {
+            Serial.printf("❌ Forward failed: %d, %d frames kept\n", httpResponseCode, forwardQueue.count);
+            ok = false;
+            break;
+        } else {
+            forwarded++;
+        }
+        gatewayQueuePop(forwardQueue);
+    }
+    http.end();
+    
+    Serial.printf("📤 %d frames forwarded (%lu duplicate readings, %lu frames overwritten so far)\n",
+                  forwarded, (unsigned long)readingsDuplicate, (unsigned long)forwardQueue.dropped);
+    return ok;
+}
+
+String buildForwardJson(const GatewayForward &item) {
+    // Same fields as a direct node upload, null where the sensor gave no
+    // reading; readings are timed relative to when the gateway sends them,
+    // so their queueing delay is added
+    const TelemetryHeader &header = item.header;
+    uint32_t queuedS = (millis() - item.receivedMs) / 1000;
+    const TelemetryReading &latest = item.readings[item.readingCount - 1];
+    
+    char deviceId[18];
+    snprintf(deviceId, sizeof(deviceId), "%02X:%02X:%02X:%02X:%02X:%02X",
+             item.mac[0], item.mac[1], item.mac[2], item.mac[3], item.mac[4], item.mac[5]);
+    
+    JsonDocument doc;
+    doc["device_id"] = deviceId;
+    doc["timestamp"] = header.uptimeMs;
+    if (latest.temperatureCenti != TELEMETRY_TEMPERATURE_NONE) {
+        doc["temperature"] = latest.temperatureCenti / 100.0;
+    } else {
+        doc["temperature"] = nullptr;
+    }
+    if (latest.humidityCenti != TELEMETRY_CENTI_NONE) {
+        doc["humidity"] = latest.humidityCenti / 100.0;
+    } else {
+        doc["humidity"] = nullptr;
+    }
+    doc["battery_voltage"] = latest.batteryMv / 1000.0;
+    doc["light_level"] = latest.lightLevel;
+    doc["moisture_level"] = latest.moistureLevel;
+    if (latest.moistureCenti != TELEMETRY_CENTI_NONE) {
+        doc["moisture_percent"] = latest.moistureCenti / 100.0;
+    } else {
+        doc["moisture_percent"] = nullptr;
+    }
+    doc["boot_count"] = header.bootCount;
+    doc["rssi"] = item.rssi;
+    doc["low_battery"] = (latest.flags & TELEMETRY_READING_LOW_BATTERY) != 0;
+    doc["sleep_minutes"] = header.sleepMinutes;
+    doc["charging"] = (header.flags & TELEMETRY_FLAG_CHARGING) != 0;
+    doc["uplink_reason"] = uplinkReasonName((UplinkReason)header.uplinkReason);
+    doc["via_gateway"] = WiFi.macAddress();
+    
+    JsonArray readings = doc["readings"].to<JsonArray>();
+    for (int i = 0; i < item.readingCount; i++) {
+        const TelemetryReading &r = item.readings[i];
+        JsonObject entry = readings.add<JsonObject>();
+        entry["age_s"] = r.ageS + queuedS;
+        if (r.temperatureCenti != TELEMETRY_TEMPERATURE_NONE) {
+            entry["temperature"] = r.temperatureCenti / 100.0;
+        } else {
+            entry["temperature"] = nullptr;
+        }
+        if (r.humidityCenti != TELEMETRY_CENTI_NONE) {
+            entry["humidity"] = r.humidityCenti / 100.0;
+        } else {
+            entry["humidity"] = nullptr;
+        }
+        entry["battery_voltage"] = r.batteryMv / 1000.0;
+        entry["light_level"] = r.lightLevel;
+        entry["moisture_level"] = r.moistureLevel;
+        if (r.moistureCenti != TELEMETRY_CENTI_NONE) {
+            entry["moisture_percent"] = r.moistureCenti / 100.0;
+        } else {
+            entry["moisture_percent"] = nullptr;
+        }
+        entry["low_battery"] = (r.flags & TELEMETRY_READING_LOW_BATTERY) != 0;
+        entry["charging"] = (r.flags & TELEMETRY_READING_CHARGING) != 0;
+    }
+    
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -13,102 +13,229 @@
 #include <WiFi.h>
 #include <WiFiManager.h>
 #include <WiFiMulti.h>
-#include <Wire.h>
-#include <Adafruit_AHTX0.h>
 #include <esp_sleep.h>
 #include <esp_wifi.h>
-#include <esp_bt.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
 #include <esp_pm.h>
 #include <HTTPClient.h>
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include "plantbot2_pins.h"
+#include "sensor_data.h"
+#include "reading_batch.h"
+#include "uplink_deadband.h"
+#include "telemetry_codec.h"
+#include "series_codec.h"
+#include "wake_profiler.h"
+#include "board.h"
+#include "adc_sampler.h"
+#include "power_policy.h"
+#include "tls_uplink.h"
+#include "dns_cache.h"
+#include "retry_policy.h"
+#include "background_sampler.h"
+#include "espnow_uplink.h"
+#include "espnow_frame.h"
+#include "ble_uplink.h"
+#include "ble_advert.h"
+#include "ble_advert_auth.h"
+#include "flash_log.h"
+#include "rtc_arena.h"
 #include "credentials.h"
 
+// A cloud service may be cold-starting, so its server errors are retried
+// after a short deep sleep; a local server is retried within the wake
+#ifdef USE_HTTPS
+#define UPLINK_DEFERS_5XX   true
+#else
+#define UPLINK_DEFERS_5XX   false
+#endif
+
 // HTTP client for dashboard
 HTTPClient http;
 
-// WiFi clients for HTTP/HTTPS requests
+// WiFi client for HTTP requests (HTTPS goes through tls_uplink)
 WiFiClient client;
-WiFiClientSecure clientSecure;
 
-// RTC memory variables (survive deep sleep)
-RTC_DATA_ATTR int bootCount = 0;
-RTC_DATA_ATTR bool wifiConfigured = false;
-RTC_DATA_ATTR uint32_t failedUploads = 0;
-RTC_DATA_ATTR float batteryHistory[BATTERY_TREND_SAMPLES] = {0};
-RTC_DATA_ATTR int batteryHistoryIndex = 0;
-RTC_DATA_ATTR bool batteryHistoryFull = false;
-RTC_DATA_ATTR uint32_t lastSleepDuration = SLEEP_DURATION_MINUTES;
+// Fast-reconnect cache: last good AP and IP lease
+struct WiFiCache {
+    bool valid;
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    time_t leaseExpiry;   // System time keeps running through deep sleep
+};
+
+// State kept across deep sleep (RTC arena region, set up first thing in setup())
+struct WakeState {
+    int bootCount;
+    bool wifiConfigured;
+    uint32_t failedUploads;
+    uint32_t lastSleepDuration;
+    bool retryPending;      // Deferred upload retry - the failed reading stays queued in the batch
+    WiFiCache wifiCache;
+};
+static const WakeState initialWakeState = {0, false, 0, SLEEP_DURATION_MINUTES, false, {}};
+WakeState *rtcState = nullptr;
+
+// Connection statistics for this wake (reported with the reading)
+unsigned long wifiConnectMs = 0;
+bool wifiFastConnect = false;
+
+// Why this wake's reading is transmitted (reported with the reading)
+UplinkReason uplinkReason = UPLINK_SCHEDULED;
+
+// Retry policy outcome of the last failed upload in this wake
+RetryDecision uploadRetry = {RETRY_GIVE_UP, 0};
+
+// Wake pipeline: WiFi association runs in its own task while sensors warm up
+SemaphoreHandle_t wifiDoneSemaphore = nullptr;
+volatile bool wifiTaskResult = false;
 
 // Global objects
-Adafruit_AHTX0 aht;
 WiFiManager wifiManager;
 
-// Sensor data structure
-struct SensorData {
-    float temperature;
-    float humidity;
-    float batteryVoltage;
-    int lightLevel;
-    int moistureLevel;
-    float moisturePercent;
-    uint32_t timestamp;
-    bool lowBattery;
-};
-
 // Function declarations
-void setupHardware();
-void configureGPIOForSleep();
-void initializeRadio();
-bool readSensors(SensorData &data);
 bool connectWiFi();
+bool connectUplink();
+void startWiFiTask();
+bool waitForWiFiTask();
+bool connectWiFiFast();
+uint32_t dhcpLeaseSeconds();
+void saveWiFiCache();
 bool uploadData(const SensorData &data, uint32_t sleepMinutes);
+int postPayload(const uint8_t *payload, size_t length, const char *contentType, String &response,
+                UplinkError &error);
+void uploadBacklog(uint32_t sleepMinutes);
+bool uploadEspNow(uint32_t sleepMinutes);
+bool uploadBle();
+int bleReadingCount();
+uint64_t uploadQueuedReadings(const SensorData &data, uint32_t sleepMinutes);
+void dropSentReadings();
+void runDeferredRetry(float batteryVoltage);
+void runBackgroundSample();
+void sendWakeupPing();
+void fillTelemetryHeader(TelemetryHeader &header, uint32_t sleepMinutes);
+size_t buildBinaryPayload(uint8_t *frame, size_t capacity, uint32_t sleepMinutes, int first, int count);
+size_t buildBacklogPayload(uint8_t *block, size_t capacity, const FlashLogRecord *records, int count);
 void displaySetupInformation();
 String fetchDeviceAccessKey();
-void enterDeepSleep(uint64_t sleepTimeUs);
-float readBatteryVoltage();
-void blinkStatusLED(int count, int delayMs = 200);
-void printWakeupReason();
-void updateBatteryHistory(float voltage);
-bool isCharging();
-uint32_t calculateDynamicSleepTime(float batteryVoltage, int lightLevel);
-float calculateMoisturePercent(int moistureReading);
 
 void setup() {
     Serial.begin(SERIAL_BAUD_RATE);
-    delay(1000);
     
-    bootCount++;
+    // Give the USB serial monitor time to attach on first power-up only
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+        delay(1000);
+    }
+    
+    // State the previous wake left in RTC memory, cleared unless it was sealed
+    rtcArenaBegin();
+    rtcState = rtcArenaRegion<WakeState>(RTC_REGION_WAKE, &initialWakeState);
+    
+    // Background sample between full wakes: ADC only, back to sleep
+    // unless a threshold is crossed
+    if (samplerBackgroundWake()) {
+        runBackgroundSample();
+    }
+    
+    rtcState->bootCount++;
+    profilerBegin(rtcState->bootCount);
     
     Serial.println("\n=== PlantBot2 Starting ===");
-    Serial.printf("Boot count: %d\n", bootCount);
-    printWakeupReason();
+    Serial.printf("Boot count: %d\n", rtcState->bootCount);
+    printWakeupReason(rtcState->lastSleepDuration);
     
-    // Setup hardware
+    // Setup hardware (sensor rail is powered, warmup runs in the background)
+    profilerStart(PHASE_SETUP_HARDWARE);
     setupHardware();
+    flashLogBegin();
+    profilerEnd(PHASE_SETUP_HARDWARE);
     
     // Initialize radio stack (needed after deep deinit)
+    profilerStart(PHASE_INIT_RADIO);
     initializeRadio();
+    profilerEnd(PHASE_INIT_RADIO);
     
     // HTTP client setup handled in uploadData()
     
+    // Battery first - it decides whether the radio may be powered at all
+    profilerStart(PHASE_READ_SENSORS);
+    int32_t batteryMv = readBatteryMv();
+    float batteryVoltage = batteryMv / 1000.0f;
+    
+    // Follow-up wake of a deferred retry: the reading is still queued,
+    // so skip the sensors and go straight to the upload
+    if (rtcState->retryPending) {
+        profilerEnd(PHASE_READ_SENSORS);
+        runDeferredRetry(batteryVoltage);
+    }
+    
+    // Store-and-forward: the radio is only powered when the batch is due.
+    // With deadbands this wake's reading is only certain to be queued when
+    // a heartbeat is due; otherwise the decision waits for the sensors.
+    bool powerOnReset = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED);
+    int pendingReadings = (DEADBAND_ENABLED && !powerOnReset && !deadbandHeartbeatDue()) ? 0 : 1;
+    bool uploadDue = batchUploadDue(powerOnReset, pendingReadings);
+    
+    // Circuit breaker: after repeated failed wakes the radio rests for a while
+    // and readings just queue up
+    bool radioAllowed = retryRadioAllowed();
+    if (!radioAllowed) {
+        uploadDue = false;
+    }
+    
+    // Start WiFi association and DHCP while the sensors warm up and are sampled.
+    // Below the critical threshold the radio stays off to prevent brownout.
+    if (uploadDue && batteryVoltage > BATTERY_UVLO_VOLTAGE && batteryVoltage >= BATTERY_CRITICAL_VOLTAGE) {
+        startWiFiTask();
+    }
+    
+    // Trigger the AHT20 conversion now, the result is collected in readSensors()
+    aht.startMeasurement();
+    
     // Read sensors
     SensorData sensorData;
-    bool sensorsOK = readSensors(sensorData);
+    bool sensorsOK = readSensors(sensorData, batteryVoltage);
+    profilerEnd(PHASE_READ_SENSORS);
     
     if (!sensorsOK) {
         Serial.println("❌ Sensor reading failed, entering sleep");
+        waitForWiFiTask(); // Don't tear the radio down mid-association
         blinkStatusLED(3, 100); // Error indication
         enterDeepSleep(SLEEP_DURATION_US);
     }
     
     // Update battery history for trend analysis
-    updateBatteryHistory(sensorData.batteryVoltage);
+    updateBatteryHistory(batteryMv);
+    samplerAdd(sensorData.moisturePercent, sensorData.lightLevel, sensorData.batteryVoltage, true);
+    
+    // Change-driven uplink: a reading within the deadbands of the last
+    // transmitted values is dropped unless the radio is needed anyway
+    uplinkReason = deadbandEvaluate(sensorData);
+    bool thresholdEvent = batchThresholdEvent(sensorData);
+    bool significant = !DEADBAND_ENABLED || uplinkReason != UPLINK_SCHEDULED ||
+                       thresholdEvent || powerOnReset;
+    bool startRadio = radioAllowed && !uploadDue &&
+                      (thresholdEvent || batchUploadDue(powerOnReset, significant ? 1 : 0));
+    
+    // Queue the reading - it is kept across sleeps until an upload succeeds
+    if (significant || uploadDue || startRadio) {
+        deadbandRecord(sensorData);
+        batchAppend(sensorData, isCharging());
+        flashLogAppend(batchAt(batchCount() - 1));
+        Serial.printf("📦 Reading queued (%s)\n", uplinkReasonName(uplinkReason));
+    } else {
+        Serial.println("📉 Reading within deadbands, not transmitted");
+    }
     
     // Calculate dynamic sleep time based on battery and light levels
-    uint32_t sleepMinutes = calculateDynamicSleepTime(sensorData.batteryVoltage, sensorData.lightLevel);
-    lastSleepDuration = sleepMinutes;
+    uint32_t sleepMinutes = calculateDynamicSleepTime(batteryMv, sensorData.lightLevel);
+    rtcState->lastSleepDuration = sleepMinutes;
     
     // Check for UVLO (Under Voltage Lock Out) - critical safety check
     if (sensorData.batteryVoltage <= BATTERY_UVLO_VOLTAGE) {
@@ -144,38 +271,31 @@ void setup() {
         enterDeepSleep(UVLO_SLEEP_HOURS * 60 * 60 * 1000000ULL);
     }
     
-    // Connect to WiFi and upload data
-    if (connectWiFi()) {
-        Serial.println("📡 WiFi connected");
-        
-        if (uploadData(sensorData, sleepMinutes)) {
-            Serial.println("✅ Data uploaded successfully");
-            failedUploads = 0;
-            blinkStatusLED(2, 200); // Success indication
-        } else {
-            Serial.println("❌ Data upload failed");
-            failedUploads++;
-            blinkStatusLED(4, 100); // Upload failed indication
-        }
-        
-        // Disconnect WiFi to save power
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
+    // This reading made the batch due (change, heartbeat or threshold event)
+    if (startRadio) {
+        uploadDue = true;
+        startWiFiTask();
+    }
+    
+    // Join the WiFi task and upload data
+    uint64_t sleepTimeUs = sleepMinutes * 60 * 1000000ULL;
+    if (!uploadDue) {
+        Serial.printf("📦 %d/%d readings queued, radio stays off\n", batchCount(), BATCH_SIZE);
     } else {
-        Serial.println("❌ WiFi connection failed");
-        failedUploads++;
-        blinkStatusLED(6, 100); // WiFi failed indication
+        sleepTimeUs = uploadQueuedReadings(sensorData, sleepMinutes);
     }
     
-    Serial.printf("Failed uploads: %d\n", failedUploads);
-    Serial.printf("💤 Entering deep sleep for %d minutes\n", sleepMinutes);
+    Serial.printf("💤 Entering deep sleep for %d minutes\n", (int)(sleepTimeUs / 60000000ULL));
     Serial.printf("🔋 Battery trend: %s\n", isCharging() ? "Charging" : "Discharging");
     
+    profilerPrint();
+    
     // Configure GPIOs for minimal power consumption
     configureGPIOForSleep();
     
-    // Enter deep sleep with calculated duration
-    enterDeepSleep(sleepMinutes * 60 * 1000000ULL);
+    // Enter deep sleep with calculated duration, in background sample
+    // steps unless a deferred retry is due
+    enterDeepSleep(rtcState->retryPending ? sleepTimeUs : samplerSchedule(sleepTimeUs));
 }
 
 void loop() {
@@ -183,53 +303,6 @@ void loop() {
     delay(1000);
 }
 
-void setupHardware() {
-    Serial.println("🔧 Initializing hardware...");
-    
-    // Configure output pins
-    pinMode(PIN_STATUS_LED, OUTPUT);
-    pinMode(PIN_PUMP_CONTROL, OUTPUT);
-    pinMode(PIN_I2C_POWER, OUTPUT);
-    
-    // Configure input pins
-    pinMode(PIN_BATTERY_READ, INPUT);
-    pinMode(PIN_LIGHT_SENSOR, INPUT);
-    pinMode(PIN_MOISTURE_SENS, INPUT);
-    pinMode(PIN_BOOT_BUTTON, INPUT_PULLUP);
-    
-    // Ensure boot button has strong pull-up
-    gpio_set_pull_mode((gpio_num_t)PIN_BOOT_BUTTON, GPIO_PULLUP_ONLY);
-    pinMode(PIN_USER_GPIO, INPUT_PULLUP);
-    
-    // Set safe initial states
-    digitalWrite(PIN_STATUS_LED, LOW);
-    digitalWrite(PIN_PUMP_CONTROL, LOW);
-    digitalWrite(PIN_I2C_POWER, HIGH); // Power on sensors
-    
-    // Wait for sensor power stabilization
-    delay(SENSOR_WARMUP_MS);
-    
-    // Initialize I2C
-    Wire.begin(PIN_I2C_SDA, PIN_I2C_SCL);
-    Wire.setClock(I2C_FREQUENCY);
-    
-    Serial.println("✅ Hardware initialized");
-}
-
-void initializeRadio() {
-    Serial.println("📡 Initializing radio stack...");
-    
-    // Initialize WiFi stack - ignore errors as it might already be initialized
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    esp_wifi_init(&cfg);
-    
-    // Initialize Bluetooth controller - ignore errors as it might already be initialized  
-    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-    esp_bt_controller_init(&bt_cfg);
-    
-    Serial.println("✅ Radio stack initialized");
-}
-
 void setupInfluxDB() {
     Serial.println("⚡ Setting up InfluxDB...");
     
@@ -240,133 +313,174 @@ void setupInfluxDB() {
     Serial.println("InfluxDB client ready (skipping validation for power efficiency)");
 }
 
-void configureGPIOForSleep() {
-    Serial.println("🔧 Configuring GPIOs for sleep...");
-    
-    // Explicitly deinitialize I2C first to ensure proper shutdown
-    Wire.end();
-    Serial.println("✅ I2C bus deinitialized");
-    
-    // Turn off all outputs to minimize current draw
-    digitalWrite(PIN_STATUS_LED, LOW);
-    digitalWrite(PIN_PUMP_CONTROL, LOW);
-    digitalWrite(PIN_I2C_POWER, LOW); // Power down sensors
-    
-    // Add delay to ensure sensors are properly powered down
-    delay(100);
-    Serial.println("✅ Sensors powered down");
-    
-    // Configure all GPIOs as inputs with pull-ups to prevent floating
-    gpio_config_t io_conf = {};
-    io_conf.intr_type = GPIO_INTR_DISABLE;
-    io_conf.mode = GPIO_MODE_INPUT;
-    io_conf.pin_bit_mask = (1ULL << PIN_STATUS_LED) |
-                          (1ULL << PIN_PUMP_CONTROL) |
-                          (1ULL << PIN_I2C_POWER) |
-                          (1ULL << PIN_USER_GPIO) |
-                          (1ULL << PIN_I2C_SDA) |
-                          (1ULL << PIN_I2C_SCL);
-    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    gpio_config(&io_conf);
-    
-    // Configure ADC pins as inputs with pull-ups (they're already inputs but ensure low power)
-    gpio_config_t adc_conf = {};
-    adc_conf.intr_type = GPIO_INTR_DISABLE;
-    adc_conf.mode = GPIO_MODE_INPUT;
-    adc_conf.pin_bit_mask = (1ULL << PIN_BATTERY_READ) |
-                           (1ULL << PIN_LIGHT_SENSOR) |
-                           (1ULL << PIN_MOISTURE_SENS);
-    adc_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    adc_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    gpio_config(&adc_conf);
-    
-    Serial.println("✅ GPIOs and peripherals configured for minimal power consumption");
-}
-
-bool readSensors(SensorData &data) {
-    Serial.println("📊 Reading sensors...");
-    
-    // Initialize sensor data
-    memset(&data, 0, sizeof(data));
-    data.timestamp = millis();
+uint64_t uploadQueuedReadings(const SensorData &data, uint32_t sleepMinutes) {
+    uint64_t sleepTimeUs = sleepMinutes * 60 * 1000000ULL;
     
-    // Read battery voltage with improved accuracy
-    data.batteryVoltage = readBatteryVoltage();
-    data.lowBattery = (data.batteryVoltage < BATTERY_LOW_VOLTAGE && data.batteryVoltage > BATTERY_UVLO_VOLTAGE);
-    
-    // Read light sensor
-    long lightSum = 0;
-    for (int i = 0; i < 5; i++) {
-        lightSum += analogRead(PIN_LIGHT_SENSOR);
-        delay(10);
-    }
-    data.lightLevel = lightSum / 5;
-    
-    // Read moisture sensor
-    long moistSum = 0;
-    for (int i = 0; i < 5; i++) {
-        moistSum += analogRead(PIN_MOISTURE_SENS);
-        delay(10);
-    }
-    data.moistureLevel = moistSum / 5;
-    data.moisturePercent = calculateMoisturePercent(data.moistureLevel);
-    
-    // Read AHT20 temperature and humidity with retries
-    bool ahtSuccess = false;
-    for (int retry = 0; retry < 3 && !ahtSuccess; retry++) {
-        if (retry > 0) {
-            Serial.printf("AHT20 retry %d/3\n", retry + 1);
-            // Power cycle the sensor on retries
-            digitalWrite(PIN_I2C_POWER, LOW);
-            delay(100);
-            digitalWrite(PIN_I2C_POWER, HIGH);
-            delay(500);
-        }
+    if (waitForWiFiTask()) {
+        Serial.println("📡 WiFi connected");
         
-        if (aht.begin()) {
-            delay(200); // Extended stabilization time
+#if UPLINK_MODE == UPLINK_MODE_ESPNOW
+        bool uploaded = uploadEspNow(sleepMinutes);
+#elif UPLINK_MODE == UPLINK_MODE_BLE
+        bool uploaded = uploadBle();
+#else
+        bool uploaded = uploadData(data, sleepMinutes);
+#endif
+        if (uploaded) {
+            Serial.println("✅ Data uploaded successfully");
+            dropSentReadings();
+            samplerReset();
+            rtcState->failedUploads = 0;
+            blinkStatusLED(2, 200); // Success indication
             
-            sensors_event_t humidity, temp;
-            if (aht.getEvent(&humidity, &temp)) {
-                data.temperature = temp.temperature;
-                data.humidity = humidity.relative_humidity;
-                
-                // Validate readings
-                if (data.temperature >= -20 && data.temperature <= 60 &&
-                    data.humidity >= 0 && data.humidity <= 100) {
-                    ahtSuccess = true;
-                } else {
-                    Serial.println("❌ AHT20 readings out of range");
-                }
-            } else {
-                Serial.println("❌ Failed to read AHT20");
+#if UPLINK_MODE == UPLINK_MODE_WIFI
+            // Readings that missed their upload, while the connection is up
+            if (flashLogBacklog() > 0) {
+                uploadBacklog(sleepMinutes);
             }
+#endif
+        } else if (uploadRetry.action == RETRY_DROP) {
+            // Re-sending would be rejected again and block every later reading
+            Serial.println("🗑️ Readings rejected by the server, dropped");
+            dropSentReadings();
+            blinkStatusLED(4, 100); // Upload failed indication
         } else {
-            Serial.println("❌ AHT20 initialization failed");
+            Serial.println("❌ Data upload failed");
+            rtcState->failedUploads++;
+            blinkStatusLED(4, 100); // Upload failed indication
+            
+            // The server may be cold-starting. Nudge it and retry after a short
+            // deep sleep instead of waiting awake with the radio on.
+            if (uploadRetry.action == RETRY_DEFER) {
+#ifdef USE_HTTPS
+                if (retryLastError() == UPLINK_ERR_HTTP_5XX) {
+                    sendWakeupPing();
+                }
+#endif
+                rtcState->retryPending = true;
+                sleepTimeUs = uploadRetry.delayMs * 1000ULL;
+                Serial.printf("⏰ Retrying in %lu seconds after deep sleep\n",
+                              (unsigned long)(uploadRetry.delayMs / 1000));
+            }
         }
+        
+        // Disconnect WiFi to save power
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+    } else {
+        Serial.println("❌ WiFi connection failed");
+        rtcState->failedUploads++;
+        retryOnFailure(UPLINK_ERR_WIFI, 1);
+        blinkStatusLED(6, 100); // WiFi failed indication
     }
     
-    if (!ahtSuccess) {
-        Serial.println("❌ AHT20 failed after all retries");
-        return false;
+    Serial.printf("Failed uploads: %d\n", rtcState->failedUploads);
+    return sleepTimeUs;
+}
+
+void dropSentReadings() {
+#if UPLINK_MODE == UPLINK_MODE_WIFI && PAYLOAD_FORMAT == PAYLOAD_FORMAT_JSON && BATCH_SIZE == 1
+    // The JSON payload only carries the latest reading without batching,
+    // older queued ones are left to the backlog
+    flashLogBatchDelivered(1);
+    batchClear();
+#elif UPLINK_MODE == UPLINK_MODE_BLE
+    // Only the oldest readings fit the advert, the newer ones stay queued
+    int sent = bleReadingCount();
+    flashLogBatchDelivered(sent, batchCount() - sent);
+    batchDropOldest(sent);
+#else
+    flashLogBatchDelivered(batchCount());
+    batchClear();
+#endif
+}
+
+void runDeferredRetry(float batteryVoltage) {
+    rtcState->retryPending = false;
+    Serial.printf("🔁 Deferred upload retry %d/%d\n", retryDeferrals(), RETRY_MAX_DEFERRALS);
+    
+    // The newest queued reading stands in for this wake's reading
+    uint64_t sleepTimeUs = rtcState->lastSleepDuration * 60 * 1000000ULL;
+    if (batchCount() > 0 && batteryVoltage > BATTERY_UVLO_VOLTAGE && batteryVoltage >= BATTERY_CRITICAL_VOLTAGE &&
+        retryRadioAllowed()) {
+        SensorData sensorData;
+        batchToSensorData(batchAt(batchCount() - 1), sensorData);
+        startWiFiTask();
+        sleepTimeUs = uploadQueuedReadings(sensorData, rtcState->lastSleepDuration);
+    } else {
+        Serial.println("🚫 Retry skipped, nothing queued, battery too low or radio resting");
+    }
+    
+    profilerPrint();
+    configureGPIOForSleep();
+    enterDeepSleep(rtcState->retryPending ? sleepTimeUs : samplerSchedule(sleepTimeUs));
+}
+
+void runBackgroundSample() {
+    // Only the sensor rail and the ADC are touched
+    pinMode(PIN_I2C_POWER, OUTPUT);
+    digitalWrite(PIN_I2C_POWER, HIGH);
+    delay(SAMPLE_WARMUP_MS);
+    
+    AdcReadings adc;
+    bool sampled = sampleAdcChannels(adc) && adc.batteryValid > 0;
+    digitalWrite(PIN_I2C_POWER, LOW);
+    
+    if (sampled) {
+        float batteryVoltage = batteryMvFromAdc(adc.batterySum, adc.batteryValid) / 1000.0f;
+        float moisturePercent = calculateMoisturePercent(adc.moisture);
+        if (samplerAdd(moisturePercent, adc.light, batteryVoltage, false)) {
+            Serial.printf("🌱 Background sample crossed a threshold (moisture %.1f%%, %.2fV), full wake\n",
+                          moisturePercent, batteryVoltage);
+            deinitAdcContinuous();
+            return;
+        }
     }
     
-    Serial.println("✅ All sensors read successfully");
-    return true;
+    configureGPIOForSampleSleep();
+    esp_sleep_enable_timer_wakeup(samplerNextSleepUs());
+    rtcArenaSeal();
+    esp_deep_sleep_start();
 }
 
+#ifdef USE_HTTPS
+void sendWakeupPing() {
+    // A bodiless request is enough to make the platform start the service;
+    // the response isn't awaited
+    IPAddress serverIP;
+    if (dnsResolve(SERVER_HOST, serverIP) && tlsConnect(SERVER_HOST, serverIP, SERVER_PORT) == TLS_OK) {
+        tlsPing(SERVER_HOST, WAKEUP_PING_PATH);
+        Serial.println("🏓 Wake-up ping sent");
+    }
+    tlsClose();
+}
+#endif
+
 bool connectWiFi() {
     Serial.println("📡 Connecting to WiFi...");
     
     // Disable WiFi sleep mode for faster connection
     WiFi.setSleep(false);
     
-    // Try to connect with stored credentials first
     WiFi.mode(WIFI_STA);
+    unsigned long startTime = millis();
+    wifiFastConnect = false;
+    
+    // Try the cached AP and IP lease first - skips the channel scan and DHCP
+    if (connectWiFiFast()) {
+        wifiConnectMs = millis() - startTime;
+        wifiFastConnect = true;
+        Serial.printf("⚡ Fast reconnect to %s in %lu ms\n", WiFi.SSID().c_str(), wifiConnectMs);
+        Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
+        
+        // WiFi connected successfully
+        
+        return true;
+    }
+    
+    // Try to connect with stored credentials (full scan + DHCP)
     WiFi.begin();
     
-    unsigned long startTime = millis();
     while (WiFi.status() != WL_CONNECTED && 
            millis() - startTime < WIFI_TIMEOUT_MS) {
         delay(500);
@@ -374,10 +488,13 @@ bool connectWiFi() {
     }
     
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.printf("\n✅ Connected to %s\n", WiFi.SSID().c_str());
+        wifiConnectMs = millis() - startTime;
+        Serial.printf("\n✅ Connected to %s in %lu ms\n", WiFi.SSID().c_str(), wifiConnectMs);
         Serial.printf("IP: %s\n", WiFi.localIP().toString().c_str());
         Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
         
+        saveWiFiCache();
+        
         // WiFi connected successfully
         
         return true;
@@ -386,7 +503,7 @@ bool connectWiFi() {
     Serial.println("\n❌ Stored credentials failed");
     
     // If this is the first boot or after many failures, start config portal
-    if (bootCount <= 3 || failedUploads > 10) {
+    if (rtcState->bootCount <= 3 || rtcState->failedUploads > 10) {
         Serial.println("🔧 Starting WiFi configuration portal...");
         
         // Add custom parameters to show device info
@@ -417,7 +534,9 @@ bool connectWiFi() {
         
         if (wifiManager.autoConnect("PlantBot2-Setup")) {
             Serial.println("✅ WiFi configured via portal");
-            wifiConfigured = true;
+            rtcState->wifiConfigured = true;
+            wifiConnectMs = millis() - startTime;
+            saveWiFiCache();
             
             // Display setup information with access key and dashboard URL
             displaySetupInformation();
@@ -432,9 +551,141 @@ bool connectWiFi() {
     return false;
 }
 
+bool connectUplink() {
+    // ESP-NOW and BLE broadcast have no access point to join
+#if UPLINK_MODE == UPLINK_MODE_ESPNOW
+    return espnowBegin();
+#elif UPLINK_MODE == UPLINK_MODE_BLE
+    return bleBegin();
+#else
+    return connectWiFi();
+#endif
+}
+
+void wifiTask(void *) {
+    profilerStart(PHASE_CONNECT_WIFI);
+    wifiTaskResult = connectUplink();
+    profilerEnd(PHASE_CONNECT_WIFI);
+    xSemaphoreGive(wifiDoneSemaphore);
+    vTaskDelete(nullptr);
+}
+
+void startWiFiTask() {
+    wifiDoneSemaphore = xSemaphoreCreateBinary();
+    wifiTaskResult = false;
+    
+#if UPLINK_MODE == UPLINK_MODE_ESPNOW
+    // The session's RTC region is claimed here, the arena is main task only
+    espnowPrepare();
+#endif
+    
+    if (xTaskCreate(wifiTask, "wifi", WIFI_TASK_STACK_SIZE, nullptr,
+                    WIFI_TASK_PRIORITY, nullptr) != pdPASS) {
+        // Out of memory - fall back to the sequential path
+        Serial.println("❌ Failed to start WiFi task, connecting inline");
+        wifiTaskResult = connectUplink();
+        xSemaphoreGive(wifiDoneSemaphore);
+    }
+}
+
+bool waitForWiFiTask() {
+    if (wifiDoneSemaphore == nullptr) {
+        return false; // Radio was never started this wake
+    }
+    
+    xSemaphoreTake(wifiDoneSemaphore, portMAX_DELAY);
+    vSemaphoreDelete(wifiDoneSemaphore);
+    wifiDoneSemaphore = nullptr;
+    
+    return wifiTaskResult;
+}
+
+bool connectWiFiFast() {
+    WiFiCache &cache = rtcState->wifiCache;
+    if (!cache.valid) {
+        return false;
+    }
+    
+    // Don't reuse an address the DHCP server may have handed out again
+    if (time(nullptr) >= cache.leaseExpiry) {
+        Serial.println("IP lease cache expired, using DHCP");
+        cache.valid = false;
+        return false;
+    }
+    
+    // Credentials stay in NVS, only the AP details are cached in RTC memory
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+        return false;
+    }
+    
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway),
+                IPAddress(cache.subnet), IPAddress(cache.dns));
+    WiFi.begin((const char *)conf.sta.ssid, (const char *)conf.sta.password,
+               cache.channel, cache.bssid, true);
+    
+    unsigned long startTime = millis();
+    while (WiFi.status() != WL_CONNECTED &&
+           millis() - startTime < WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        delay(10);
+    }
+    
+    if (WiFi.status() == WL_CONNECTED) {
+        return true;
+    }
+    
+    // AP moved or lease no longer valid - drop cache and fall back to full scan
+    Serial.println("⚠️ Fast reconnect failed, falling back to full scan");
+    cache.valid = false;
+    WiFi.disconnect();
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Re-enable DHCP
+    return false;
+}
+
+// Lease the DHCP server granted at the last bind, 0 when unknown
+uint32_t dhcpLeaseSeconds() {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif *lwipNetif = netif != nullptr ? (struct netif *)esp_netif_get_netif_impl(netif) : nullptr;
+    struct dhcp *dhcp = lwipNetif != nullptr ? netif_dhcp_data(lwipNetif) : nullptr;
+    return dhcp != nullptr ? dhcp->offered_t0_lease : 0;
+}
+
+void saveWiFiCache() {
+    WiFiCache &cache = rtcState->wifiCache;
+    
+    // The address is reused without renewing it, so only until DHCP would
+    // have renewed it (half the lease)
+    uint32_t leaseS = dhcpLeaseSeconds();
+    if (leaseS < 2) {
+        Serial.println("No DHCP lease known, WiFi cache not saved");
+        cache.valid = false;
+        return;
+    }
+    
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = WiFi.channel();
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+    cache.leaseExpiry = time(nullptr) + min(leaseS / 2, (uint32_t)WIFI_LEASE_CACHE_S);
+    cache.valid = true;
+    
+    Serial.printf("WiFi cache saved (channel %d, lease %lu s)\n", cache.channel, (unsigned long)leaseS);
+}
+
 bool uploadData(const SensorData &data, uint32_t sleepMinutes) {
     Serial.println("📤 Uploading data to dashboard...");
     
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BINARY
+    // Compact binary frame carrying every queued reading (this one included)
+    static uint8_t frame[TELEMETRY_FRAME_SIZE(BATCH_BUFFER_SIZE)];
+    size_t payloadLength = buildBinaryPayload(frame, sizeof(frame), sleepMinutes, 0, batchCount());
+    const uint8_t *payload = frame;
+    const char *contentType = TELEMETRY_CONTENT_TYPE;
+    
+    Serial.printf("Binary payload: %u bytes, %d readings\n", (unsigned)payloadLength, batchCount());
+#else
     // Create JSON payload
     JsonDocument doc;
     
@@ -447,296 +698,431 @@ bool uploadData(const SensorData &data, uint32_t sleepMinutes) {
     doc["light_level"] = data.lightLevel;
     doc["moisture_level"] = data.moistureLevel;
     doc["moisture_percent"] = data.moisturePercent;
-    doc["boot_count"] = bootCount;
+    doc["boot_count"] = rtcState->bootCount;
     doc["rssi"] = WiFi.RSSI();
     doc["low_battery"] = data.lowBattery;
     doc["sleep_minutes"] = sleepMinutes;
     doc["charging"] = isCharging();
+    doc["wifi_connect_ms"] = wifiConnectMs;
+    doc["wifi_fast_connect"] = wifiFastConnect;
+    doc["uplink_reason"] = uplinkReasonName(uplinkReason);
+    doc["upload_retry"] = retryDeferrals();
+    doc["failed_wakes"] = retryConsecutiveFailures();
+    doc["last_error"] = uplinkErrorName(retryLastError());
+#ifdef USE_HTTPS
+    // Handshake timing from the most recent uploads (this one hasn't connected yet)
+    const TlsStats &tls = tlsStats();
+    doc["tls_resumed"] = tls.lastResumed;
+    doc["tls_handshake_ms"] = tls.lastHandshakeMs;
+    doc["tls_full_ms"] = tls.fullHandshakeMs;
+    doc["tls_resumed_ms"] = tls.resumedHandshakeMs;
+    doc["tls_verify_us"] = tls.verifyUs;
+#endif
+    
+    // Wake-cycle phase timing (sleep preparation is from the previous cycle)
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        doc[profilerFieldName((WakePhase)i)] = profilerPhaseUs((WakePhase)i) / 1000.0;
+    }
+    const WakeProfile *previousCycle = profilerHistory(0);
+    if (previousCycle) {
+        doc["t_prev_awake_ms"] = previousCycle->awakeUs / 1000.0;
+    }
+    
+#if SAMPLE_INTERVAL_MINUTES > 0
+    // Background samples since the last upload
+    SamplerSummary samples;
+    samplerSummary(samples);
+    doc["sample_count"] = samples.count;
+    doc["moisture_min"] = samples.moistureMin;
+    doc["moisture_max"] = samples.moistureMax;
+    doc["moisture_mean"] = samples.moistureMean;
+    doc["light_min"] = samples.lightMin;
+    doc["light_max"] = samples.lightMax;
+    doc["light_mean"] = samples.lightMean;
+    doc["battery_min"] = samples.batteryMin;
+    doc["light_integral"] = samples.lightIntegral;
+    doc["light_daily_integral"] = samples.lightDailyIntegral;
+#endif
+    
+#if BATCH_SIZE > 1
+    // All queued readings (oldest first, including this one). The top-level
+    // fields above still describe the latest reading for older servers.
+    JsonArray readings = doc["readings"].to<JsonArray>();
+    for (int i = 0; i < batchCount(); i++) {
+        const BatchedReading &queued = batchAt(i);
+        SensorData reading;
+        batchToSensorData(queued, reading);
+        
+        JsonObject entry = readings.add<JsonObject>();
+        entry["age_s"] = batchAgeS(queued);
+        entry["temperature"] = reading.temperature;
+        entry["humidity"] = reading.humidity;
+        entry["battery_voltage"] = reading.batteryVoltage;
+        entry["light_level"] = reading.lightLevel;
+        entry["moisture_level"] = reading.moistureLevel;
+        entry["moisture_percent"] = reading.moisturePercent;
+        entry["low_battery"] = reading.lowBattery;
+        entry["charging"] = (queued.flags & BATCH_FLAG_CHARGING) != 0;
+    }
+#endif
     
     String jsonString;
     serializeJson(doc, jsonString);
     
     Serial.printf("JSON payload: %s\n", jsonString.c_str());
     
-    // Smart retry logic for cloud services with cold-start delays
-    for (int attempt = 1; attempt <= MAX_RETRIES; attempt++) {
-        Serial.printf("Upload attempt %d/%d\n", attempt, MAX_RETRIES);
-        
-#ifdef USE_HTTPS
-        // Use HTTPS for cloud deployment
-        clientSecure.setInsecure(); // Skip certificate validation for simplicity
-        http.begin(clientSecure, SERVER_HOST, SERVER_PORT, DATA_ENDPOINT);
-        http.setTimeout(HTTP_TIMEOUT_MS); // Normal timeout
-#else
-        // Use HTTP for local deployment
-        http.begin(client, SERVER_HOST, SERVER_PORT, DATA_ENDPOINT);
+    const uint8_t *payload = (const uint8_t *)jsonString.c_str();
+    size_t payloadLength = jsonString.length();
+    const char *contentType = "application/json";
 #endif
-        http.addHeader("Content-Type", "application/json");
-        
-        int httpResponseCode = http.POST(jsonString);
+    
+    // Attempts within this wake follow the retry policy; 5xx errors are
+    // deferred to a follow-up wake where the policy allows it
+    for (int attempt = 1; ; attempt++) {
+        Serial.printf("Upload attempt %d\n", attempt);
+        String response;
+        UplinkError error;
+        int httpResponseCode = postPayload(payload, payloadLength, contentType, response, error);
         
-        if (httpResponseCode == 200) {
-            Serial.println("✅ Data uploaded successfully");
-            http.end();
-            return true;
-        } else {
+        if (error == UPLINK_OK) {
+            if (httpResponseCode == 200) {
+                Serial.println("✅ Data uploaded successfully");
+                retryOnSuccess();
+                return true;
+            }
+            
             Serial.printf("❌ HTTP request failed: %d\n", httpResponseCode);
             if (httpResponseCode > 0) {
-                String response = http.getString();
                 Serial.printf("Response: %s\n", response.c_str());
             }
-            
-            http.end();
-            
-            // If first attempt failed and we have one more try, sleep to let cloud service wake up
-            if (attempt == 1 && attempt < MAX_RETRIES) {
-#ifdef USE_HTTPS
-                Serial.printf("💤 Sleeping %d seconds for cloud service wake-up...\n", CLOUD_WAKEUP_DELAY_MS / 1000);
-                delay(CLOUD_WAKEUP_DELAY_MS);
-#else
-                Serial.println("⏳ Waiting 2 seconds before retry...");
-                delay(2000); // Shorter delay for local deployments
-#endif
-            }
+            // No response after connecting counts as the server being unavailable
+            error = (httpResponseCode >= 400 && httpResponseCode < 500) ? UPLINK_ERR_HTTP_4XX
+                                                                        : UPLINK_ERR_HTTP_5XX;
+        }
+        
+        uploadRetry = retryOnFailure(error, attempt, UPLINK_DEFERS_5XX);
+        if (uploadRetry.action != RETRY_NOW) {
+            return false;
         }
+        delay(uploadRetry.delayMs);
     }
-    
-    return false;
 }
 
-void enterDeepSleep(uint64_t sleepTimeUs) {
-    uint32_t sleepMinutes = sleepTimeUs / 60000000ULL;
-    Serial.printf("💤 Entering deep sleep for %d minutes\n", sleepMinutes);
-    
-    // Complete WiFi shutdown for maximum power savings
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
-    if (esp_wifi_stop() == ESP_OK) {
-        Serial.println("✅ WiFi stopped");
-    }
-    if (esp_wifi_deinit() == ESP_OK) {
-        Serial.println("✅ WiFi deinitialized");
+int postPayload(const uint8_t *payload, size_t length, const char *contentType, String &response,
+                UplinkError &error) {
+    error = UPLINK_OK;
+    
+    // Cached address while its TTL lasts, the lookup is timed on its own
+    profilerStart(PHASE_DNS);
+    IPAddress serverIP;
+    bool resolved = dnsResolve(SERVER_HOST, serverIP);
+    profilerEnd(PHASE_DNS);
+    if (!resolved) {
+        error = UPLINK_ERR_DNS;
     }
     
-    // Complete Bluetooth shutdown
-    if (esp_bt_controller_disable() == ESP_OK) {
-        Serial.println("✅ Bluetooth disabled");
-    }
-    if (esp_bt_controller_deinit() == ESP_OK) {
-        Serial.println("✅ Bluetooth deinitialized");
+    int httpResponseCode = -1;
+#ifdef USE_HTTPS
+    // Use HTTPS for cloud deployment - TLS session is resumed across wakes,
+    // SNI and Host still carry SERVER_HOST
+    if (resolved) {
+        profilerStart(PHASE_TLS);
+        TlsResult tls = tlsConnect(SERVER_HOST, serverIP, SERVER_PORT);
+        profilerEnd(PHASE_TLS);
+        
+        if (tls == TLS_OK) {
+            profilerStart(PHASE_HTTP_POST);
+            httpResponseCode = tlsPost(SERVER_HOST, DATA_ENDPOINT, contentType, payload, length, response);
+            profilerEnd(PHASE_HTTP_POST);
+        } else {
+            error = (tls == TLS_ERR_TCP) ? UPLINK_ERR_TCP : UPLINK_ERR_TLS;
+        }
+        tlsClose();
     }
-    
-    // Additional power management - disable unnecessary peripherals
-    esp_wifi_set_ps(WIFI_PS_NONE);
-    
-    // Configure wake up source (timer)
-    esp_sleep_enable_timer_wakeup(sleepTimeUs);
-    
-    // Note: GPIO9 is not an RTC GPIO on ESP32-C6, so external wakeup is not available
-    // Only timer wakeup is configured
-    
-    Serial.println("Going to sleep now...");
-    Serial.flush();
-    delay(100); // Ensure serial output completes
-    
-    // Enter deep sleep
-    esp_deep_sleep_start();
-}
-
-float readBatteryVoltage() {
-    // Take multiple readings for accuracy with improved averaging
-    long adcSum = 0;
-    int validReadings = 0;
-    
-    // Take more samples and filter out obvious outliers
-    for (int i = 0; i < BATTERY_ADC_SAMPLES; i++) {
-        int reading = analogRead(PIN_BATTERY_READ);
-        // Basic outlier filtering - reject readings at extremes
-        if (reading > 50 && reading < 4000) {
-            adcSum += reading;
-            validReadings++;
+#else
+    // Use HTTP for local deployment, HTTPClient reuses the open connection
+    if (resolved) {
+        profilerStart(PHASE_TLS);
+        bool connected = client.connect(serverIP, SERVER_PORT);
+        profilerEnd(PHASE_TLS);
+        
+        if (connected) {
+            http.begin(client, SERVER_HOST, SERVER_PORT, DATA_ENDPOINT);
+            http.addHeader("Content-Type", contentType);
+            
+            profilerStart(PHASE_HTTP_POST);
+            httpResponseCode = http.POST((uint8_t *)payload, length);
+            profilerEnd(PHASE_HTTP_POST);
+            
+            if (httpResponseCode > 0) {
+                response = http.getString();
+            }
+            http.end();
+        } else {
+            error = UPLINK_ERR_TCP;
         }
-        delay(10); // Longer delay for more stable readings
     }
+#endif
     
-    if (validReadings == 0) {
-        Serial.println("❌ No valid battery readings!");
-        return 0.0;
+    // The server may have moved - resolve again on the next attempt
+    if (error == UPLINK_ERR_TCP || error == UPLINK_ERR_TLS) {
+        dnsInvalidate(SERVER_HOST);
     }
-    
-    float adcAverage = adcSum / (float)validReadings;
-    
-    // Linear calibration: voltage = m * adc + c
-    float voltage = BATTERY_CALIB_SLOPE * adcAverage + BATTERY_CALIB_INTERCEPT;
-    
-    Serial.printf("Battery ADC: %.1f (from %d samples), Voltage: %.2fV\n", 
-                  adcAverage, validReadings, voltage);
-    
-    return voltage;
+    return httpResponseCode;
 }
 
-void blinkStatusLED(int count, int delayMs) {
-    for (int i = 0; i < count; i++) {
-        digitalWrite(PIN_STATUS_LED, HIGH);
-        delay(delayMs);
-        digitalWrite(PIN_STATUS_LED, LOW);
-        delay(delayMs);
+void uploadBacklog(uint32_t sleepMinutes) {
+    // Logged readings that never reached the server, oldest first, in large
+    // requests. Single attempts outside the retry policy: whatever is left
+    // goes out after the next successful upload.
+    static FlashLogRecord records[FLASH_LOG_UPLOAD_BATCH];
+    Serial.printf("🗂️ Uploading %lu backlog readings from flash...\n", (unsigned long)flashLogBacklog());
+    
+    for (int upload = 0; upload < FLASH_LOG_MAX_UPLOADS; upload++) {
+        int count = flashLogReadBacklog(records, FLASH_LOG_UPLOAD_BATCH);
+        if (count == 0) {
+            break;
+        }
+        
+#if PAYLOAD_FORMAT == PAYLOAD_FORMAT_BINARY
+        static uint8_t block[SERIES_MAX_SIZE(FLASH_LOG_UPLOAD_BATCH)];
+        size_t payloadLength = buildBacklogPayload(block, sizeof(block), records, count);
+        const uint8_t *payload = block;
+        const char *contentType = SERIES_CONTENT_TYPE;
+        if (payloadLength == 0) {
+            Serial.println("❌ Backlog readings don't fit a series block");
+            return;
+        }
+#else
+        JsonDocument doc;
+        doc["device_id"] = WiFi.macAddress();
+        doc["boot_count"] = rtcState->bootCount;
+        doc["sleep_minutes"] = sleepMinutes;
+        doc["backlog"] = true;
+        JsonArray readings = doc["readings"].to<JsonArray>();
+        for (int i = 0; i < count; i++) {
+            const FlashLogRecord &record = records[i];
+            JsonObject entry = readings.add<JsonObject>();
+            entry["seq"] = record.sequence;
+            entry["power_cycle"] = record.powerCycle;
+            // Unknown for readings from before the last power-on reset
+            uint32_t ageS = flashLogAgeS(record);
+            if (ageS != UINT32_MAX) {
+                entry["age_s"] = ageS;
+            } else {
+                entry["age_s"] = nullptr;
+            }
+            if (record.temperatureCenti != BATCH_TEMPERATURE_NONE) {
+                entry["temperature"] = record.temperatureCenti / 100.0f;
+            } else {
+                entry["temperature"] = nullptr;
+            }
+            if (record.humidityCenti != BATCH_CENTI_NONE) {
+                entry["humidity"] = record.humidityCenti / 100.0f;
+            } else {
+                entry["humidity"] = nullptr;
+            }
+            entry["battery_voltage"] = record.batteryMv / 1000.0f;
+            entry["light_level"] = record.lightLevel;
+            entry["moisture_level"] = record.moistureLevel;
+            if (record.moistureCenti != BATCH_CENTI_NONE) {
+                entry["moisture_percent"] = record.moistureCenti / 100.0f;
+            } else {
+                entry["moisture_percent"] = nullptr;
+            }
+            entry["low_battery"] = (record.flags & BATCH_FLAG_LOW_BATTERY) != 0;
+            entry["charging"] = (record.flags & BATCH_FLAG_CHARGING) != 0;
+        }
+        
+        String jsonString;
+        serializeJson(doc, jsonString);
+        const uint8_t *payload = (const uint8_t *)jsonString.c_str();
+        size_t payloadLength = jsonString.length();
+        const char *contentType = "application/json";
+#endif
+        
+        String response;
+        UplinkError error;
+        int httpResponseCode = postPayload(payload, payloadLength, contentType, response, error);
+        if (error == UPLINK_OK && httpResponseCode >= 400 && httpResponseCode < 500) {
+            // Rejected for good - skip these rather than re-send them every wake
+            flashLogBacklogDelivered(count);
+            Serial.printf("🗑️ %d backlog readings rejected by the server (%d), skipped\n", count,
+                          httpResponseCode);
+            continue;
+        }
+        if (error != UPLINK_OK || httpResponseCode != 200) {
+            Serial.printf("❌ Backlog upload failed: %d, %lu readings left\n", httpResponseCode,
+                          (unsigned long)flashLogBacklog());
+            return;
+        }
+        flashLogBacklogDelivered(count);
+        Serial.printf("🗂️ %d backlog readings delivered (seq %lu), %lu left\n", count,
+                      (unsigned long)records[0].sequence, (unsigned long)flashLogBacklog());
     }
 }
 
-void printWakeupReason() {
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+#if UPLINK_MODE == UPLINK_MODE_ESPNOW
+bool uploadEspNow(uint32_t sleepMinutes) {
+    // The queue goes out in frames that fit one ESP-NOW packet. Each frame
+    // carries the sequence number of its first reading so the gateway drops
+    // readings it already has when a frame is re-sent.
+    Serial.printf("📤 Sending %d readings to the gateway...\n", batchCount());
+    
+    uint8_t frame[TELEMETRY_FRAME_SIZE(ESPNOW_MAX_READINGS)];
+    uint32_t firstSequence = batchFirstSequence();
+    bool delivered = true;
+    
+    profilerStart(PHASE_HTTP_POST);
+    for (int first = 0; first < batchCount() && delivered; first += ESPNOW_MAX_READINGS) {
+        int count = min(batchCount() - first, ESPNOW_MAX_READINGS);
+        size_t length = buildBinaryPayload(frame, sizeof(frame), sleepMinutes, first, count);
+        delivered = length > 0 && espnowSend(frame, length, firstSequence + first);
+    }
+    profilerEnd(PHASE_HTTP_POST);
+    espnowEnd();
     
-    switch(wakeup_reason) {
-        case ESP_SLEEP_WAKEUP_EXT1:
-            Serial.println("🔘 Wakeup: External signal (BOOT button)");
-            break;
-        case ESP_SLEEP_WAKEUP_TIMER:
-            Serial.printf("⏰ Wakeup: Timer (slept %d minutes)\n", lastSleepDuration);
-            break;
-        case ESP_SLEEP_WAKEUP_UNDEFINED:
-        default:
-            Serial.println("🔄 Wakeup: Power on reset");
-            break;
+    if (delivered) {
+        retryOnSuccess();
+    } else {
+        // The gateway is out of range or down - keep the readings for the next wake
+        uploadRetry = retryOnFailure(UPLINK_ERR_WIFI, 1);
     }
+    return delivered;
 }
+#endif
 
-void updateBatteryHistory(float voltage) {
-    // Read current ADC for debugging
-    float currentADC = analogRead(PIN_BATTERY_READ);
-    
-    batteryHistory[batteryHistoryIndex] = voltage;
-    batteryHistoryIndex = (batteryHistoryIndex + 1) % BATTERY_TREND_SAMPLES;
-    
-    if (batteryHistoryIndex == 0) {
-        batteryHistoryFull = true;
-    }
-    
-    Serial.printf("ADC: %.0f, Battery history updated: %.2fV (index %d)\n", currentADC, voltage, batteryHistoryIndex);
+#if UPLINK_MODE == UPLINK_MODE_BLE
+int bleReadingCount() {
+    return min(batchCount(), BLE_MAX_READINGS);
 }
 
-bool isCharging() {
-    if (!batteryHistoryFull && batteryHistoryIndex < 3) {
-        return false; // Need at least 3 samples for reliable trend
+bool uploadBle() {
+    // Nothing acknowledges a broadcast, so the readings go out once and are
+    // marked delivered. A batch grown past one advert (after failed wakes)
+    // is sent oldest first over the following wakes.
+    static_assert(BATCH_SIZE <= BLE_MAX_READINGS, "BLE uplink needs BATCH_SIZE <= BLE_MAX_READINGS");
+    int count = bleReadingCount();
+    Serial.printf("📤 Broadcasting %d of %d readings...\n", count, batchCount());
+    
+    BleAdvertHeader header = {};
+    header.sequence = batchFirstSequence() + count - 1;
+    header.readingCount = count;
+    
+    BleAdvertReading readings[BLE_MAX_READINGS];
+    for (int i = 0; i < count; i++) {
+        const BatchedReading &queued = batchAt(count - 1 - i);
+        readings[i].ageMinutes = min(batchAgeS(queued) / 60, (uint32_t)65535);
+        readings[i].temperatureCenti = queued.temperatureCenti;
+        readings[i].humidityCenti = queued.humidityCenti;
+        readings[i].moistureCenti = queued.moistureCenti;
+        readings[i].lightLevel = queued.lightLevel;
+        readings[i].batteryMv = queued.batteryMv;
+        if (i == 0) {
+            header.flags |= ((queued.flags & BATCH_FLAG_CHARGING) ? BLE_ADVERT_FLAG_CHARGING : 0) |
+                            ((queued.flags & BATCH_FLAG_LOW_BATTERY) ? BLE_ADVERT_FLAG_LOW_BATTERY : 0);
+        }
     }
     
-    int samples = batteryHistoryFull ? BATTERY_TREND_SAMPLES : batteryHistoryIndex;
-    float currentVoltage = batteryHistory[(batteryHistoryIndex - 1 + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES];
+    uint8_t advert[2 + BLE_ADVERT_DATA_SIZE(BLE_MAX_READINGS, true)];
+#ifdef BLE_DEVICE_KEY
+    static const uint8_t deviceKey[BLE_ADVERT_KEY_SIZE] = BLE_DEVICE_KEY;
+    header.flags |= BLE_ADVERT_FLAG_AUTH;
+    size_t length = bleAdvertEncode(header, readings, advert, sizeof(advert));
+    bool encoded = length > 0 && bleAdvertSign(deviceKey, advert, length);
+#else
+    size_t length = bleAdvertEncode(header, readings, advert, sizeof(advert));
+    bool encoded = length > 0;
+#endif
     
-    // Calculate recent trend (last 3 readings for quick response)
-    float recentTrend = 0;
-    int recentSamples = min(3, samples - 1);
-    for (int i = 1; i <= recentSamples; i++) {
-        int currentIdx = (batteryHistoryIndex - 1 - (i-1) + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        int prevIdx = (batteryHistoryIndex - 1 - i + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        recentTrend += batteryHistory[currentIdx] - batteryHistory[prevIdx];
-    }
-    recentTrend /= recentSamples;
+    profilerStart(PHASE_HTTP_POST);
+    bool sent = encoded && bleBroadcast(advert, length);
+    profilerEnd(PHASE_HTTP_POST);
+    bleEnd();
     
-    // Calculate overall trend for stability check
-    float overallTrend = 0;
-    for (int i = 1; i < samples; i++) {
-        int currentIdx = (batteryHistoryIndex - 1 - i + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        int prevIdx = (batteryHistoryIndex - 2 - i + BATTERY_TREND_SAMPLES) % BATTERY_TREND_SAMPLES;
-        overallTrend += batteryHistory[currentIdx] - batteryHistory[prevIdx];
+    if (sent) {
+        retryOnSuccess();
+    } else {
+        uploadRetry = retryOnFailure(UPLINK_ERR_WIFI, 1);
     }
-    overallTrend /= (samples - 1);
-    
-    // Improved charging detection logic
-    bool voltageRising = recentTrend > 0.015; // Recent upward trend
-    bool stableRise = overallTrend > 0.005;   // Overall stable rise
-    bool voltageInChargingRange = currentVoltage > 3.8; // Minimum voltage for charging
-    bool highVoltage = currentVoltage > 4.1; // High voltage indicates charging
-    
-    // Charging if recent rise OR high voltage with stable trend
-    bool charging = (voltageRising && stableRise && voltageInChargingRange) || 
-                   (highVoltage && overallTrend > -0.01);
-    
-    Serial.printf("Battery trends - Recent: %.3fV, Overall: %.3fV, Current: %.2fV, Charging: %s\n", 
-                  recentTrend, overallTrend, currentVoltage, charging ? "Yes" : "No");
-    
-    return charging;
+    return sent;
 }
+#endif
 
-uint32_t calculateDynamicSleepTime(float batteryVoltage, int lightLevel) {
-    uint32_t sleepMinutes = NORMAL_SLEEP_MINUTES;
-    
-    // UVLO check - should not reach here but safety first
-    if (batteryVoltage <= BATTERY_UVLO_VOLTAGE) {
-        return UVLO_SLEEP_MINUTES;
-    }
-    
-    // Critical battery check
-    if (batteryVoltage <= BATTERY_CRITICAL_VOLTAGE) {
-        Serial.printf("🔋 Critical battery (%.2fV): 24hr sleep\n", batteryVoltage);
-        return CRITICAL_SLEEP_MINUTES;
-    }
-    
-    // Enhanced charging detection with multiple indicators
-    bool highLight = (lightLevel > CHARGING_LIGHT_THRESHOLD);
-    bool chargingDetected = isCharging();
-    bool voltageIndicatesCharging = (batteryVoltage > CHARGING_DETECT_VOLTAGE);
-    
-    // Primary: Voltage trend indicates charging
-    // Secondary: High light + reasonable voltage (backup indicator)
-    // Tertiary: High voltage alone (simple fallback)
-    bool chargingConditions = chargingDetected || 
-                             (highLight && batteryVoltage > 3.9) ||
-                             (voltageIndicatesCharging && batteryVoltage > 4.1);
-    
-    if (chargingConditions) {
-        // Charging conditions: use minimum sleep time
-        sleepMinutes = MIN_SLEEP_MINUTES;
-        String reason = chargingDetected ? "voltage trend" : 
-                       (highLight && batteryVoltage > 3.9) ? "light + voltage" : 
-                       "high voltage";
-        Serial.printf("🔋 Charging detected via %s (%.2fV, light=%d): minimum sleep\n", 
-                      reason.c_str(), batteryVoltage, lightLevel);
-    } else if (batteryVoltage < BATTERY_LOW_VOLTAGE) {
-        // Linear scaling from 2hrs (4.2V) to 6hrs (3.7V)
-        // batteryVoltage ranges from 3.7V (low) to 4.2V (high)
-        float voltageRange = BATTERY_MAX_VOLTAGE - BATTERY_LOW_VOLTAGE; // 4.2 - 3.7 = 0.5V
-        float voltageRatio = (batteryVoltage - BATTERY_LOW_VOLTAGE) / voltageRange;
-        voltageRatio = max(0.0f, min(1.0f, voltageRatio)); // Clamp to 0-1
-        
-        // Linear interpolation: 6hrs when ratio=0 (3.7V), 2hrs when ratio=1 (4.2V)
-        sleepMinutes = MAX_SLEEP_MINUTES - (MAX_SLEEP_MINUTES - MIN_SLEEP_MINUTES) * voltageRatio;
-        
-        Serial.printf("🔋 Battery scaling: %.2fV → %.1f ratio → %d min\n", 
-                      batteryVoltage, voltageRatio, sleepMinutes);
-    } else {
-        // Normal/high battery level: use minimum sleep time (2 hours)
-        sleepMinutes = MIN_SLEEP_MINUTES;
-        Serial.printf("🔋 Good battery (%.2fV): standard sleep\n", batteryVoltage);
+void fillTelemetryHeader(TelemetryHeader &header, uint32_t sleepMinutes) {
+    header = {};
+    header.flags = (wifiFastConnect ? TELEMETRY_FLAG_FAST_CONNECT : 0) |
+                   (isCharging() ? TELEMETRY_FLAG_CHARGING : 0);
+    WiFi.macAddress(header.mac);
+    header.bootCount = rtcState->bootCount;
+    header.uptimeMs = millis();
+    header.rssi = WiFi.RSSI();
+    header.sleepMinutes = sleepMinutes;
+    header.wifiConnectMs = min(wifiConnectMs, 65535UL);
+    header.uplinkReason = uplinkReason;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        header.phaseMs[i] = min(profilerPhaseUs((WakePhase)i) / 1000, (uint32_t)65535);
     }
-    
-    // Ensure sleep time is within bounds
-    sleepMinutes = max((uint32_t)MIN_SLEEP_MINUTES, min((uint32_t)MAX_SLEEP_MINUTES, sleepMinutes));
-    
-    Serial.printf("Final sleep decision: Battery=%.2fV, Light=%d, Sleep=%d min (%.1f hrs)\n", 
-                  batteryVoltage, lightLevel, sleepMinutes, sleepMinutes/60.0);
-    
-    return sleepMinutes;
 }
 
-float calculateMoisturePercent(int moistureReading) {
-    // Convert ADC reading to moisture percentage
-    // Lower ADC values = more moisture (inverted scale)
-    
-    if (moistureReading <= MOISTURE_WET_VALUE) {
-        return 100.0; // Saturated - 100% moisture
+size_t buildBinaryPayload(uint8_t *frame, size_t capacity, uint32_t sleepMinutes, int first, int count) {
+    static_assert(PHASE_COUNT == TELEMETRY_PHASES, "telemetry frame phase count");
+    static_assert(BATCH_FLAG_LOW_BATTERY == TELEMETRY_READING_LOW_BATTERY &&
+                  BATCH_FLAG_CHARGING == TELEMETRY_READING_CHARGING, "telemetry reading flags");
+    
+    TelemetryHeader header;
+    fillTelemetryHeader(header, sleepMinutes);
+    
+    // Batch records already use the frame's fixed-point units; readings
+    // first..first+count-1 of the batch go into this frame
+    TelemetryReading readings[BATCH_BUFFER_SIZE];
+    header.readingCount = count;
+    for (int i = 0; i < header.readingCount; i++) {
+        const BatchedReading &queued = batchAt(first + i);
+        readings[i].ageS = batchAgeS(queued);
+        readings[i].temperatureCenti = queued.temperatureCenti;
+        readings[i].humidityCenti = queued.humidityCenti;
+        readings[i].batteryMv = queued.batteryMv;
+        readings[i].lightLevel = queued.lightLevel;
+        readings[i].moistureLevel = queued.moistureLevel;
+        readings[i].moistureCenti = queued.moistureCenti;
+        readings[i].flags = queued.flags;
     }
     
-    if (moistureReading >= MOISTURE_DRY_VALUE) {
-        return 0.0; // Dry - 0% moisture
+    return telemetryEncode(header, readings, frame, capacity);
+}
+
+size_t buildBacklogPayload(uint8_t *block, size_t capacity, const FlashLogRecord *records, int count) {
+    // Consecutive log records as one compressed series block. Unlike the
+    // live frame, ages aren't sent: the server works them out from the
+    // block's device clock for readings of the same power cycle.
+    SeriesHeader header = {};
+    WiFi.macAddress(header.mac);
+    header.firstSequence = records[0].sequence;
+    header.deviceTime = time(nullptr);
+    header.powerCycle = flashLogPowerCycle();
+    
+    SeriesEncoder encoder = {};
+    if (!seriesBegin(encoder, header, block, capacity)) {
+        return 0;
     }
-    
-    // Linear interpolation between wet and dry values
-    float percent = 100.0 * (float)(MOISTURE_DRY_VALUE - moistureReading) / 
-                    (float)(MOISTURE_DRY_VALUE - MOISTURE_WET_VALUE);
-    
-    // Ensure result is between 0-100%
-    return max(0.0f, min(100.0f, percent));
+    for (int i = 0; i < count; i++) {
+        const FlashLogRecord &record = records[i];
+        SeriesReading reading;
+        reading.takenAt = record.takenAt;
+        reading.powerCycle = record.powerCycle;
+        reading.temperatureCenti = record.temperatureCenti;
+        reading.humidityCenti = record.humidityCenti;
+        reading.batteryMv = record.batteryMv;
+        reading.lightLevel = record.lightLevel;
+        reading.moistureLevel = record.moistureLevel;
+        reading.moistureCenti = record.moistureCenti;
+        reading.flags = record.flags;
+        if (!seriesAppend(encoder, reading)) {
+            return 0;
+        }
+    }
+    return seriesFinish(encoder);
 }
 
 String fetchDeviceAccessKey() {
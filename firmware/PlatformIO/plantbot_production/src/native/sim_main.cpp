@@ -0,0 +1,440 @@
+/*
+ * PlantBot2 Host Simulation - Run Driver
+ * 
+ * Command line front end of the host simulation (see sim.h): runs the
+ * firmware's setup() once per simulated wake, alone or as a fleet, and
+ * prints the summary. Built for [env:native] only; the peripheral models
+ * stay in plantbot_core so host tests link without this main().
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include "sim.h"
+#include "sim_energy.h"
+#include <stdio.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <vector>
+
+// Fleet runs: RTC slow clock error per device (the RC oscillator is good
+// to a few percent) and how often progress is printed
+#define SIM_FLEET_CLOCK_DRIFT   0.02
+#define SIM_FLEET_PROGRESS_US   (5 * 1000000ULL)
+
+// Clock
+
+// The RTC keeps counting through deep sleep; there's no SNTP, so time()
+// is seconds since power-on as on the device
+extern "C" time_t __wrap_time(time_t *result) {
+    time_t seconds = (time_t)(simNowUs() / 1000000ULL);
+    if (result != nullptr) {
+        *result = seconds;
+    }
+    return seconds;
+}
+
+// Run: one forked process per wake
+
+[[noreturn]] static void runWake(SimShared *slot, uint8_t *rtc, uint32_t device, uint32_t wake,
+                                 uint64_t wallStartUs) {
+    simWakeBegin(slot, rtc, device, wake, wallStartUs);
+    setup();
+    for (;;) {
+        loop();
+    }
+}
+
+static void printSummary(const SimStats &stats, uint64_t virtualUs) {
+    printf("\n=== Simulation Summary ===\n");
+    printf("Virtual time: %.2f days\n", virtualUs / 86400e6);
+    printf("Wakes: %u (%u with radio)\n", stats.wakes, stats.radioWakes);
+    printf("Awake: %.1f s total, %.0f ms per wake\n", stats.awakeUs / 1e6,
+           stats.wakes > 0 ? stats.awakeUs / 1000.0 / stats.wakes : 0.0);
+    printf("Radio on: %.1f s total\n", stats.radioUs / 1e6);
+    printf("HTTP: %u requests, %u accepted, %llu bytes\n", stats.httpRequests, stats.httpAccepted,
+           (unsigned long long)stats.httpBytes);
+    printf("Readings: %u taken, %u delivered (%.1f%%)\n", stats.readingsTaken, stats.readingsDelivered,
+           stats.readingsTaken > 0 ? 100.0 * stats.readingsDelivered / stats.readingsTaken : 0.0);
+    printf("Brownouts: %u\n", stats.brownouts);
+}
+
+// Fleet: every device wakes in its own process when the wall clock (times
+// paceSpeed) reaches its next wake, so wakes of different devices overlap
+// as they would in the field. Devices power on spread over windowS seconds.
+static int runFleet(const SimRunConfig &config, uint32_t devices, double windowS, uint64_t endUs, uint32_t maxWakes) {
+    size_t rtcSize = __stop_rtc_sim_data - __start_rtc_sim_data;
+    SimShared *slots = (SimShared *)mmap(nullptr, devices * sizeof(SimShared), PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    uint8_t *rtcSlots = nullptr;
+    if (rtcSize > 0) {
+        rtcSlots = (uint8_t *)mmap(nullptr, devices * rtcSize, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    }
+    if (slots == MAP_FAILED || rtcSlots == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (!simStorageBegin(devices)) {
+        return 1;
+    }
+    
+    struct FleetDevice {
+        pid_t pid;          // Wake in progress, 0 = asleep
+        uint32_t wakes;
+        double drift;       // Sleep timer error
+        bool finished;
+    };
+    std::vector<FleetDevice> fleet(devices);
+    for (uint32_t d = 0; d < devices; d++) {
+        memset(&slots[d], 0, sizeof(SimShared));
+        slots[d].wakeStartUs = (uint64_t)(windowS * 1e6 * (simRandom() / 4294967296.0));
+        if (rtcSize > 0) {
+            memcpy(rtcSlots + d * rtcSize, __start_rtc_sim_data, rtcSize);
+        }
+        fleet[d] = {0, 0, SIM_FLEET_CLOCK_DRIFT * (2.0 * simRandom() / 4294967296.0 - 1.0), false};
+    }
+    
+    uint64_t wallStartUs = simWallUs();
+    uint64_t progressAtUs = SIM_FLEET_PROGRESS_US;
+    uint32_t running = 0;
+    for (;;) {
+        uint64_t elapsedUs = simWallUs() - wallStartUs;
+        bool pending = running > 0;
+        for (uint32_t d = 0; d < devices; d++) {
+            FleetDevice &device = fleet[d];
+            if (device.pid != 0 || device.finished) {
+                continue;
+            }
+            if (slots[d].wakeStartUs >= endUs || device.wakes >= maxWakes) {
+                device.finished = true;
+                continue;
+            }
+            pending = true;
+            if (slots[d].wakeStartUs > elapsedUs * config.paceSpeed) {
+                continue;
+            }
+            
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                uint8_t *rtc = rtcSlots != nullptr ? rtcSlots + d * rtcSize : nullptr;
+                if (rtcSize > 0) {
+                    memcpy(__start_rtc_sim_data, rtc, rtcSize);
+                }
+                runWake(&slots[d], rtc, d + 1, device.wakes + 1,
+                        wallStartUs + (uint64_t)(slots[d].wakeStartUs / config.paceSpeed));
+            }
+            device.pid = pid;
+            running++;
+        }
+        if (!pending) {
+            break;
+        }
+        
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            uint32_t d = 0;
+            while (d < devices && fleet[d].pid != pid) {
+                d++;
+            }
+            if (d == devices) {
+                continue;
+            }
+            SimShared &slot = slots[d];
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !slot.ended) {
+                fprintf(stderr, "❌ Device %u wake %u ended without deep sleep\n", d + 1, fleet[d].wakes + 1);
+                return 1;
+            }
+            for (uint32_t i = 0; i < slot.requestCount; i++) {
+                SimRequest request = slot.requests[i];
+                request.wallStartUs -= wallStartUs;
+                simFleetRecord(request);
+            }
+            slot.wakeStartUs += slot.awakeUs + (uint64_t)(slot.sleepUs * (1.0 + fleet[d].drift));
+            slot.timerWake = true;
+            fleet[d].pid = 0;
+            fleet[d].wakes++;
+            running--;
+        }
+        
+        if (config.quiet < 2 && elapsedUs >= progressAtUs) {
+            simFleetPrintProgress(elapsedUs, running);
+            progressAtUs += SIM_FLEET_PROGRESS_US;
+        }
+        usleep(1000);
+    }
+    uint64_t elapsedUs = simWallUs() - wallStartUs;
+    
+    SimStats total = {};
+    uint64_t virtualUs = 0;
+    for (uint32_t d = 0; d < devices; d++) {
+        const SimStats &stats = slots[d].stats;
+        total.wakes += stats.wakes;
+        total.radioWakes += stats.radioWakes;
+        total.awakeUs += stats.awakeUs;
+        total.radioUs += stats.radioUs;
+        total.httpRequests += stats.httpRequests;
+        total.httpAccepted += stats.httpAccepted;
+        total.httpBytes += stats.httpBytes;
+        total.readingsTaken += stats.readingsTaken;
+        total.readingsDelivered += stats.readingsDelivered;
+        virtualUs = max(virtualUs, slots[d].wakeStartUs);
+    }
+    printSummary(total, virtualUs);
+    simFleetPrintSummary(devices, elapsedUs);
+    simStoragePrintSummary();
+    return 0;
+}
+
+static void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [-s scenario.csv] [-n wakes | -d days] [-w rate] [-q[q]]\n"
+            "          [-e [-i irradiance.csv] [-c mAh] [-b percent] [-r ohms] [-L latitude]] [-Z]\n"
+            "  -s  scenario CSV (minute,battery_mv,light,moisture,temperature,humidity,wifi,http_status)\n"
+            "  -n  number of wakes to run (default 24)\n"
+            "  -d  run until this many days of virtual time have passed\n"
+            "  -w  share of WiFi association attempts that succeed (default 1)\n"
+            "  -q  print only one line per wake, -qq only the summary\n"
+            "  -e  battery and light from the energy model instead of the scenario\n"
+            "  -i  irradiance trace CSV (minute,irradiance_w_m2), default a synthetic year\n"
+            "  -c  battery capacity in mAh (default 2000)\n"
+            "  -b  initial state of charge in percent (default 80)\n"
+            "  -r  cell internal resistance in ohms (default 0.15, aged or cold cells 1+)\n"
+            "  -L  latitude of the synthetic year (default 51.5)\n"
+            "  -Z  benchmark the series codec on the readings the run logged to flash\n"
+            "Series codec benchmark on a device's log: %s -z tlog.bin\n"
+            "  -z  \"tlog\" partition image (esptool.py read_flash 0x210000 0x1E0000 tlog.bin)\n"
+            "Fleet load test: %s -F devices [-u url] [-j seconds] [-x speed] [-n wakes | -d days]\n"
+            "  -F  number of devices waking side by side against a real server\n"
+            "  -u  target, http://host[:port][/path] (default: the ingestion stand-in)\n"
+            "  -j  devices power on spread over this many virtual seconds (default 60)\n"
+            "  -x  virtual seconds per wall-clock second (default 1)\n"
+            "Ingestion stand-in: %s -S port, or with -F and no -u\n"
+            "  -l  mean service time per upload in ms (default 20)\n"
+            "  -k  uploads in service at once, the rest queue (default 4)\n"
+            "  -f  share of uploads answered 503 (default 0)\n",
+            program, program, program, program);
+}
+
+int main(int argc, char **argv) {
+    uint32_t maxWakes = 24;
+    double days = 0;
+    bool energy = false;
+    SimEnergyConfig energyConfig = simEnergyDefaults();
+    uint32_t devices = 0;
+    double windowS = 60;
+    bool serve = false;
+    SimIngestConfig ingest = {0, 20, 4, 0};
+    bool seriesBenchmark = false;
+    SimRunConfig config = {0, 1.0f, 0};
+    
+    int option;
+    while ((option = getopt(argc, argv, "s:n:d:w:qei:c:b:r:L:Zz:F:u:j:x:S:l:k:f:h")) != -1) {
+        switch (option) {
+        case 's':
+            if (!simLoadScenario(optarg)) {
+                return 1;
+            }
+            break;
+        case 'n':
+            maxWakes = (uint32_t)strtoul(optarg, nullptr, 10);
+            break;
+        case 'd':
+            days = atof(optarg);
+            break;
+        case 'w':
+            config.linkSuccessRate = constrain(atof(optarg), 0.0, 1.0);
+            break;
+        case 'q':
+            config.quiet++;
+            break;
+        case 'e':
+            energy = true;
+            break;
+        case 'i':
+            if (!simEnergyLoadIrradiance(optarg)) {
+                return 1;
+            }
+            break;
+        case 'c':
+            energyConfig.capacityMah = atof(optarg);
+            break;
+        case 'b':
+            energyConfig.initialSoc = atof(optarg) / 100.0f;
+            break;
+        case 'r':
+            energyConfig.internalOhm = atof(optarg);
+            break;
+        case 'L':
+            energyConfig.latitude = atof(optarg);
+            break;
+        case 'Z':
+            seriesBenchmark = true;
+            break;
+        case 'z':
+            return simSeriesBenchmarkFile(optarg);
+        case 'F':
+            devices = (uint32_t)strtoul(optarg, nullptr, 10);
+            break;
+        case 'u':
+            if (!simTargetSet(optarg)) {
+                return 1;
+            }
+            break;
+        case 'j':
+            windowS = max(atof(optarg), 0.0);
+            break;
+        case 'x':
+            config.paceSpeed = atof(optarg);
+            break;
+        case 'S':
+            serve = true;
+            ingest.port = (uint16_t)atoi(optarg);
+            break;
+        case 'l':
+            ingest.serviceMs = (uint32_t)strtoul(optarg, nullptr, 10);
+            break;
+        case 'k':
+            ingest.workers = (uint32_t)strtoul(optarg, nullptr, 10);
+            break;
+        case 'f':
+            ingest.rejectRate = constrain(atof(optarg), 0.0, 1.0);
+            break;
+        default:
+            printUsage(argv[0]);
+            return option == 'h' ? 0 : 1;
+        }
+    }
+    
+    if (serve) {
+        return simIngestServe(ingest);
+    }
+    if (devices > 0) {
+        if (energy) {
+            fprintf(stderr, "The energy model runs one device at a time (no -e with -F)\n");
+            return 1;
+        }
+        
+        // Without a target the fleet uploads to the stand-in in its own process
+        int server = 0;
+        if (!simTargetActive()) {
+            uint16_t port;
+            server = simIngestStart(ingest, &port);
+            char url[32];
+            snprintf(url, sizeof(url), "http://127.0.0.1:%u", port);
+            if (server < 0 || !simTargetSet(url)) {
+                return 1;
+            }
+        }
+        printf("🌱 PlantBot2 fleet: %u devices powering on over %.0f s\n", devices, windowS);
+        
+        config.paceSpeed = config.paceSpeed > 0 ? config.paceSpeed : 1.0;
+        config.quiet = max(config.quiet, 1);
+        simConfigure(config);
+        int result = runFleet(config, devices, windowS, days > 0 ? (uint64_t)(days * 86400e6) : UINT64_MAX,
+                              days > 0 ? UINT32_MAX : maxWakes);
+        fflush(stdout);
+        simIngestStop(server);
+        return result;
+    }
+    config.paceSpeed = 0;
+    simConfigure(config);
+    
+    SimShared *shared = (SimShared *)mmap(nullptr, sizeof(SimShared), PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t rtcSize = __stop_rtc_sim_data - __start_rtc_sim_data;
+    uint8_t *sharedRtc = nullptr;
+    if (rtcSize > 0) {
+        sharedRtc = (uint8_t *)mmap(nullptr, rtcSize, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    }
+    if (shared == MAP_FAILED || sharedRtc == MAP_FAILED || !simStorageBegin(1)) {
+        perror("mmap");
+        return 1;
+    }
+    memset(shared, 0, sizeof(SimShared));
+    printf("🌱 PlantBot2 host simulation: %zu bytes of RTC memory\n", rtcSize);
+    
+    // RTC memory as loaded from the image, for power-on resets
+    std::vector<uint8_t> rtcPowerOn(__start_rtc_sim_data, __start_rtc_sim_data + rtcSize);
+    
+    if (energy) {
+        if (energyConfig.capacityMah <= 0) {
+            fprintf(stderr, "Battery capacity must be positive\n");
+            return 1;
+        }
+        simEnergyBegin(energyConfig);
+    }
+    
+    // Without a day limit, a cell that never recovers ends the run after a year
+    uint64_t endUs = (uint64_t)((days > 0 ? days : 365) * 86400e6);
+    for (uint32_t wake = 1; shared->wakeStartUs < endUs && (days > 0 || wake <= maxWakes); wake++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            runWake(shared, sharedRtc, 1, wake, 0);
+        }
+        
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !shared->ended) {
+            fprintf(stderr, "❌ Wake %u ended without deep sleep\n", wake);
+            return 1;
+        }
+        
+        uint64_t wakeStartUs = shared->wakeStartUs;
+        uint64_t nextWakeUs = wakeStartUs + shared->awakeUs + shared->sleepUs;
+        bool powerOn = shared->brownout;
+        if (energy) {
+            simEnergyWake(shared->awakeUs, shared->radioUs);
+            bool powerLost;
+            uint64_t poweredUs = simEnergySleep(wakeStartUs, nextWakeUs, endUs, shared->batteryMv, &powerLost);
+            if (powerLost) {
+                nextWakeUs = poweredUs;
+                powerOn = true;
+            }
+        }
+        
+        // The next wake starts from the RTC memory this one left behind,
+        // or from scratch after a reset
+        if (rtcSize > 0) {
+            memcpy(__start_rtc_sim_data, powerOn ? rtcPowerOn.data() : sharedRtc, rtcSize);
+        }
+        shared->timerWake = !powerOn;
+        shared->wakeStartUs = nextWakeUs;
+        
+        if (config.quiet < 2) {
+            uint64_t startMin = wakeStartUs / 60000000ULL;
+            char http[8] = "-";
+            if (shared->httpStatus != 0) {
+                snprintf(http, sizeof(http), "%d", shared->httpStatus);
+            }
+            printf("%s Wake %u at %llud %02u:%02u - battery %ldmV, awake %.0f ms, radio %.0f ms, HTTP %s, sleep %.1f min\n",
+                   shared->brownout ? "⚡" : "⏰", wake, (unsigned long long)(startMin / 1440),
+                   (unsigned)(startMin / 60 % 24), (unsigned)(startMin % 60), (long)shared->batteryMv,
+                   shared->awakeUs / 1000.0, shared->radioUs / 1000.0, http, shared->sleepUs / 60e6);
+        }
+    }
+    
+    printSummary(shared->stats, shared->wakeStartUs);
+    simStoragePrintSummary();
+    if (energy) {
+        simEnergyPrintSummary(shared->wakeStartUs);
+    }
+    return seriesBenchmark ? simSeriesBenchmarkLog() : 0;
+}
+
+#endif // ARDUINO
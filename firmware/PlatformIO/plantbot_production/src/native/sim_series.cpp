@@ -0,0 +1,236 @@
+/*
+ * PlantBot2 Host Simulation - Series Codec Benchmark
+ * 
+ * See sim.h. Collects the readings in a "tlog" partition image, encodes
+ * them with series_codec.h the way the backlog upload does and as whole
+ * runs, checks that they decode unchanged and reports the cost per field
+ * against the other formats a reading is stored or sent in.
+ */
+
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "sim.h"
+#include "flash_log.h"
+#include "series_codec.h"
+#include "telemetry_codec.h"
+#include "plantbot2_pins.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// Valid records of every sector with a header, oldest first
+static std::vector<FlashLogRecord> collectRecords(const uint8_t *image, size_t size) {
+    std::vector<FlashLogRecord> records;
+    for (size_t sector = 0; sector + FLASH_LOG_SECTOR_SIZE <= size; sector += FLASH_LOG_SECTOR_SIZE) {
+        FlashLogSectorHeader header;
+        memcpy(&header, image + sector, sizeof(header));
+        if (header.magic != FLASH_LOG_SECTOR_MAGIC || header.check != ~header.firstSequence) {
+            continue;
+        }
+        for (uint32_t slot = 0; slot < FLASH_LOG_SECTOR_RECORDS; slot++) {
+            FlashLogRecord record;
+            memcpy(&record, image + sector + (slot + 1) * FLASH_LOG_RECORD_SIZE, sizeof(record));
+            if (record.sequence == header.firstSequence + slot && record.crc == flashLogRecordCrc(record)) {
+                records.push_back(record);
+            }
+        }
+    }
+    std::sort(records.begin(), records.end(), [](const FlashLogRecord &a, const FlashLogRecord &b) {
+        return a.sequence < b.sequence;
+    });
+    return records;
+}
+
+static SeriesReading toSeries(const FlashLogRecord &record) {
+    SeriesReading reading;
+    reading.takenAt = record.takenAt;
+    reading.powerCycle = record.powerCycle;
+    reading.temperatureCenti = record.temperatureCenti;
+    reading.humidityCenti = record.humidityCenti;
+    reading.batteryMv = record.batteryMv;
+    reading.lightLevel = record.lightLevel;
+    reading.moistureLevel = record.moistureLevel;
+    reading.moistureCenti = record.moistureCenti;
+    reading.flags = record.flags;
+    return reading;
+}
+
+static bool sameReading(const SeriesReading &a, const SeriesReading &b) {
+    return a.takenAt == b.takenAt && a.powerCycle == b.powerCycle && a.flags == b.flags &&
+           a.temperatureCenti == b.temperatureCenti && a.humidityCenti == b.humidityCenti &&
+           a.batteryMv == b.batteryMv && a.lightLevel == b.lightLevel &&
+           a.moistureLevel == b.moistureLevel && a.moistureCenti == b.moistureCenti;
+}
+
+// Size of the entry the JSON backlog payload carries for a reading, with
+// a typical age
+static size_t jsonReadingSize(const FlashLogRecord &record) {
+    char entry[320];
+    return snprintf(entry, sizeof(entry),
+                    "{\"seq\":%u,\"power_cycle\":%u,\"age_s\":%u,\"temperature\":%g,\"humidity\":%g,"
+                    "\"battery_voltage\":%g,\"light_level\":%u,\"moisture_level\":%u,\"moisture_percent\":%g,"
+                    "\"low_battery\":%s,\"charging\":%s},",
+                    record.sequence, record.powerCycle, 7200u, record.temperatureCenti / 100.0,
+                    record.humidityCenti / 100.0, record.batteryMv / 1000.0, record.lightLevel,
+                    record.moistureLevel, record.moistureCenti / 100.0,
+                    (record.flags & TELEMETRY_READING_LOW_BATTERY) ? "true" : "false",
+                    (record.flags & TELEMETRY_READING_CHARGING) ? "true" : "false");
+}
+
+// Encode readings in blocks of at most blockSize and decode them again;
+// returns the total size, or 0 when a block didn't round-trip
+static size_t encodeBlocks(const std::vector<SeriesReading> &readings, size_t blockSize) {
+    std::vector<uint8_t> block(SERIES_MAX_SIZE(blockSize));
+    std::vector<SeriesReading> decoded(blockSize);
+    size_t total = 0;
+    for (size_t first = 0; first < readings.size(); first += blockSize) {
+        size_t count = min(blockSize, readings.size() - first);
+        SeriesHeader header = {};
+        header.firstSequence = first;
+        SeriesEncoder encoder = {};
+        seriesBegin(encoder, header, block.data(), block.size());
+        for (size_t i = 0; i < count; i++) {
+            if (!seriesAppend(encoder, readings[first + i])) {
+                return 0;
+            }
+        }
+        size_t length = seriesFinish(encoder);
+        
+        SeriesHeader decodedHeader;
+        if (!seriesDecode(block.data(), length, decodedHeader, decoded.data(), count) ||
+            decodedHeader.readingCount != count) {
+            return 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!sameReading(decoded[i], readings[first + i])) {
+                return 0;
+            }
+        }
+        total += length;
+    }
+    return total;
+}
+
+static int benchmark(const uint8_t *image, size_t size) {
+    std::vector<FlashLogRecord> records = collectRecords(image, size);
+    if (records.size() < 2) {
+        fprintf(stderr, "Fewer than two readings in the log\n");
+        return 1;
+    }
+    
+    // Runs of consecutive sequence numbers, as the backlog upload sends them
+    std::vector<std::vector<SeriesReading>> runs;
+    size_t jsonBytes = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (i == 0 || records[i].sequence != records[i - 1].sequence + 1) {
+            runs.emplace_back();
+        }
+        runs.back().push_back(toSeries(records[i]));
+        jsonBytes += jsonReadingSize(records[i]);
+    }
+    
+    // Bits spent on each part of the readings after the first of a run
+    static const char *names[SERIES_FIELDS] = {"temperature", "humidity", "battery", "light", "moisture",
+                                               "moisture %"};
+    uint64_t timestampBits = 0, stateBits = 0, fieldBits[SERIES_FIELDS] = {};
+    uint64_t intervals = 0, intervalS = 0;
+    uint8_t scratch[64];
+    for (const std::vector<SeriesReading> &run : runs) {
+        int64_t previousDelta = 0;
+        for (size_t i = 1; i < run.size(); i++) {
+            const SeriesReading &p = run[i - 1], &r = run[i];
+            SeriesBits bits = {scratch, sizeof(scratch) * 8, 0};
+            int64_t delta = (int64_t)r.takenAt - p.takenAt;
+            seriesPutTimestamp(bits, delta - previousDelta);
+            timestampBits += bits.position + (delta - previousDelta < -2047 || delta - previousDelta > 2048 ? 32 : 0);
+            previousDelta = delta;
+            stateBits += (r.powerCycle == p.powerCycle ? 1 : 17) + (r.flags == p.flags ? 1 : 9);
+            for (int field = 0; field < SERIES_FIELDS; field++) {
+                bits.position = 0;
+                seriesPutField(bits, seriesFields[field], seriesFieldValue(p, field), seriesFieldValue(r, field));
+                fieldBits[field] += bits.position;
+            }
+            if (r.powerCycle == p.powerCycle && delta > 0) {
+                intervals++;
+                intervalS += delta;
+            }
+        }
+    }
+    
+    size_t uploadBytes = 0, runBytes = 0;
+    bool roundTrip = true;
+    for (const std::vector<SeriesReading> &run : runs) {
+        size_t upload = encodeBlocks(run, FLASH_LOG_UPLOAD_BATCH);
+        size_t whole = encodeBlocks(run, run.size());
+        roundTrip = roundTrip && upload > 0 && whole > 0;
+        uploadBytes += upload;
+        runBytes += whole;
+    }
+    if (!roundTrip) {
+        printf("❌ Series blocks did not decode to the logged readings\n");
+        return 1;
+    }
+    
+    size_t n = records.size();
+    size_t deltas = n - runs.size();
+    double intervalMean = intervals > 0 ? (double)intervalS / intervals : 0;
+    printf("🗜️ Series codec: %zu logged readings in %zu runs, %.0f s apart on average\n", n, runs.size(),
+           intervalMean);
+    printf("Bits per reading after the first: timestamp %.2f, power cycle and flags %.2f",
+           deltas > 0 ? (double)timestampBits / deltas : 0.0, deltas > 0 ? (double)stateBits / deltas : 0.0);
+    uint64_t readingBits = timestampBits + stateBits;
+    for (int field = 0; field < SERIES_FIELDS; field++) {
+        printf(", %s %.2f", names[field], deltas > 0 ? (double)fieldBits[field] / deltas : 0.0);
+        readingBits += fieldBits[field];
+    }
+    printf(" (%.1f in all)\n", deltas > 0 ? (double)readingBits / deltas : 0.0);
+    
+    double perUpload = (double)uploadBytes / n, perRun = (double)runBytes / n;
+    printf("Bytes per reading: %.2f in backlog blocks of %d, %.2f in one block per run\n", perUpload,
+           FLASH_LOG_UPLOAD_BATCH, perRun);
+    printf("Compression: %.1fx flash log records (%d B), %.1fx binary frame readings (%d B), "
+           "%.1fx JSON readings (%.0f B)\n",
+           FLASH_LOG_RECORD_SIZE / perUpload, FLASH_LOG_RECORD_SIZE, TELEMETRY_READING_SIZE / perUpload,
+           TELEMETRY_READING_SIZE, (double)jsonBytes / n / perUpload, (double)jsonBytes / n);
+    double perKb = (1024 - SERIES_HEADER_SIZE) / perRun;
+    printf("1 KB holds %.0f readings (%.1f days), against %d flash log records\n", perKb,
+           perKb * intervalMean / 86400, 1024 / FLASH_LOG_RECORD_SIZE);
+    printf("Round trip: all %zu readings decode unchanged\n", n);
+    return 0;
+}
+
+int simSeriesBenchmarkLog() {
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                "tlog");
+    if (partition == nullptr) {
+        fprintf(stderr, "No flash log partition\n");
+        return 1;
+    }
+    std::vector<uint8_t> image(partition->size);
+    if (esp_partition_read(partition, 0, image.data(), image.size()) != ESP_OK) {
+        fprintf(stderr, "Flash log partition could not be read\n");
+        return 1;
+    }
+    return benchmark(image.data(), image.size());
+}
+
+int simSeriesBenchmarkFile(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> image;
+    uint8_t chunk[FLASH_LOG_SECTOR_SIZE];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        image.insert(image.end(), chunk, chunk + length);
+    }
+    fclose(file);
+    return benchmark(image.data(), image.size());
+}
+
+#endif // ARDUINO
@@ -0,0 +1,436 @@
+/*
+ * PlantBot2 TLS Uplink
+ * 
+ * See tls_uplink.h.
+ */
+
+// Session start time is only reachable through the private member macro
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include "tls_uplink.h"
+#include "plantbot2_pins.h"
+#include "rtc_arena.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/sha256.h>
+#include "credentials.h"
+
+#ifndef TLS_PINNED_SPKI_SHA256
+#include <sdkconfig.h>
+#include <esp_crt_bundle.h>
+#endif
+
+#ifdef TLS_PINNED_SPKI_SHA256
+#if !defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+#error "Key pinning needs CONFIG_MBEDTLS_SSL_KEEP_PEER_CERTIFICATE"
+#endif
+
+// SHA-256 of the pinned SubjectPublicKeyInfo (server key or an intermediate)
+static const uint8_t pinnedSpki[32] = TLS_PINNED_SPKI_SHA256;
+
+// One fast suite on one curve - no RSA and no negotiation of alternatives
+static const int pinnedCiphersuites[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    0
+};
+static const uint16_t pinnedGroups[] = {
+    MBEDTLS_SSL_IANA_TLS_GROUP_SECP256R1,
+    MBEDTLS_SSL_IANA_TLS_GROUP_NONE
+};
+#elif !defined(CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+#error "Without TLS_PINNED_SPKI_SHA256 the server is verified with CONFIG_MBEDTLS_CERTIFICATE_BUNDLE"
+#endif
+
+// Where the serialized session lives
+enum SessionStore : uint8_t {
+    SESSION_NONE,
+    SESSION_RTC,
+    SESSION_NVS
+};
+
+// Session and handshake statistics (RTC arena)
+struct TlsState {
+    uint8_t sessionStore;       // SessionStore
+    uint16_t sessionLength;
+    TlsStats stats;
+    uint8_t sessionRtc[TLS_SESSION_RTC_SIZE];
+};
+
+static TlsState &tlsState() {
+    return *rtcArenaRegion<TlsState>(RTC_REGION_TLS);
+}
+
+static WiFiClient tcp;
+static mbedtls_ssl_context ssl;
+static mbedtls_ssl_config conf;
+static mbedtls_entropy_context entropy;
+static mbedtls_ctr_drbg_context ctrDrbg;
+static mbedtls_ssl_session session;
+static bool tlsOpen = false;
+static uint8_t sessionBuffer[TLS_SESSION_MAX_SIZE];
+
+static int tcpSend(void *ctx, const unsigned char *buf, size_t len) {
+    WiFiClient *client = (WiFiClient *)ctx;
+    if (!client->connected()) {
+        return MBEDTLS_ERR_NET_CONN_RESET;
+    }
+    
+    size_t written = client->write(buf, len);
+    return written > 0 ? (int)written : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+static int tcpRecvTimeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeoutMs) {
+    WiFiClient *client = (WiFiClient *)ctx;
+    unsigned long startTime = millis();
+    
+    while (client->available() == 0) {
+        if (!client->connected()) {
+            return MBEDTLS_ERR_NET_CONN_RESET;
+        }
+        if (millis() - startTime >= timeoutMs) {
+            return MBEDTLS_ERR_SSL_TIMEOUT;
+        }
+        delay(1);
+    }
+    
+    int received = client->read(buf, len);
+    return received > 0 ? received : MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+static bool loadSession() {
+    const TlsState &tls = tlsState();
+    if (tls.sessionStore == SESSION_RTC) {
+        memcpy(sessionBuffer, tls.sessionRtc, tls.sessionLength);
+    } else if (tls.sessionStore == SESSION_NVS) {
+        Preferences prefs;
+        prefs.begin("tls", true);
+        size_t loaded = prefs.getBytes("session", sessionBuffer, sizeof(sessionBuffer));
+        prefs.end();
+        if (loaded != tls.sessionLength) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    
+    return mbedtls_ssl_session_load(&session, sessionBuffer, tls.sessionLength) == 0;
+}
+
+static void saveSession(const mbedtls_ssl_session &negotiated) {
+    TlsState &tls = tlsState();
+    size_t length = 0;
+    if (mbedtls_ssl_session_save(&negotiated, sessionBuffer, sizeof(sessionBuffer), &length) != 0) {
+        Serial.println("⚠️ TLS session too large to cache");
+        tlsForgetSession();
+        return;
+    }
+    
+    if (length <= TLS_SESSION_RTC_SIZE) {
+        memcpy(tls.sessionRtc, sessionBuffer, length);
+        tls.sessionStore = SESSION_RTC;
+    } else {
+        // Sessions keeping the peer certificate don't fit in RTC memory
+        Preferences prefs;
+        prefs.begin("tls", false);
+        bool stored = prefs.putBytes("session", sessionBuffer, length) == length;
+        prefs.end();
+        tls.sessionStore = stored ? SESSION_NVS : SESSION_NONE;
+    }
+    tls.sessionLength = length;
+    
+    Serial.printf("TLS session cached (%u bytes, %s)\n", (unsigned)length,
+                  tls.sessionStore == SESSION_RTC ? "RTC" : "NVS");
+}
+
+#ifdef TLS_PINNED_SPKI_SHA256
+static bool spkiMatchesPin(mbedtls_x509_crt *cert) {
+    // The DER key is written at the end of the buffer
+    unsigned char der[160]; // P-256 SubjectPublicKeyInfo is 91 bytes
+    int length = mbedtls_pk_write_pubkey_der(&cert->pk, der, sizeof(der));
+    if (length <= 0) {
+        return false;
+    }
+    
+    uint8_t hash[32];
+    if (mbedtls_sha256(der + sizeof(der) - length, length, hash, 0) != 0) {
+        return false;
+    }
+    return memcmp(hash, pinnedSpki, sizeof(hash)) == 0;
+}
+
+// Check the peer chain against the pin: either the server key itself, or an
+// intermediate whose signature over the server certificate is then verified
+static bool verifyPinnedKey(const char *host) {
+    const mbedtls_x509_crt *peer = mbedtls_ssl_get_peer_cert(&ssl);
+    if (peer == nullptr) {
+        return false;
+    }
+    
+    mbedtls_x509_crt *leaf = (mbedtls_x509_crt *)peer;
+    if (spkiMatchesPin(leaf)) {
+        return true;
+    }
+    
+    for (mbedtls_x509_crt *cert = leaf->next; cert != nullptr; cert = cert->next) {
+        if (!spkiMatchesPin(cert)) {
+            continue;
+        }
+        
+        // Trust only the pinned certificate, not what the server sent after it
+        mbedtls_x509_crt anchor;
+        mbedtls_x509_crt_init(&anchor);
+        uint32_t flags = 0;
+        bool verified = mbedtls_x509_crt_parse_der(&anchor, cert->raw.p, cert->raw.len) == 0 &&
+                        mbedtls_x509_crt_verify(leaf, &anchor, nullptr, host, &flags,
+                                                nullptr, nullptr) == 0;
+        mbedtls_x509_crt_free(&anchor);
+        return verified;
+    }
+    
+    return false;
+}
+#endif
+
+TlsResult tlsConnect(const char *host, const IPAddress &ip, uint16_t port) {
+    tlsClose();
+    
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctrDrbg);
+    mbedtls_ssl_session_init(&session);
+    tlsOpen = true;
+    
+    if (mbedtls_ctr_drbg_seed(&ctrDrbg, mbedtls_entropy_func, &entropy, nullptr, 0) != 0 ||
+        mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+        Serial.println("❌ TLS setup failed");
+        tlsClose();
+        return TLS_ERR_HANDSHAKE;
+    }
+    
+#ifdef TLS_PINNED_SPKI_SHA256
+    // The chain isn't validated by mbedTLS; the peer certificate is
+    // checked against the pin after the handshake instead
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_ciphersuites(&conf, pinnedCiphersuites);
+    mbedtls_ssl_conf_groups(&conf, pinnedGroups);
+    mbedtls_ssl_conf_max_tls_version(&conf, MBEDTLS_SSL_VERSION_TLS1_2);
+#else
+    // No pin: the chain and the hostname are verified during the handshake
+    // against the root certificates bundled with ESP-IDF
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    if (esp_crt_bundle_attach(&conf) != ESP_OK) {
+        Serial.println("❌ TLS certificate bundle unavailable");
+        tlsClose();
+        return TLS_ERR_HANDSHAKE;
+    }
+#endif
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &ctrDrbg);
+    mbedtls_ssl_conf_read_timeout(&conf, HTTP_TIMEOUT_MS);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+    
+    if (mbedtls_ssl_setup(&ssl, &conf) != 0 || mbedtls_ssl_set_hostname(&ssl, host) != 0) {
+        Serial.println("❌ TLS setup failed");
+        tlsClose();
+        return TLS_ERR_HANDSHAKE;
+    }
+    
+    if (!tcp.connect(ip, port)) {
+        Serial.println("❌ TCP connect failed");
+        tlsClose();
+        return TLS_ERR_TCP;
+    }
+    mbedtls_ssl_set_bio(&ssl, &tcp, tcpSend, nullptr, tcpRecvTimeout);
+    
+    // Offer the cached session - a full handshake is done if the server declines it
+    bool offered = TLS_SESSION_RESUMPTION && loadSession() &&
+                   mbedtls_ssl_set_session(&ssl, &session) == 0;
+    time_t offeredStart = offered ? session.MBEDTLS_PRIVATE(start) : 0;
+    
+    unsigned long startTime = millis();
+    int ret;
+    while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+            millis() - startTime >= HTTP_TIMEOUT_MS) {
+            Serial.printf("❌ TLS handshake failed: -0x%04x\n", (unsigned)-ret);
+            if (offered) {
+                tlsForgetSession(); // Don't offer a session that may be the cause again
+            }
+            tlsClose();
+            return TLS_ERR_HANDSHAKE;
+        }
+    }
+    uint32_t handshakeMs = millis() - startTime;
+    TlsState &tls = tlsState();
+    
+#ifdef TLS_PINNED_SPKI_SHA256
+    // Resumed sessions carry the certificate of the original handshake
+    unsigned long verifyStart = micros();
+    bool trusted = verifyPinnedKey(host);
+    tls.stats.verifyUs = micros() - verifyStart;
+    if (!trusted) {
+        Serial.println("❌ Server key doesn't match the pinned key");
+        tlsForgetSession();
+        tlsClose();
+        return TLS_ERR_HANDSHAKE;
+    }
+#endif
+    
+    // A resumed session keeps the start time of the handshake that created it
+    mbedtls_ssl_session negotiated;
+    mbedtls_ssl_session_init(&negotiated);
+    bool resumed = false;
+    if (mbedtls_ssl_get_session(&ssl, &negotiated) == 0) {
+        resumed = offered && negotiated.MBEDTLS_PRIVATE(start) == offeredStart;
+        if (!resumed && TLS_SESSION_RESUMPTION) {
+            saveSession(negotiated);
+        }
+    }
+    mbedtls_ssl_session_free(&negotiated);
+    
+    tls.stats.lastResumed = resumed;
+    tls.stats.lastHandshakeMs = handshakeMs;
+    if (resumed) {
+        tls.stats.resumedHandshakeMs = handshakeMs;
+        tls.stats.resumedCount++;
+    } else {
+        tls.stats.fullHandshakeMs = handshakeMs;
+        tls.stats.fullCount++;
+    }
+    
+    Serial.printf("🔒 TLS %s handshake in %lu ms (%s)\n", resumed ? "resumed" : "full",
+                  (unsigned long)handshakeMs, mbedtls_ssl_get_ciphersuite(&ssl));
+    return TLS_OK;
+}
+
+static bool tlsWrite(const uint8_t *data, size_t length) {
+    while (length > 0) {
+        int ret = mbedtls_ssl_write(&ssl, data, length);
+        if (ret > 0) {
+            data += ret;
+            length -= ret;
+        } else if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            Serial.printf("❌ TLS write failed: -0x%04x\n", (unsigned)-ret);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Read one line (without CRLF) of the response, false on error or timeout
+static bool tlsReadLine(String &line) {
+    line = "";
+    unsigned char c;
+    
+    while (true) {
+        int ret = mbedtls_ssl_read(&ssl, &c, 1);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        if (c == '\n') {
+            return true;
+        }
+        if (c != '\r') {
+            line += (char)c;
+        }
+    }
+}
+
+int tlsPost(const char *host, const char *path, const char *contentType,
+            const uint8_t *payload, size_t length, String &response) {
+    response = "";
+    if (!tlsOpen) {
+        return -1;
+    }
+    
+    char header[256];
+    int headerLength = snprintf(header, sizeof(header),
+                                "POST %s HTTP/1.1\r\n"
+                                "Host: %s\r\n"
+                                "User-Agent: PlantBot2\r\n"
+                                "Content-Type: %s\r\n"
+                                "Content-Length: %u\r\n"
+                                "Connection: close\r\n\r\n",
+                                path, host, contentType, (unsigned)length);
+    if (headerLength <= 0 || headerLength >= (int)sizeof(header)) {
+        return -1;
+    }
+    
+    if (!tlsWrite((const uint8_t *)header, headerLength) || !tlsWrite(payload, length)) {
+        return -1;
+    }
+    
+    // Status line: "HTTP/1.1 200 OK"
+    String line;
+    if (!tlsReadLine(line) || !line.startsWith("HTTP/") || line.length() < 12) {
+        return -1;
+    }
+    int statusCode = line.substring(9, 12).toInt();
+    
+    // Skip the headers, keep the start of the body for diagnostics
+    while (tlsReadLine(line) && line.length() > 0) {
+    }
+    unsigned char body[TLS_RESPONSE_MAX_SIZE + 1];
+    int received = mbedtls_ssl_read(&ssl, body, TLS_RESPONSE_MAX_SIZE);
+    if (received > 0) {
+        body[received] = '\0';
+        response = (const char *)body;
+    }
+    
+    return statusCode;
+}
+
+void tlsPing(const char *host, const char *path) {
+    if (!tlsOpen) {
+        return;
+    }
+    
+    char request[192];
+    int requestLength = snprintf(request, sizeof(request),
+                                 "HEAD %s HTTP/1.1\r\n"
+                                 "Host: %s\r\n"
+                                 "User-Agent: PlantBot2\r\n"
+                                 "Connection: close\r\n\r\n",
+                                 path, host);
+    if (requestLength > 0 && requestLength < (int)sizeof(request)) {
+        tlsWrite((const uint8_t *)request, requestLength);
+    }
+}
+
+void tlsClose() {
+    if (!tlsOpen) {
+        return;
+    }
+    
+    if (tcp.connected()) {
+        mbedtls_ssl_close_notify(&ssl);
+    }
+    tcp.stop();
+    
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ctr_drbg_free(&ctrDrbg);
+    mbedtls_entropy_free(&entropy);
+    tlsOpen = false;
+}
+
+void tlsForgetSession() {
+    TlsState &tls = tlsState();
+    tls.sessionStore = SESSION_NONE;
+    tls.sessionLength = 0;
+}
+
+const TlsStats &tlsStats() {
+    return tlsState().stats;
+}
@@ -0,0 +1,315 @@
+/*
+ * PlantBot2 ESP-NOW Frame and Gateway Queue Tests
+ * 
+ * Host tests for espnow_frame.h, espnow_crypto.h and gateway_queue.h:
+ * sealing and opening frames, rejection of tampered frames, duplicate
+ * suppression across retransmissions and power cycles, replayed frames of
+ * earlier sessions, node eviction and the forward queue. Needs the mbedTLS
+ * library on the host.
+ *   pio test -e native -f test_espnow_gateway
+ * 
+ * Version: 1.0
+ */
+
+#include <unity.h>
+#include "espnow_crypto.h"
+#include "gateway_queue.h"
+
+static const uint8_t testKey[ESPNOW_KEY_SIZE] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+static const uint8_t testNonce[ESPNOW_NONCE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+static uint8_t plain[ESPNOW_MAX_FRAME];
+static size_t plainLength;
+static uint8_t frame[ESPNOW_MAX_FRAME];
+static size_t frameLength;
+static EspNowHeader header;
+static GatewayDedup dedup;
+static GatewayQueue queue;
+
+static void nodeMac(uint8_t mac[6], int node) {
+    const uint8_t base[6] = {0x40, 0x4C, 0xCA, 0x00, 0x00, 0x00};
+    memcpy(mac, base, 6);
+    mac[4] = (uint8_t)(node >> 8);
+    mac[5] = (uint8_t)node;
+}
+
+void setUp() {
+    // A telemetry frame with two readings as the plaintext
+    TelemetryHeader telemetry = {};
+    telemetry.bootCount = 42;
+    telemetry.readingCount = 2;
+    TelemetryReading readings[2] = {};
+    readings[0].temperatureCenti = 2150;
+    readings[1].temperatureCenti = 2175;
+    plainLength = telemetryEncode(telemetry, readings, plain, sizeof(plain));
+    
+    header = {};
+    header.session = 0xA5A5F00D;
+    header.firstSequence = 1000;
+    frameLength = espnowSeal(testKey, header, testNonce, plain, plainLength, frame, sizeof(frame));
+    
+    dedup = {};
+    queue = {};
+}
+
+void tearDown() {
+}
+
+// Parse and open frame; false when either step rejects it
+static bool openFrame(const uint8_t key[ESPNOW_KEY_SIZE], EspNowHeader &parsed, uint8_t *opened,
+                      size_t &openedLength) {
+    EspNowParts parts;
+    if (!espnowParse(frame, frameLength, parsed, parts)) {
+        return false;
+    }
+    openedLength = parts.ciphertextLength;
+    return espnowOpen(key, parts, opened);
+}
+
+static void test_seal_open_round_trip() {
+    TEST_ASSERT_EQUAL_size_t(plainLength + ESPNOW_OVERHEAD, frameLength);
+    TEST_ASSERT_TRUE(frameLength <= ESPNOW_MAX_FRAME);
+    TEST_ASSERT_EQUAL_UINT8('P', frame[0]);
+    TEST_ASSERT_EQUAL_UINT8('N', frame[1]);
+    
+    // The telemetry frame is not sent in the clear
+    TEST_ASSERT_TRUE(memcmp(frame + ESPNOW_HEADER_SIZE + ESPNOW_NONCE_SIZE, plain, plainLength) != 0);
+    
+    EspNowHeader parsed;
+    uint8_t opened[ESPNOW_MAX_FRAME];
+    size_t openedLength = 0;
+    TEST_ASSERT_TRUE(openFrame(testKey, parsed, opened, openedLength));
+    TEST_ASSERT_EQUAL_UINT32(header.session, parsed.session);
+    TEST_ASSERT_EQUAL_UINT32(header.firstSequence, parsed.firstSequence);
+    TEST_ASSERT_EQUAL_size_t(plainLength, openedLength);
+    TEST_ASSERT_EQUAL_MEMORY(plain, opened, plainLength);
+    
+    TelemetryHeader telemetry;
+    TelemetryReading readings[2];
+    TEST_ASSERT_TRUE(telemetryDecode(opened, openedLength, telemetry, readings, 2));
+    TEST_ASSERT_EQUAL_UINT32(42, telemetry.bootCount);
+    TEST_ASSERT_EQUAL_INT16(2175, readings[1].temperatureCenti);
+}
+
+static void test_open_rejects_tampered_tag() {
+    frame[frameLength - 1] ^= 0x01;
+    
+    EspNowHeader parsed;
+    uint8_t opened[ESPNOW_MAX_FRAME];
+    size_t openedLength;
+    TEST_ASSERT_FALSE(openFrame(testKey, parsed, opened, openedLength));
+}
+
+static void test_open_rejects_tampered_ciphertext() {
+    frame[ESPNOW_HEADER_SIZE + ESPNOW_NONCE_SIZE + 5] ^= 0x80;
+    
+    EspNowHeader parsed;
+    uint8_t opened[ESPNOW_MAX_FRAME];
+    size_t openedLength;
+    TEST_ASSERT_FALSE(openFrame(testKey, parsed, opened, openedLength));
+}
+
+static void test_open_rejects_tampered_header() {
+    // The clear header is authenticated: a replayed frame can't claim new sequence numbers
+    frame[8] ^= 0x01;
+    
+    EspNowHeader parsed;
+    uint8_t opened[ESPNOW_MAX_FRAME];
+    size_t openedLength;
+    TEST_ASSERT_FALSE(openFrame(testKey, parsed, opened, openedLength));
+}
+
+static void test_open_rejects_wrong_key() {
+    uint8_t otherKey[ESPNOW_KEY_SIZE];
+    memcpy(otherKey, testKey, sizeof(otherKey));
+    otherKey[0] ^= 0xFF;
+    
+    EspNowHeader parsed;
+    uint8_t opened[ESPNOW_MAX_FRAME];
+    size_t openedLength;
+    TEST_ASSERT_FALSE(openFrame(otherKey, parsed, opened, openedLength));
+}
+
+static void test_seal_rejects_small_buffer() {
+    uint8_t small[ESPNOW_MAX_FRAME];
+    TEST_ASSERT_EQUAL_size_t(0, espnowSeal(testKey, header, testNonce, plain, plainLength, small,
+                                           plainLength + ESPNOW_OVERHEAD - 1));
+}
+
+static void test_parse_rejects_malformed_frames() {
+    EspNowHeader parsed;
+    EspNowParts parts;
+    TEST_ASSERT_FALSE(espnowParse(frame, ESPNOW_OVERHEAD - 1, parsed, parts));
+    
+    frame[0] = 'X';
+    TEST_ASSERT_FALSE(espnowParse(frame, frameLength, parsed, parts));
+    frame[0] = 'P';
+    frame[2] = ESPNOW_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(espnowParse(frame, frameLength, parsed, parts));
+}
+
+static void test_accept_suppresses_duplicates() {
+    uint8_t mac[6];
+    nodeMac(mac, 1);
+    
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 7, 100, 4, 1000));
+    
+    // Re-sent after a lost ACK: all four readings were already accepted
+    TEST_ASSERT_EQUAL_INT(4, gatewayAccept(dedup, mac, 7, 100, 4, 2000));
+    
+    // Partly new: the first two of 102..105 were seen
+    TEST_ASSERT_EQUAL_INT(2, gatewayAccept(dedup, mac, 7, 102, 4, 3000));
+    
+    // An older frame arriving late is a whole duplicate
+    TEST_ASSERT_EQUAL_INT(3, gatewayAccept(dedup, mac, 7, 99, 3, 4000));
+    
+    // The next frame in order
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 7, 106, 1, 5000));
+    TEST_ASSERT_EQUAL_INT(1, dedup.count);
+    TEST_ASSERT_EQUAL_UINT32(107, dedup.nodes[0].nextSequence);
+}
+
+static void test_accept_tracks_nodes_separately() {
+    uint8_t a[6], b[6];
+    nodeMac(a, 1);
+    nodeMac(b, 2);
+    
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, a, 7, 100, 2, 1000));
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, b, 9, 100, 2, 1000));
+    TEST_ASSERT_EQUAL_INT(2, gatewayAccept(dedup, a, 7, 100, 2, 2000));
+    TEST_ASSERT_EQUAL_INT(2, dedup.count);
+}
+
+static void test_accept_restarts_on_session_change() {
+    uint8_t mac[6];
+    nodeMac(mac, 1);
+    
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 7, 500, 3, 1000));
+    
+    // The node power-cycled: a new session numbers its readings from 0 again
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 8, 0, 3, 2000));
+    TEST_ASSERT_EQUAL_INT(3, gatewayAccept(dedup, mac, 8, 0, 3, 3000));
+    TEST_ASSERT_EQUAL_UINT32(8, dedup.nodes[0].session);
+    TEST_ASSERT_EQUAL_UINT32(3, dedup.nodes[0].nextSequence);
+    TEST_ASSERT_EQUAL_INT(1, dedup.count);
+}
+
+static void test_accept_rejects_earlier_session() {
+    uint8_t mac[6];
+    nodeMac(mac, 1);
+    
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 7, 500, 3, 1000));
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 8, 0, 3, 2000));
+    
+    // A recorded frame of the previous session is replayed
+    TEST_ASSERT_EQUAL_INT(-1, gatewayAccept(dedup, mac, 7, 500, 3, 3000));
+    TEST_ASSERT_EQUAL_INT(-1, gatewayAccept(dedup, mac, 7, 600, 3, 3000));
+    TEST_ASSERT_EQUAL_UINT32(8, dedup.nodes[0].session);
+    TEST_ASSERT_EQUAL_UINT32(3, dedup.nodes[0].nextSequence);
+    TEST_ASSERT_EQUAL_UINT32(2000, dedup.nodes[0].lastSeenMs);
+    
+    // The current session carries on
+    TEST_ASSERT_EQUAL_INT(1, gatewayAccept(dedup, mac, 8, 2, 3, 4000));
+    TEST_ASSERT_EQUAL_UINT32(5, dedup.nodes[0].nextSequence);
+}
+
+static void test_accept_evicts_least_recently_seen_when_full() {
+    uint8_t mac[6];
+    for (int node = 0; node < GATEWAY_MAX_NODES; node++) {
+        nodeMac(mac, node);
+        TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 1, 10, 1, 1000 + node));
+    }
+    TEST_ASSERT_EQUAL_INT(GATEWAY_MAX_NODES, dedup.count);
+    
+    // Node 0 is heard again, so node 1 becomes the least recently seen
+    nodeMac(mac, 0);
+    TEST_ASSERT_EQUAL_INT(1, gatewayAccept(dedup, mac, 1, 10, 1, 5000));
+    
+    uint8_t newcomer[6];
+    nodeMac(newcomer, GATEWAY_MAX_NODES);
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, newcomer, 1, 10, 1, 6000));
+    TEST_ASSERT_EQUAL_INT(GATEWAY_MAX_NODES, dedup.count);
+    TEST_ASSERT_EQUAL_MEMORY(newcomer, dedup.nodes[1].mac, 6);
+    
+    // Node 0 kept its state; node 1 was forgotten and is accepted again
+    nodeMac(mac, 0);
+    TEST_ASSERT_EQUAL_INT(1, gatewayAccept(dedup, mac, 1, 10, 1, 7000));
+    nodeMac(mac, 1);
+    TEST_ASSERT_EQUAL_INT(0, gatewayAccept(dedup, mac, 1, 10, 1, 8000));
+}
+
+static void test_accept_survives_clock_wrap() {
+    uint8_t mac[6];
+    for (int node = 0; node < GATEWAY_MAX_NODES; node++) {
+        nodeMac(mac, node);
+        gatewayAccept(dedup, mac, 1, 10, 1, 0xFFFFFF00u + node);
+    }
+    
+    // millis() wrapped: node 0 was still seen before node 1
+    nodeMac(mac, 0);
+    gatewayAccept(dedup, mac, 1, 11, 1, 0x10);
+    uint8_t newcomer[6];
+    nodeMac(newcomer, GATEWAY_MAX_NODES);
+    gatewayAccept(dedup, newcomer, 1, 10, 1, 0x20);
+    TEST_ASSERT_EQUAL_MEMORY(newcomer, dedup.nodes[1].mac, 6);
+}
+
+static void test_queue_batches_and_drops_oldest() {
+    TEST_ASSERT_FALSE(gatewayFlushDue(queue, 0, GATEWAY_BATCH_SIZE, GATEWAY_BATCH_MAX_DELAY_MS));
+    
+    for (int i = 0; i < GATEWAY_QUEUE_SIZE + 3; i++) {
+        GatewayForward &item = gatewayQueuePush(queue);
+        item.receivedMs = 100 + i;
+        item.readingCount = (uint8_t)(i % ESPNOW_MAX_READINGS);
+    }
+    TEST_ASSERT_EQUAL_INT(GATEWAY_QUEUE_SIZE, queue.count);
+    TEST_ASSERT_EQUAL_UINT32(3, queue.dropped);
+    TEST_ASSERT_EQUAL_UINT32(103, gatewayQueueFront(queue).receivedMs);
+    
+    gatewayQueuePop(queue);
+    TEST_ASSERT_EQUAL_UINT32(104, gatewayQueueFront(queue).receivedMs);
+    TEST_ASSERT_EQUAL_INT(GATEWAY_QUEUE_SIZE - 1, queue.count);
+}
+
+static void test_queue_flush_due_by_size_or_age() {
+    GatewayForward &first = gatewayQueuePush(queue);
+    first.receivedMs = 1000;
+    TEST_ASSERT_FALSE(gatewayFlushDue(queue, 1000 + GATEWAY_BATCH_MAX_DELAY_MS - 1, GATEWAY_BATCH_SIZE,
+                                      GATEWAY_BATCH_MAX_DELAY_MS));
+    TEST_ASSERT_TRUE(gatewayFlushDue(queue, 1000 + GATEWAY_BATCH_MAX_DELAY_MS, GATEWAY_BATCH_SIZE,
+                                     GATEWAY_BATCH_MAX_DELAY_MS));
+    
+    for (int i = 1; i < GATEWAY_BATCH_SIZE; i++) {
+        gatewayQueuePush(queue).receivedMs = 1000 + i;
+    }
+    TEST_ASSERT_TRUE(gatewayFlushDue(queue, 1001, GATEWAY_BATCH_SIZE, GATEWAY_BATCH_MAX_DELAY_MS));
+    
+    while (queue.count > 0) {
+        gatewayQueuePop(queue);
+    }
+    gatewayQueuePop(queue);
+    TEST_ASSERT_EQUAL_INT(0, queue.count);
+    TEST_ASSERT_FALSE(gatewayFlushDue(queue, 0xFFFFFFFF, GATEWAY_BATCH_SIZE, GATEWAY_BATCH_MAX_DELAY_MS));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_seal_open_round_trip);
+    RUN_TEST(test_open_rejects_tampered_tag);
+    RUN_TEST(test_open_rejects_tampered_ciphertext);
+    RUN_TEST(test_open_rejects_tampered_header);
+    RUN_TEST(test_open_rejects_wrong_key);
+    RUN_TEST(test_seal_rejects_small_buffer);
+    RUN_TEST(test_parse_rejects_malformed_frames);
+    RUN_TEST(test_accept_suppresses_duplicates);
+    RUN_TEST(test_accept_tracks_nodes_separately);
+    RUN_TEST(test_accept_restarts_on_session_change);
+    RUN_TEST(test_accept_rejects_earlier_session);
+    RUN_TEST(test_accept_evicts_least_recently_seen_when_full);
+    RUN_TEST(test_accept_survives_clock_wrap);
+    RUN_TEST(test_queue_batches_and_drops_oldest);
+    RUN_TEST(test_queue_flush_due_by_size_or_age);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+/*
+ * PlantBot2 Fixed-Point Conversion Tests
+ * 
+ * Host tests for fixed_point.h against the float formulas it replaced:
+ * battery voltage over every burst sum the ADC can produce (within
+ * 0.5 mV), moisture over the whole ADC range (within 0.005 %) and the
+ * low-battery sleep interpolation (within the one minute the float
+ * truncation loses at exact breakpoints), each including the clamp edges.
+ *   pio test -e native -f test_fixed_point
+ * 
+ * Version: 1.0
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "plantbot2_pins.h"
+#include "fixed_point.h"
+
+#define ADC_MAX_READING     4095
+
+void setUp() {}
+void tearDown() {}
+
+// Float baselines as the firmware computed them before fixed point
+
+static float floatBatteryVoltage(uint32_t adcSum, uint32_t count) {
+    float adcAverage = adcSum / (float)count;
+    return BATTERY_CALIB_SLOPE * adcAverage + BATTERY_CALIB_INTERCEPT;
+}
+
+static float floatMoisturePercent(int reading) {
+    if (reading <= MOISTURE_WET_VALUE) {
+        return 100.0;
+    }
+    
+    if (reading >= MOISTURE_DRY_VALUE) {
+        return 0.0;
+    }
+    
+    float percent = 100.0 * (float)(MOISTURE_DRY_VALUE - reading) /
+                    (float)(MOISTURE_DRY_VALUE - MOISTURE_WET_VALUE);
+    return fmaxf(0.0f, fminf(100.0f, percent));
+}
+
+static uint32_t floatSleepMinutes(float batteryVoltage) {
+    float voltageRange = BATTERY_MAX_VOLTAGE - BATTERY_LOW_VOLTAGE;
+    float voltageRatio = (batteryVoltage - BATTERY_LOW_VOLTAGE) / voltageRange;
+    voltageRatio = fmaxf(0.0f, fminf(1.0f, voltageRatio));
+    uint32_t sleepMinutes = MAX_SLEEP_MINUTES - (MAX_SLEEP_MINUTES - MIN_SLEEP_MINUTES) * voltageRatio;
+    return sleepMinutes;
+}
+
+static uint32_t fixedSleepMinutes(int32_t batteryMv) {
+    return sleepMinutesForBatteryMv(batteryMv, fixedFromConstant(BATTERY_LOW_VOLTAGE, 1000), BATTERY_MAX_MV,
+                                    MIN_SLEEP_MINUTES, MAX_SLEEP_MINUTES);
+}
+
+static void test_constants_match_calibration() {
+    TEST_ASSERT_EQUAL_INT32(3944, BATTERY_SLOPE_UV);
+    TEST_ASSERT_EQUAL_INT32(-9436, BATTERY_INTERCEPT_MV);
+    TEST_ASSERT_EQUAL_INT32(4200, BATTERY_MAX_MV);
+    TEST_ASSERT_EQUAL_INT32(-1500, fixedFromConstant(-1.5, 1000));
+    TEST_ASSERT_EQUAL_INT32(2, fixedFromConstant(0.0015, 1000));
+}
+
+static void test_battery_full_adc_sweep() {
+    // Every sum a full burst can produce, from an empty to a saturated ADC
+    const uint32_t count = ADC_DMA_SAMPLES_PER_CHANNEL;
+    for (uint32_t adcSum = 0; adcSum <= ADC_MAX_READING * count; adcSum++) {
+        float expectedMv = floatBatteryVoltage(adcSum, count) * 1000.0f;
+        TEST_ASSERT_FLOAT_WITHIN(0.5f + 1e-3f, expectedMv, (float)batteryMvFromAdc(adcSum, count));
+    }
+}
+
+static void test_battery_partial_bursts() {
+    // Outlier rejection leaves fewer valid readings than a full burst
+    for (uint32_t count = 1; count <= ADC_DMA_SAMPLES_PER_CHANNEL; count++) {
+        for (uint32_t reading = 0; reading <= ADC_MAX_READING; reading += 13) {
+            uint32_t adcSum = reading * count + count / 2;
+            float expectedMv = floatBatteryVoltage(adcSum, count) * 1000.0f;
+            TEST_ASSERT_FLOAT_WITHIN(0.5f + 1e-3f, expectedMv, (float)batteryMvFromAdc(adcSum, count));
+        }
+    }
+}
+
+static void test_battery_edges() {
+    const uint32_t count = ADC_DMA_SAMPLES_PER_CHANNEL;
+    
+    // No valid reading at all
+    TEST_ASSERT_EQUAL_INT32(0, batteryMvFromAdc(0, 0));
+    TEST_ASSERT_EQUAL_INT32(0, batteryMvFromAdc(ADC_MAX_READING, 0));
+    
+    // An empty ADC is the intercept, a saturated one must not overflow
+    TEST_ASSERT_EQUAL_INT32(BATTERY_INTERCEPT_MV, batteryMvFromAdc(0, count));
+    TEST_ASSERT_EQUAL_INT32(BATTERY_INTERCEPT_MV + (BATTERY_SLOPE_UV * ADC_MAX_READING + 500) / 1000,
+                            batteryMvFromAdc(ADC_MAX_READING * count, count));
+}
+
+static void test_moisture_full_adc_sweep() {
+    for (int reading = 0; reading <= ADC_MAX_READING; reading++) {
+        float expectedCenti = floatMoisturePercent(reading) * 100.0f;
+        TEST_ASSERT_FLOAT_WITHIN(0.5f + 1e-3f, expectedCenti, (float)moistureCentiFromAdc(reading));
+    }
+}
+
+static void test_moisture_clamp_edges() {
+    TEST_ASSERT_EQUAL_UINT16(10000, moistureCentiFromAdc(-1));
+    TEST_ASSERT_EQUAL_UINT16(10000, moistureCentiFromAdc(0));
+    TEST_ASSERT_EQUAL_UINT16(10000, moistureCentiFromAdc(MOISTURE_WET_VALUE));
+    TEST_ASSERT_TRUE(moistureCentiFromAdc(MOISTURE_WET_VALUE + 1) < 10000);
+    TEST_ASSERT_TRUE(moistureCentiFromAdc(MOISTURE_DRY_VALUE - 1) > 0);
+    TEST_ASSERT_EQUAL_UINT16(0, moistureCentiFromAdc(MOISTURE_DRY_VALUE));
+    TEST_ASSERT_EQUAL_UINT16(0, moistureCentiFromAdc(ADC_MAX_READING));
+    TEST_ASSERT_EQUAL_UINT16(5000, moistureCentiFromAdc((MOISTURE_WET_VALUE + MOISTURE_DRY_VALUE) / 2));
+}
+
+static void test_sleep_minutes_sweep() {
+    // Identical to the float truncation, except one minute more where the
+    // float ratio lands just short of an exact minute
+    int32_t lowMv = fixedFromConstant(BATTERY_LOW_VOLTAGE, 1000);
+    int differences = 0;
+    for (int32_t batteryMv = lowMv - 500; batteryMv <= BATTERY_MAX_MV + 500; batteryMv++) {
+        uint32_t expected = floatSleepMinutes(batteryMv / 1000.0f);
+        uint32_t actual = fixedSleepMinutes(batteryMv);
+        TEST_ASSERT_TRUE(actual == expected || actual == expected + 1);
+        if (actual != expected) {
+            // Only at an exact breakpoint: the exact reduction is a whole minute
+            uint32_t scaled = (MAX_SLEEP_MINUTES - MIN_SLEEP_MINUTES) * (uint32_t)(batteryMv - lowMv);
+            TEST_ASSERT_EQUAL_UINT32(0, scaled % (uint32_t)(BATTERY_MAX_MV - lowMv));
+            differences++;
+        }
+    }
+    TEST_ASSERT_TRUE(differences < 10);
+}
+
+static void test_sleep_minutes_clamp_edges() {
+    int32_t lowMv = fixedFromConstant(BATTERY_LOW_VOLTAGE, 1000);
+    
+    // Longest sleep at and below the low threshold, shortest at and above full
+    TEST_ASSERT_EQUAL_UINT32(MAX_SLEEP_MINUTES, fixedSleepMinutes(0));
+    TEST_ASSERT_EQUAL_UINT32(MAX_SLEEP_MINUTES, fixedSleepMinutes(lowMv - 1));
+    TEST_ASSERT_EQUAL_UINT32(MAX_SLEEP_MINUTES, fixedSleepMinutes(lowMv));
+    TEST_ASSERT_EQUAL_UINT32(MAX_SLEEP_MINUTES - 1, fixedSleepMinutes(lowMv + 1));
+    TEST_ASSERT_EQUAL_UINT32(MIN_SLEEP_MINUTES + 1, fixedSleepMinutes(BATTERY_MAX_MV - 3));
+    TEST_ASSERT_EQUAL_UINT32(MIN_SLEEP_MINUTES, fixedSleepMinutes(BATTERY_MAX_MV));
+    TEST_ASSERT_EQUAL_UINT32(MIN_SLEEP_MINUTES, fixedSleepMinutes(BATTERY_MAX_MV + 1000));
+    
+    // Rounded towards the shorter sleep, and no drift when min == max
+    TEST_ASSERT_EQUAL_UINT32(6, sleepMinutesForBatteryMv(3500, 3000, 4000, 5, 7));
+    TEST_ASSERT_EQUAL_UINT32(5, sleepMinutesForBatteryMv(3999, 3000, 4000, 5, 7));
+    TEST_ASSERT_EQUAL_UINT32(60, sleepMinutesForBatteryMv(3500, 3000, 4000, 60, 60));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_constants_match_calibration);
+    RUN_TEST(test_battery_full_adc_sweep);
+    RUN_TEST(test_battery_partial_bursts);
+    RUN_TEST(test_battery_edges);
+    RUN_TEST(test_moisture_full_adc_sweep);
+    RUN_TEST(test_moisture_clamp_edges);
+    RUN_TEST(test_sleep_minutes_sweep);
+    RUN_TEST(test_sleep_minutes_clamp_edges);
+    return UNITY_END();
+}
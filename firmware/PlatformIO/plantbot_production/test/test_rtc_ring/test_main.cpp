@@ -0,0 +1,191 @@
+/*
+ * PlantBot2 RTC Ring Tests
+ * 
+ * Host tests for rtc_ring.h: the running sums checked exactly against a
+ * brute-force recomputation from the readings after every push, through
+ * many wraparounds and at the 16-bit extremes, and mean, variance and
+ * slope against a floating-point least-squares fit within the rounding.
+ * Also the single-slot ring and the queries with fewer than two readings.
+ *   pio test -e native -f test_rtc_ring
+ * 
+ * Version: 1.0
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "rtc_ring.h"
+
+#define TEST_PUSHES     3000
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t randomState;
+
+// Deterministic 16-bit readings (xorshift32)
+static uint16_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (uint16_t)randomState;
+}
+
+// Compare the ring with a recomputation over its readings, oldest first
+template <typename T, int N>
+static void checkAgainstBruteForce(const RtcRing<T, N> &ring, const int64_t *reference, int n) {
+    TEST_ASSERT_EQUAL_INT(n, ring.count());
+    TEST_ASSERT_EQUAL(n == N, ring.full());
+    
+    int64_t sum = 0, squares = 0, weighted = 0;
+    for (int k = 0; k < n; k++) {
+        TEST_ASSERT_EQUAL_INT64(reference[n - 1 - k], ring.at(k));
+        sum += reference[k];
+        squares += reference[k] * reference[k];
+        weighted += k * reference[k];
+    }
+    TEST_ASSERT_EQUAL_INT64(sum, ring.sum);
+    TEST_ASSERT_EQUAL_INT64(squares, ring.squares);
+    TEST_ASSERT_EQUAL_INT64(weighted, ring.weighted);
+    if (n == 0) {
+        return;
+    }
+    
+    TEST_ASSERT_EQUAL_INT64(reference[n - 1], ring.newest());
+    TEST_ASSERT_EQUAL_INT64(reference[0], ring.oldest());
+    TEST_ASSERT_EQUAL_INT64(reference[n - 1] - reference[0], ring.rise(n - 1));
+    
+    double mean = (double)sum / n;
+    double variance = 0, covariance = 0, spread = 0;
+    for (int k = 0; k < n; k++) {
+        variance += (reference[k] - mean) * (reference[k] - mean);
+        covariance += (k - (n - 1) / 2.0) * (reference[k] - mean);
+        spread += (k - (n - 1) / 2.0) * (k - (n - 1) / 2.0);
+    }
+    variance /= n;
+    double slope = n > 1 ? covariance / spread : 0;
+    
+    // Within the rounding of the scaled result (in double, Unity's float
+    // assertions lack the precision for variances near 1e12)
+    TEST_ASSERT_TRUE(fabs(mean * 1000 - ring.mean(1000)) <= 0.5 + 1e-6);
+    TEST_ASSERT_TRUE(fabs((n > 1 ? variance * 1000 : 0) - ring.variance(1000)) <= 0.5 + variance * 1e-9);
+    TEST_ASSERT_TRUE(fabs(slope * 1000 - ring.slope(1000)) <= 0.5 + 1e-6);
+}
+
+// Push pseudo-random readings well past several wraparounds
+template <typename T, int N>
+static void runRandomPushes(uint32_t seed) {
+    RtcRing<T, N> ring;
+    memset(&ring, 0, sizeof(ring));
+    int64_t history[TEST_PUSHES] = {};
+    
+    randomState = seed;
+    checkAgainstBruteForce(ring, history, 0);
+    for (int i = 0; i < TEST_PUSHES; i++) {
+        history[i] = (T)nextRandom();
+        ring.push((T)history[i]);
+        int n = i + 1 < N ? i + 1 : N;
+        checkAgainstBruteForce(ring, history + i + 1 - n, n);
+    }
+}
+
+static void test_unsigned_wraparound() {
+    runRandomPushes<uint16_t, 10>(1);
+    runRandomPushes<uint16_t, 7>(2);
+    runRandomPushes<uint8_t, 2>(3);
+}
+
+static void test_signed_wraparound() {
+    runRandomPushes<int16_t, 10>(4);
+    runRandomPushes<int16_t, 3>(5);
+}
+
+static void test_largest_ring() {
+    runRandomPushes<uint16_t, 256>(6);
+    runRandomPushes<int16_t, 256>(7);
+}
+
+static void test_extreme_readings() {
+    // Full-scale readings at the largest size keep every product in range
+    RtcRing<int16_t, 256> ring;
+    memset(&ring, 0, sizeof(ring));
+    int64_t history[4 * 256];
+    for (int i = 0; i < 4 * 256; i++) {
+        history[i] = (i / 256) % 2 ? INT16_MIN : INT16_MAX;
+        ring.push((int16_t)history[i]);
+        int n = i + 1 < 256 ? i + 1 : 256;
+        checkAgainstBruteForce(ring, history + i + 1 - n, n);
+    }
+}
+
+static void test_single_slot_ring() {
+    // Every push replaces the only reading; the weighted sum stays zero
+    RtcRing<uint16_t, 1> ring;
+    memset(&ring, 0, sizeof(ring));
+    const uint16_t values[] = {4123, 0, 65535, 3700, 3700};
+    for (uint16_t value : values) {
+        ring.push(value);
+        TEST_ASSERT_EQUAL_INT(1, ring.count());
+        TEST_ASSERT_TRUE(ring.full());
+        TEST_ASSERT_EQUAL_UINT16(value, ring.newest());
+        TEST_ASSERT_EQUAL_UINT16(value, ring.oldest());
+        TEST_ASSERT_EQUAL_INT64(value, ring.sum);
+        TEST_ASSERT_EQUAL_INT64((int64_t)value * value, ring.squares);
+        TEST_ASSERT_EQUAL_INT64(0, ring.weighted);
+        TEST_ASSERT_EQUAL_INT32(value, ring.mean());
+        TEST_ASSERT_EQUAL_INT64(0, ring.variance(1000));
+        TEST_ASSERT_EQUAL_INT32(0, ring.slope(1000));
+    }
+}
+
+static void test_fewer_than_two_readings() {
+    RtcRing<uint16_t, 8> ring;
+    memset(&ring, 0, sizeof(ring));
+    
+    // Empty
+    TEST_ASSERT_EQUAL_INT(0, ring.count());
+    TEST_ASSERT_FALSE(ring.full());
+    TEST_ASSERT_EQUAL_INT32(0, ring.mean(1000));
+    TEST_ASSERT_EQUAL_INT64(0, ring.variance(1000));
+    TEST_ASSERT_EQUAL_INT32(0, ring.slope(1000));
+    
+    // One reading: a mean but no spread or trend yet
+    ring.push(3950);
+    TEST_ASSERT_EQUAL_INT32(3950000, ring.mean(1000));
+    TEST_ASSERT_EQUAL_INT64(0, ring.variance(1000));
+    TEST_ASSERT_EQUAL_INT32(0, ring.slope(1000));
+    
+    // Two readings define the slope exactly
+    ring.push(3960);
+    TEST_ASSERT_EQUAL_INT32(10000, ring.slope(1000));
+    TEST_ASSERT_EQUAL_INT64(25000, ring.variance(1000));
+}
+
+static void test_rounding_halves_away_from_zero() {
+    TEST_ASSERT_EQUAL_INT64(2, ringDivRound(3, 2));
+    TEST_ASSERT_EQUAL_INT64(-2, ringDivRound(-3, 2));
+    TEST_ASSERT_EQUAL_INT64(1, ringDivRound(4, 3));
+    TEST_ASSERT_EQUAL_INT64(-1, ringDivRound(-4, 3));
+    TEST_ASSERT_EQUAL_INT64(0, ringDivRound(0, 7));
+    
+    // Falling readings give a negative slope rounded the same way
+    RtcRing<uint16_t, 4> ring;
+    memset(&ring, 0, sizeof(ring));
+    ring.push(10);
+    ring.push(9);
+    TEST_ASSERT_EQUAL_INT32(-1, ring.slope());
+    TEST_ASSERT_EQUAL_INT32(-1000, ring.slope(1000));
+    TEST_ASSERT_EQUAL_INT32(10, ring.mean());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unsigned_wraparound);
+    RUN_TEST(test_signed_wraparound);
+    RUN_TEST(test_largest_ring);
+    RUN_TEST(test_extreme_readings);
+    RUN_TEST(test_single_slot_ring);
+    RUN_TEST(test_fewer_than_two_readings);
+    RUN_TEST(test_rounding_halves_away_from_zero);
+    return UNITY_END();
+}
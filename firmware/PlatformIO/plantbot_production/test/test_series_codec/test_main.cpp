@@ -0,0 +1,236 @@
+/*
+ * PlantBot2 Reading Series Codec Tests
+ * 
+ * Host tests for series_codec.h: round trip of a steady series, timestamp
+ * delta-of-delta at every bucket edge and the escapes for long gaps and a
+ * restarted clock, readings with the NONE sentinels of a missing sensor,
+ * and a block that runs out of capacity part way through.
+ *   pio test -e native -f test_series_codec
+ * 
+ * Version: 1.0
+ */
+
+#include <unity.h>
+#include "series_codec.h"
+
+#define TEST_READINGS   64
+
+static SeriesHeader header;
+static SeriesReading readings[TEST_READINGS];
+static SeriesReading decoded[TEST_READINGS];
+static uint8_t block[SERIES_MAX_SIZE(TEST_READINGS)];
+
+void setUp() {
+    header = {};
+    const uint8_t mac[6] = {0x40, 0x4C, 0xCA, 0x01, 0x02, 0x03};
+    memcpy(header.mac, mac, sizeof(mac));
+    header.firstSequence = 5000;
+    header.deviceTime = 900000;
+    header.powerCycle = 3;
+    
+    // Two-hourly readings with a little sensor noise
+    for (int i = 0; i < TEST_READINGS; i++) {
+        SeriesReading &r = readings[i];
+        r.takenAt = 100000 + 7200 * i;
+        r.powerCycle = 3;
+        r.temperatureCenti = (int16_t)(2150 + (i % 5) * 7 - 14);
+        r.humidityCenti = (uint16_t)(4820 + (i % 3) * 11);
+        r.batteryMv = (uint16_t)(3950 - i);
+        r.lightLevel = (uint16_t)((i % 12) * 300);
+        r.moistureLevel = (uint16_t)(2100 + (i % 4));
+        r.moistureCenti = (uint16_t)(5530 - (i % 4) * 3);
+        r.flags = 0;
+    }
+    memset(block, 0, sizeof(block));
+}
+
+void tearDown() {}
+
+static void assertSameReading(const SeriesReading &expected, const SeriesReading &actual) {
+    TEST_ASSERT_EQUAL_UINT32(expected.takenAt, actual.takenAt);
+    TEST_ASSERT_EQUAL_UINT16(expected.powerCycle, actual.powerCycle);
+    TEST_ASSERT_EQUAL_INT16(expected.temperatureCenti, actual.temperatureCenti);
+    TEST_ASSERT_EQUAL_UINT16(expected.humidityCenti, actual.humidityCenti);
+    TEST_ASSERT_EQUAL_UINT16(expected.batteryMv, actual.batteryMv);
+    TEST_ASSERT_EQUAL_UINT16(expected.lightLevel, actual.lightLevel);
+    TEST_ASSERT_EQUAL_UINT16(expected.moistureLevel, actual.moistureLevel);
+    TEST_ASSERT_EQUAL_UINT16(expected.moistureCenti, actual.moistureCenti);
+    TEST_ASSERT_EQUAL_UINT8(expected.flags, actual.flags);
+}
+
+// Encode up to count readings into a block of the given capacity: how
+// many fitted and the block length
+static void encode(int count, size_t capacity, int &appended, size_t &length) {
+    SeriesEncoder encoder;
+    appended = 0;
+    length = 0;
+    TEST_ASSERT_TRUE(seriesBegin(encoder, header, block, capacity));
+    while (appended < count && seriesAppend(encoder, readings[appended])) {
+        appended++;
+    }
+    length = seriesFinish(encoder);
+    TEST_ASSERT_TRUE(length <= capacity);
+}
+
+static void assertRoundTrip(int count) {
+    int appended;
+    size_t length;
+    encode(count, sizeof(block), appended, length);
+    TEST_ASSERT_EQUAL_INT(count, appended);
+    TEST_ASSERT_TRUE(length <= SERIES_MAX_SIZE(count));
+    
+    SeriesHeader parsed;
+    TEST_ASSERT_TRUE(seriesDecode(block, length, parsed, decoded, TEST_READINGS));
+    TEST_ASSERT_EQUAL_UINT32(header.firstSequence, parsed.firstSequence);
+    TEST_ASSERT_EQUAL_UINT32(header.deviceTime, parsed.deviceTime);
+    TEST_ASSERT_EQUAL_UINT16(header.powerCycle, parsed.powerCycle);
+    TEST_ASSERT_EQUAL_UINT16(count, parsed.readingCount);
+    TEST_ASSERT_EQUAL_MEMORY(header.mac, parsed.mac, sizeof(header.mac));
+    for (int i = 0; i < count; i++) {
+        assertSameReading(readings[i], decoded[i]);
+    }
+}
+
+static void test_steady_series_round_trip() {
+    assertRoundTrip(TEST_READINGS);
+    
+    // A steady interval costs a single bit per timestamp
+    int appended;
+    size_t length;
+    encode(TEST_READINGS, sizeof(block), appended, length);
+    TEST_ASSERT_TRUE(length < SERIES_HEADER_SIZE + TEST_READINGS * 8);
+}
+
+static void test_single_reading() {
+    assertRoundTrip(1);
+    
+    int appended;
+    size_t length;
+    encode(1, sizeof(block), appended, length);
+    TEST_ASSERT_EQUAL_size_t(SERIES_HEADER_SIZE + SERIES_FIRST_BITS / 8, length);
+}
+
+static void test_timestamp_bucket_edges() {
+    // Delta-of-delta at both ends of every bucket and just past the last
+    const int32_t steps[] = {0, -63, 64, -64, 65, -255, 256, -256, 257, -2047, 2048, -2048, 2049};
+    const int count = 1 + 2 * (int)(sizeof(steps) / sizeof(steps[0]));
+    int64_t delta = 7200;
+    for (int i = 1; i < count; i++) {
+        // Each step out and back again, so the interval stays positive
+        int32_t step = steps[(i - 1) / 2];
+        delta += (i % 2) ? step : -step;
+        readings[i].takenAt = (uint32_t)(readings[i - 1].takenAt + delta);
+    }
+    assertRoundTrip(count);
+}
+
+static void test_timestamp_escapes() {
+    // A long outage, the clock restarted by a power-on reset, a reading
+    // right after it and back to the steady interval
+    readings[3].takenAt = readings[2].takenAt + 86400 * 3;
+    readings[4].takenAt = 12;
+    readings[4].powerCycle = 4;
+    readings[5].takenAt = 14;
+    readings[5].powerCycle = 4;
+    for (int i = 6; i < 12; i++) {
+        readings[i].takenAt = readings[i - 1].takenAt + 7200;
+        readings[i].powerCycle = 4;
+    }
+    
+    // The full range of the 32-bit clock
+    readings[12].takenAt = UINT32_MAX;
+    readings[13].takenAt = 0;
+    for (int i = 12; i < 16; i++) {
+        readings[i].powerCycle = 4;
+    }
+    readings[14].takenAt = 1;
+    readings[15].takenAt = 2;
+    assertRoundTrip(16);
+}
+
+static void test_none_sentinels() {
+    // Sensors missing on and off: every change is a full-width value
+    for (int i = 0; i < 16; i++) {
+        if (i % 3 != 1) {
+            readings[i].temperatureCenti = TELEMETRY_TEMPERATURE_NONE;
+            readings[i].humidityCenti = TELEMETRY_CENTI_NONE;
+        }
+        if (i % 2 == 0) {
+            readings[i].moistureCenti = TELEMETRY_CENTI_NONE;
+        }
+        readings[i].flags = (i % 4 == 0) ? TELEMETRY_READING_CHARGING : 0;
+    }
+    readings[0].temperatureCenti = TELEMETRY_TEMPERATURE_NONE;
+    readings[15].temperatureCenti = INT16_MAX;
+    readings[15].humidityCenti = 0;
+    assertRoundTrip(16);
+}
+
+static void test_capacity_exhausted_mid_block() {
+    // Room for the header, the first reading and a few more
+    size_t capacity = SERIES_HEADER_SIZE + SERIES_FIRST_BITS / 8 + 12;
+    int appended;
+    size_t length;
+    encode(TEST_READINGS, capacity, appended, length);
+    TEST_ASSERT_TRUE(appended > 1);
+    TEST_ASSERT_TRUE(appended < TEST_READINGS);
+    
+    SeriesHeader parsed;
+    TEST_ASSERT_TRUE(seriesDecode(block, length, parsed, decoded, TEST_READINGS));
+    TEST_ASSERT_EQUAL_UINT16(appended, parsed.readingCount);
+    for (int i = 0; i < appended; i++) {
+        assertSameReading(readings[i], decoded[i]);
+    }
+    
+    // The reading that didn't fit left the block unchanged: an unchanged
+    // reading (9 bits) still fits if there is room for it
+    SeriesEncoder encoder;
+    TEST_ASSERT_TRUE(seriesBegin(encoder, header, block, capacity));
+    for (int i = 0; i < appended; i++) {
+        TEST_ASSERT_TRUE(seriesAppend(encoder, readings[i]));
+    }
+    size_t position = encoder.bits.position;
+    TEST_ASSERT_FALSE(seriesAppend(encoder, readings[appended]));
+    TEST_ASSERT_EQUAL_size_t(position, encoder.bits.position);
+    TEST_ASSERT_EQUAL_UINT16(appended, encoder.header.readingCount);
+    
+    SeriesReading repeated = readings[appended - 1];
+    repeated.takenAt += encoder.previousDelta;
+    bool room = encoder.bits.capacityBits - position >= 1 + 1 + 1 + SERIES_FIELDS;
+    TEST_ASSERT_EQUAL(room, seriesAppend(encoder, repeated));
+    length = seriesFinish(encoder);
+    TEST_ASSERT_TRUE(seriesDecode(block, length, parsed, decoded, TEST_READINGS));
+    TEST_ASSERT_EQUAL_UINT16(appended + (room ? 1 : 0), parsed.readingCount);
+    
+    // Too small for the first reading
+    TEST_ASSERT_TRUE(seriesBegin(encoder, header, block, SERIES_HEADER_SIZE + 4));
+    TEST_ASSERT_FALSE(seriesAppend(encoder, readings[0]));
+    TEST_ASSERT_EQUAL_size_t(SERIES_HEADER_SIZE, seriesFinish(encoder));
+    TEST_ASSERT_FALSE(seriesBegin(encoder, header, block, SERIES_HEADER_SIZE - 1));
+}
+
+static void test_truncated_block_rejected() {
+    int appended;
+    size_t length;
+    encode(8, sizeof(block), appended, length);
+    
+    SeriesHeader parsed;
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(seriesDecode(block, cut, parsed, decoded, TEST_READINGS));
+    }
+    
+    block[2] = SERIES_VERSION + 1;
+    TEST_ASSERT_FALSE(seriesDecode(block, length, parsed, decoded, TEST_READINGS));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_series_round_trip);
+    RUN_TEST(test_single_reading);
+    RUN_TEST(test_timestamp_bucket_edges);
+    RUN_TEST(test_timestamp_escapes);
+    RUN_TEST(test_none_sentinels);
+    RUN_TEST(test_capacity_exhausted_mid_block);
+    RUN_TEST(test_truncated_block_rejected);
+    return UNITY_END();
+}
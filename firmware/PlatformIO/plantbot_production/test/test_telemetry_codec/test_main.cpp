@@ -0,0 +1,221 @@
+/*
+ * PlantBot2 Binary Telemetry Codec Tests
+ * 
+ * Host tests for telemetry_codec.h: encode/decode round trip, truncated
+ * and malformed frames, and readings that were NaN or out of range before
+ * the fixed-point conversion.
+ *   pio test -e native -f test_telemetry_codec
+ * 
+ * Version: 1.0
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "telemetry_codec.h"
+#include "fixed_point.h"
+
+#define TEST_READINGS   4
+
+static TelemetryHeader header;
+static TelemetryReading readings[TEST_READINGS];
+static uint8_t frame[TELEMETRY_FRAME_SIZE(TEST_READINGS)];
+
+void setUp() {
+    header = {};
+    header.flags = TELEMETRY_FLAG_FAST_CONNECT | TELEMETRY_FLAG_CHARGING;
+    const uint8_t mac[6] = {0x40, 0x4C, 0xCA, 0x01, 0x02, 0x03};
+    memcpy(header.mac, mac, sizeof(mac));
+    header.bootCount = 0x01020304;
+    header.uptimeMs = 0xFEDCBA98;
+    header.rssi = -71;
+    header.sleepMinutes = 120;
+    header.wifiConnectMs = 301;
+    header.uplinkReason = 2;
+    for (int i = 0; i < TELEMETRY_PHASES; i++) {
+        header.phaseMs[i] = (uint16_t)(1000 * i + 7);
+    }
+    header.readingCount = TEST_READINGS;
+    
+    for (int i = 0; i < TEST_READINGS; i++) {
+        readings[i] = {};
+        readings[i].ageS = 7200u * (TEST_READINGS - 1 - i);
+        readings[i].temperatureCenti = (int16_t)(-1234 + 1000 * i);
+        readings[i].humidityCenti = (uint16_t)(4567 + i);
+        readings[i].batteryMv = (uint16_t)(3700 + 10 * i);
+        readings[i].lightLevel = (uint16_t)(4095 - i);
+        readings[i].moistureLevel = (uint16_t)(2000 + i);
+        readings[i].moistureCenti = (uint16_t)(10000 - i);
+        readings[i].flags = (uint8_t)(i & 3);
+    }
+    memset(frame, 0, sizeof(frame));
+}
+
+void tearDown() {
+}
+
+static void assertSameReading(const TelemetryReading &expected, const TelemetryReading &actual) {
+    TEST_ASSERT_EQUAL_UINT32(expected.ageS, actual.ageS);
+    TEST_ASSERT_EQUAL_INT16(expected.temperatureCenti, actual.temperatureCenti);
+    TEST_ASSERT_EQUAL_UINT16(expected.humidityCenti, actual.humidityCenti);
+    TEST_ASSERT_EQUAL_UINT16(expected.batteryMv, actual.batteryMv);
+    TEST_ASSERT_EQUAL_UINT16(expected.lightLevel, actual.lightLevel);
+    TEST_ASSERT_EQUAL_UINT16(expected.moistureLevel, actual.moistureLevel);
+    TEST_ASSERT_EQUAL_UINT16(expected.moistureCenti, actual.moistureCenti);
+    TEST_ASSERT_EQUAL_UINT8(expected.flags, actual.flags);
+}
+
+static void test_round_trip() {
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_size_t(TELEMETRY_FRAME_SIZE(TEST_READINGS), length);
+    
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS];
+    TEST_ASSERT_TRUE(telemetryDecode(frame, length, decoded, decodedReadings, TEST_READINGS));
+    TEST_ASSERT_EQUAL_UINT8(header.flags, decoded.flags);
+    TEST_ASSERT_EQUAL_MEMORY(header.mac, decoded.mac, sizeof(header.mac));
+    TEST_ASSERT_EQUAL_UINT32(header.bootCount, decoded.bootCount);
+    TEST_ASSERT_EQUAL_UINT32(header.uptimeMs, decoded.uptimeMs);
+    TEST_ASSERT_EQUAL_INT(header.rssi, decoded.rssi);
+    TEST_ASSERT_EQUAL_UINT16(header.sleepMinutes, decoded.sleepMinutes);
+    TEST_ASSERT_EQUAL_UINT16(header.wifiConnectMs, decoded.wifiConnectMs);
+    TEST_ASSERT_EQUAL_UINT8(header.uplinkReason, decoded.uplinkReason);
+    for (int i = 0; i < TELEMETRY_PHASES; i++) {
+        TEST_ASSERT_EQUAL_UINT16(header.phaseMs[i], decoded.phaseMs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(TEST_READINGS, decoded.readingCount);
+    for (int i = 0; i < TEST_READINGS; i++) {
+        assertSameReading(readings[i], decodedReadings[i]);
+    }
+}
+
+static void test_layout_is_little_endian() {
+    telemetryEncode(header, readings, frame, sizeof(frame));
+    
+    TEST_ASSERT_EQUAL_UINT8('P', frame[0]);
+    TEST_ASSERT_EQUAL_UINT8('B', frame[1]);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_VERSION, frame[2]);
+    const uint8_t bootCount[4] = {0x04, 0x03, 0x02, 0x01};
+    TEST_ASSERT_EQUAL_MEMORY(bootCount, frame + 10, 4);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)-71, frame[18]);
+    TEST_ASSERT_EQUAL_UINT8(TEST_READINGS, frame[TELEMETRY_HEADER_SIZE - 1]);
+    
+    // First reading's temperature, -12.34 °C
+    const uint8_t temperature[2] = {0x2E, 0xFB};
+    TEST_ASSERT_EQUAL_MEMORY(temperature, frame + TELEMETRY_HEADER_SIZE + 4, 2);
+}
+
+static void test_empty_frame() {
+    header.readingCount = 0;
+    size_t length = telemetryEncode(header, readings, frame, TELEMETRY_HEADER_SIZE);
+    TEST_ASSERT_EQUAL_size_t(TELEMETRY_HEADER_SIZE, length);
+    
+    TelemetryHeader decoded;
+    TEST_ASSERT_TRUE(telemetryDecode(frame, length, decoded, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, decoded.readingCount);
+}
+
+static void test_encode_rejects_small_buffer() {
+    TEST_ASSERT_EQUAL_size_t(0, telemetryEncode(header, readings, frame, TELEMETRY_FRAME_SIZE(TEST_READINGS) - 1));
+    TEST_ASSERT_EQUAL_size_t(0, telemetryEncode(header, readings, frame, TELEMETRY_HEADER_SIZE));
+}
+
+static void test_decode_rejects_truncated_frame() {
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS];
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(telemetryDecode(frame, cut, decoded, decodedReadings, TEST_READINGS));
+    }
+}
+
+static void test_decode_rejects_bad_magic_and_version() {
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS];
+    frame[1] = 'X';
+    TEST_ASSERT_FALSE(telemetryDecode(frame, length, decoded, decodedReadings, TEST_READINGS));
+    frame[1] = 'B';
+    frame[2] = TELEMETRY_VERSION + 1;
+    TEST_ASSERT_FALSE(telemetryDecode(frame, length, decoded, decodedReadings, TEST_READINGS));
+}
+
+static void test_decode_stops_at_max_readings() {
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS] = {};
+    TEST_ASSERT_TRUE(telemetryDecode(frame, length, decoded, decodedReadings, 2));
+    TEST_ASSERT_EQUAL_UINT8(TEST_READINGS, decoded.readingCount);
+    assertSameReading(readings[1], decodedReadings[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, decodedReadings[2].ageS);
+}
+
+static void test_extreme_field_values() {
+    readings[0].ageS = UINT32_MAX;
+    readings[0].temperatureCenti = INT16_MAX;
+    readings[1].temperatureCenti = INT16_MIN + 1;
+    readings[0].lightLevel = UINT16_MAX;
+    readings[0].flags = 0xFF;
+    header.rssi = INT8_MIN;
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS];
+    TEST_ASSERT_TRUE(telemetryDecode(frame, length, decoded, decodedReadings, TEST_READINGS));
+    TEST_ASSERT_EQUAL_INT(INT8_MIN, decoded.rssi);
+    assertSameReading(readings[0], decodedReadings[0]);
+    assertSameReading(readings[1], decodedReadings[1]);
+}
+
+// The conversion batchAppend() applies before a reading reaches the frame
+static void test_nan_and_out_of_range_readings() {
+    readings[0].temperatureCenti = (int16_t)fixedSaturate(NAN, 100, INT16_MIN + 1, INT16_MAX,
+                                                          TELEMETRY_TEMPERATURE_NONE);
+    readings[0].humidityCenti = (uint16_t)fixedSaturate(NAN, 100, 0, 10000, TELEMETRY_CENTI_NONE);
+    readings[0].moistureCenti = (uint16_t)fixedSaturate(NAN, 100, 0, 10000, TELEMETRY_CENTI_NONE);
+    readings[1].temperatureCenti = (int16_t)fixedSaturate(1e6f, 100, INT16_MIN + 1, INT16_MAX,
+                                                          TELEMETRY_TEMPERATURE_NONE);
+    readings[2].temperatureCenti = (int16_t)fixedSaturate(-1e6f, 100, INT16_MIN + 1, INT16_MAX,
+                                                          TELEMETRY_TEMPERATURE_NONE);
+    readings[1].humidityCenti = (uint16_t)fixedSaturate(123.4f, 100, 0, 10000, TELEMETRY_CENTI_NONE);
+    readings[2].humidityCenti = (uint16_t)fixedSaturate(-5.0f, 100, 0, 10000, TELEMETRY_CENTI_NONE);
+    readings[1].batteryMv = (uint16_t)fixedSaturate(INFINITY, 1000, 0, UINT16_MAX, 0);
+    readings[2].batteryMv = (uint16_t)fixedSaturate(-3.7f, 1000, 0, UINT16_MAX, 0);
+    readings[3].batteryMv = (uint16_t)fixedSaturate(NAN, 1000, 0, UINT16_MAX, 0);
+    
+    TEST_ASSERT_EQUAL_INT16(TELEMETRY_TEMPERATURE_NONE, readings[0].temperatureCenti);
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, readings[1].temperatureCenti);
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN + 1, readings[2].temperatureCenti);
+    TEST_ASSERT_EQUAL_UINT16(10000, readings[1].humidityCenti);
+    TEST_ASSERT_EQUAL_UINT16(0, readings[2].humidityCenti);
+    TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, readings[1].batteryMv);
+    TEST_ASSERT_EQUAL_UINT16(0, readings[2].batteryMv);
+    TEST_ASSERT_EQUAL_UINT16(0, readings[3].batteryMv);
+    
+    size_t length = telemetryEncode(header, readings, frame, sizeof(frame));
+    TelemetryHeader decoded;
+    TelemetryReading decodedReadings[TEST_READINGS];
+    TEST_ASSERT_TRUE(telemetryDecode(frame, length, decoded, decodedReadings, TEST_READINGS));
+    for (int i = 0; i < TEST_READINGS; i++) {
+        assertSameReading(readings[i], decodedReadings[i]);
+    }
+    TEST_ASSERT_EQUAL_INT16(TELEMETRY_TEMPERATURE_NONE, decodedReadings[0].temperatureCenti);
+    TEST_ASSERT_EQUAL_UINT16(TELEMETRY_CENTI_NONE, decodedReadings[0].humidityCenti);
+    TEST_ASSERT_EQUAL_UINT16(TELEMETRY_CENTI_NONE, decodedReadings[0].moistureCenti);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_layout_is_little_endian);
+    RUN_TEST(test_empty_frame);
+    RUN_TEST(test_encode_rejects_small_buffer);
+    RUN_TEST(test_decode_rejects_truncated_frame);
+    RUN_TEST(test_decode_rejects_bad_magic_and_version);
+    RUN_TEST(test_decode_stops_at_max_readings);
+    RUN_TEST(test_extreme_field_values);
+    RUN_TEST(test_nan_and_out_of_range_readings);
+    return UNITY_END();
+}